@@ -10,6 +10,7 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <stdlib.h>
 // GLEW include
 #include <GL/glew.h>
 
@@ -27,10 +28,32 @@
 // include local files
 #include "controls.h"
 #include "HCI557Common.h"
-#include "CoordSystem.h"
+#include "GLObjectObj.h"
 #include "Plane3D.h"
 #include "Texture.h"
 #include "Box3D.h"
+#include "GLInstancedMesh.h"
+#include "GLStaticBatch.h"
+#include "GLSceneGraph.h"
+#include "GLFrustumCuller.h"
+#include "GLOcclusionCuller.h"
+#include "GLRenderQueue.h"
+#include "GLProfiler.h"
+#include "GLGameLoop.h"
+#include "GLHeadless.h"
+#include "GLFramebuffer.h"
+#include "GLTransparencyPass.h"
+#include "GLShadowMap.h"
+#include "GLStreamBuffer.h"
+#include "GLResource.h"
+#include "GLDynamicResolution.h"
+#include "GLTerrain.h"
+#include "GLDisplacementTerrain.h"
+#include "GLRoadStreamer.h"
+#include "GLSkybox.h"
+#include "GLDebugOverlay.h"
+#include "GLDebugDraw.h"
+#include "GLHud.h"
 
 
 
@@ -79,6 +102,8 @@ extern int statevarleft;
 extern int statevarright;
 // this is a helper variable to allow us to change the texture blend model
 extern int g_change_texture_blend;
+// draw the bounding boxes of the visible objects, key b
+extern int g_draw_bounds;
 
 ///keyframe stuff
 
@@ -222,13 +247,6 @@ bool interpolateKeyframe(const float fraction, const Keyframe& k0, const Keyfram
 	/////////////////////////////////////////////////////////////////////////
 	// 3. Rotation interpolation
 
-	// Calculate the distance between the target angle and the current angle.
-	float delta_angle = sqrt((k1._q.x - k0._q.x)*(k1._q.x - k0._q.x) +
-		(k1._q.y - k0._q.y)*(k1._q.y - k0._q.y) +
-		(k1._q.z - k0._q.z)*(k1._q.z - k0._q.z) +
-		(k1._q.w - k0._q.w)*(k1._q.w - k0._q.w));
-
-
 	// Linear interpolation of the rotation using slerp
 	glm::quat r_int = glm::slerp(k0._q, k1._q, (fraction - k0._t) / (delta_t));
 
@@ -272,26 +290,69 @@ void initKeyframeAnimation(void)
 
 int main(int argc, const char * argv[])
 {
-	int j;
-	int jk;
-	j = 0;
-	jk = 0;
 	statevar = 0;
 	statevarleft = 0;
 	statevarright = 0;
 	GLObjectObj* loadedModel1 = NULL;
 
+	// --trace <file> writes the profiler zones as Chrome trace when the window closes
+	// --headless renders without a window into a framebuffer object, with 60 fps simulated time
+	// --frames <n> stops after n frames, 300 frames if --headless is given alone
+	// --image <file> writes the last headless frame into a bmp file
+	// --budget <mb> evicts unused textures above this GPU memory budget and prints the memory report, 0 only prints it
+	// --dynres <ms> scales the render resolution to hold this GPU time of the scene
+	// --terrain adds hills around the road, streamed in chunks around the camera
+	// --height-map adds a hill behind the road, displaced on the GPU from a height map texture
+	string trace_file = "";
+	string image_file = "";
+	bool headless = false;
+	bool with_terrain = false;
+	bool with_height_map = false;
+	int num_frames = -1;
+	int budget_mb = -1;
+	double dynres_ms = 0.0;
+	for(int i=1; i<argc; i++)
+	{
+		string arg = argv[i];
+		if(arg == "--trace" && i+1 < argc) trace_file = argv[++i];
+		else if(arg == "--image" && i+1 < argc) image_file = argv[++i];
+		else if(arg == "--frames" && i+1 < argc) num_frames = atoi(argv[++i]);
+		else if(arg == "--budget" && i+1 < argc) budget_mb = atoi(argv[++i]);
+		else if(arg == "--dynres" && i+1 < argc) dynres_ms = atof(argv[++i]);
+		else if(arg == "--headless") headless = true;
+		else if(arg == "--terrain") with_terrain = true;
+		else if(arg == "--height-map") with_height_map = true;
+	}
+	if(headless && num_frames < 0) num_frames = 300;
+	if(budget_mb > 0) GLMemoryTracker::Get().setBudget((size_t)budget_mb * 1024 * 1024);
+
 
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //// Init glfw, create a window, and init glew
     
-    // Init the GLFW Window
-    window = initWindow();
+    // Init the GLFW Window, or a context without window
+    if(headless)
+    {
+        if(!initHeadless(WINDOW_WIDTH, WINDOW_HEIGHT)) return -1;
+    }
+    else
+    {
+        window = initWindow();
+    }
     
     
     // Init the glew api
-    initGlew();
+    if(!initGlew() && headless) return -1;
+    
+    // headless, everything is drawn into this framebuffer
+    GLFramebuffer* offscreen = NULL;
+    if(headless)
+    {
+        offscreen = new GLFramebuffer();
+        if(!offscreen->init(WINDOW_WIDTH, WINDOW_HEIGHT)) return -1;
+        offscreen->bind();
+    }
     
 	// Set the version which we expect, here, 3.3
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -306,13 +367,9 @@ int main(int argc, const char * argv[])
 
 
 
-    // coordinate system
-    CoordSystem* cs = new CoordSystem(40.0);
-    
-    
     // create an apperance object.
-    GLAppearance* apperance_0 = new GLAppearance("../../data/shaders/multi_texture.vs", "../../data/shaders/multi_texture.fs");
-	GLAppearance* apperance_1 = new GLAppearance("../../data/shaders/multi_vertex_lights.vs", "../../data/shaders/multi_vertex_lights.fs");
+    GLAppearance* apperance_0 = new GLAppearance("../../data/shaders/multi_texture_batch.vs", "../../data/shaders/multi_texture.fs");
+	GLAppearance* apperance_1 = new GLAppearance("../../data/shaders/instanced_lights.vs", "../../data/shaders/multi_vertex_lights_oit.fs");
 
     GLDirectLightSource  light_source;
     light_source._lightPos = glm::vec4(00.0,20.0,20.0, 0.0);
@@ -344,9 +401,21 @@ int main(int argc, const char * argv[])
     material_0._shininess = 12.0;
     material_0._transparency = 0.5;
     
+    // multi_texture.fs ignores the alpha value, so the road and the car are opaque
+    GLMaterial material_opaque = material_0;
+    material_opaque._transparency = 1.0;
+    
+    // the hill ground, the appearances keep a pointer to their material
+    GLMaterial material_ground;
+    material_ground._diffuse_material = glm::vec3(0.8, 0.8, 0.8);
+    material_ground._ambient_material = glm::vec3(0.8, 0.8, 0.8);
+    material_ground._specular_material = glm::vec3(0.1, 0.1, 0.1);
+    material_ground._shininess = 12.0;
+    material_ground._transparency = 1.0;
+    
 //	setupScene();
     // Add the material to the apperance object
-    apperance_0->setMaterial(material_0);
+    apperance_0->setMaterial(material_opaque);
 	apperance_1->setMaterial(material_0);
     
     //************************************************************************************************
@@ -357,7 +426,7 @@ int main(int argc, const char * argv[])
 
 
 	GLMultiTexture* texture = new GLMultiTexture();
-	int texid = texture->loadAndCreateTextures("road2.bmp", "Harambe_Closeup.bmp", "sky.bmp");
+	texture->loadAndCreateTextures("road2.bmp", "Harambe_Closeup.bmp", "");
 	//int texid = texture->loadAndCreateTexture("../../data/textures/texture_earth_128x128_a.bmp");
 	apperance_0->setTexture(texture);
 
@@ -376,9 +445,16 @@ int main(int argc, const char * argv[])
     
     // create the sphere geometry
 	//increase dimensions of background texture
-    GLPlane3D* plane_0 = new GLPlane3D(0.0, 0.0, 0.0, 500.0, 500.0);
-    plane_0->setApperance(*apperance_0);
-    plane_0->init();
+	// The road is a ring of tiles, the tile behind the car moves to the front
+	const int num_road_tiles = 5;
+	const float road_tile_length = 200.0f;
+	GLPlane3D* road_tiles[num_road_tiles];
+	for (int i = 0; i < num_road_tiles; i++)
+	{
+		road_tiles[i] = new GLPlane3D(0.0, 0.0, 0.0, 500.0, road_tile_length);
+		road_tiles[i]->setApperance(*apperance_0);
+		road_tiles[i]->init();
+	}
     
     // If you want to change appearance parameters after you init the object, call the update function
     apperance_0->updateLightSources();
@@ -390,70 +466,204 @@ int main(int argc, const char * argv[])
 	loadedModel1 = new GLObjectObj("../data/lamborghini.obj");
 	loadedModel1->setApperance(*apperance_0);
 
-	GLBox3D* loadedModel2 = new GLBox3D(10, 10, 10);	
-	GLBox3D* loadedModel3 = new GLBox3D(10, 10, 10);	// BOX
-	GLBox3D* loadedModel4 = new GLBox3D(10, 10, 10);
-	GLBox3D* loadedModel5 = new GLBox3D(10, 10, 10);
-	GLBox3D* loadedModel6 = new GLBox3D(10, 10, 10);
-	GLBox3D* loadedModel7 = new GLBox3D(10, 10, 10);
-	GLBox3D* loadedModel8 = new GLBox3D(10, 10, 10);
-	GLBox3D* loadedModel9 = new GLBox3D(10, 10, 10);
-	loadedModel2->setApperance(*apperance_1);
-	loadedModel3->setApperance(*apperance_1);
-	loadedModel4->setApperance(*apperance_1);
-	loadedModel5->setApperance(*apperance_1);
-	loadedModel6->setApperance(*apperance_1);
-	loadedModel7->setApperance(*apperance_1);
-	loadedModel8->setApperance(*apperance_1);
-	loadedModel9->setApperance(*apperance_1);
+	// The obstacles share one box geometry and are drawn with one instanced draw call
+	GLBox3D obstacle_box(10, 10, 10);
+	vector<Vertex> obstacle_points, obstacle_normals;
+	vector<GLuint> obstacle_indices;
+	obstacle_box.getTriangles(obstacle_points, obstacle_normals, obstacle_indices);
+
+	GLInstancedMesh* obstacles = new GLInstancedMesh(obstacle_points, obstacle_normals, obstacle_indices);
+	obstacles->setApperance(*apperance_1);
 	//translate the model
 	glm::mat4 translate1 = glm::translate(glm::vec3(1.0f, 1.0f, 1.0f));
 	glm::mat4 rotate1 = glm::rotate(glm::mat4(1.0), -1.57f, glm::vec3(0.0f, 1.0f, 0.0f));
 	loadedModel1->init();
-	loadedModel2->init();
-	loadedModel3->init();
-	loadedModel4->init();
-	loadedModel5->init();
-	loadedModel6->init();
-	loadedModel7->init();
-	loadedModel8->init();
-	loadedModel9->init();
+	obstacles->init();
 	//badri_change
 	//glm::mat4 _rotatedMatrix = glm::rotate(glm::mat4(1.0), -1.57f, glm::vec3(0.0f, 1.0f, 0.0f));
 	//glm::mat4 translate1 = glm::rotate(glm::vec3(1.0f, 1.0f, 1.0f));
-	loadedModel1->setMatrix(translate1);
 	glm::mat4 init_mat = rotate1*translate1;
-	loadedModel1->setMatrix(init_mat);
-	glm::mat4 translate75 = glm::translate(glm::vec3(0.0f, 5.0f, -100.0f));
-	glm::mat4 translate76 = glm::translate(glm::vec3(50.0f, 5.0f, -100.0f));
-	glm::mat4 translate77 = glm::translate(glm::vec3(-100.0f, 5.0f, -100.0f));
-	glm::mat4 translate78 = glm::translate(glm::vec3(-150.0f, 5.0f, -100.0f));
-	glm::mat4 translate79 = glm::translate(glm::vec3(25.0f, 5.0f, -200.0f));
-	glm::mat4 translate80 = glm::translate(glm::vec3(-25.0f, 5.0f, -200.0f));
-	glm::mat4 translate81 = glm::translate(glm::vec3(75.0f, 5.0f, -200.0f));
-	glm::mat4 translate82 = glm::translate(glm::vec3(-75.0f, 5.0f, -200.0f));
-	glm::mat4 translate83 = glm::translate(glm::vec3(-125.0f, 5.0f, -200.0f));
+	glm::mat4 translate75 = glm::translate(glm::vec3(0.0f, 5.0f, 0.0f));
 	//glm::mat4 translate84 = glm::translate(glm::vec3(0.0f, 5.0f, -100.0f));
-	glm::mat4 initmat1 = translate75*init_mat;
-	loadedModel2->setMatrix(initmat1);
-	glm::mat4 initmat2= translate76*init_mat;
-	glm::mat4 initmat3 = translate77*init_mat;
-	glm::mat4 initmat4 = translate78*init_mat;
-	glm::mat4 initmat5 = translate79*init_mat;
-	glm::mat4 initmat6 = translate80*init_mat;
-	glm::mat4 initmat7 = translate81*init_mat;
-	glm::mat4 initmat8 = translate82*init_mat;
-	glm::mat4 initmat9 = translate83*init_mat;
-	loadedModel3->setMatrix(initmat2);
-	loadedModel4->setMatrix(initmat3);
-	loadedModel5->setMatrix(initmat4);
-	loadedModel6->setMatrix(initmat5);
-	loadedModel7->setMatrix(initmat6);
-	loadedModel8->setMatrix(initmat7);
-	loadedModel9->setMatrix(initmat8);
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//// Scene graph
+	// The car and the obstacles are nodes of the scene graph. Only the car node changes
+	// every frame, an obstacle node changes when the road places it on a new tile.
+	GLSceneGraph scene;
+
+	GLSceneNode* car_node = scene.createNode(NULL, loadedModel1);
+	car_node->setMatrix(init_mat);
+
+	// The obstacles keep the initial orientation of the car. They are a fixed pool, the road
+	// moves them from behind the car to the new tiles in front of it.
+	GLRoadStreamer road(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), road_tile_length);
+	for (int i = 0; i < num_road_tiles; i++) road.addTile(road_tiles[i]);
+
+	GLSceneNode* obstacle_nodes = scene.createNode();
+	const int num_obstacles = 12;
+	for (int i = 0; i < num_obstacles; i++)
+	{
+		glm::mat4 m = translate75 * init_mat;
+		GLSceneNode* node = scene.createNode(obstacle_nodes);
+		node->attach(obstacles, obstacles->addInstance(m));
+		node->setMatrix(m);
+		road.addObstacle(node);
+	}
+	road.init(7);
 	//loadedModel3->setMatrix(initmat1);
 
 
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//// Static batch
+	// The road and the car share apperance_0. Their geometry is merged and drawn with one
+	// multi-draw call; the batch follows the car matrix set by the scene graph.
+	// The culler tests the whole batch, the draws are culled one by one in the loop.
+	GLStaticBatch* textured_batch = new GLStaticBatch();
+	textured_batch->setApperance(*apperance_0);
+	for (int i = 0; i < num_road_tiles; i++) textured_batch->add(road_tiles[i]);
+	textured_batch->add(loadedModel1);
+	textured_batch->init();
+
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//// View-frustum culling
+	GLFrustumCuller culler;
+	culler.add(textured_batch);
+	culler.add(obstacles);
+
+	// The terrain has no bounds, the culler always keeps it. It selects its own chunks in update().
+	// The hills start beside the road, under the road the terrain stays below it.
+	GLAppearance* apperance_terrain = NULL;
+	GLTexture* terrain_texture = NULL;
+	GLTerrain* terrain = NULL;
+	if (with_terrain)
+	{
+		apperance_terrain = new GLAppearance("../../data/shaders/single_texture.vs", "../../data/shaders/single_texture.fs");
+		apperance_terrain->addLightSource(light_source);
+		apperance_terrain->setMaterial(material_opaque);
+		terrain_texture = new GLTexture();
+		terrain_texture->loadAndCreateTexture("../../data/textures/texture_grass_512x512.bmp");
+		apperance_terrain->setTexture(terrain_texture);
+		apperance_terrain->finalize();
+
+		GLTerrain::HeightFunction hills = GLTerrain::NoiseHeight(80.0f, 400.0f, 5, 7);
+		terrain = new GLTerrain([=](float x, float z) -> float
+		{
+			float d = fabs(x) - 250.0f;
+			float t = std::min(std::max(d / 200.0f, 0.0f), 1.0f);
+			return -2.0f + t * hills(x, z);
+		});
+		terrain->setApperance(*apperance_terrain);
+		terrain->init();
+		apperance_terrain->updateLightSources();
+		culler.add(terrain);
+	}
+
+	// The hill is one 64 x 64 grid drawn 4 x 4 times, the vertex shader reads the heights
+	// of a 128 x 128 texture, which replaces the dense mesh of height_map_t.obj.
+	GLAppearance* apperance_hill = NULL;
+	GLTexture* hill_texture = NULL;
+	GLDisplacementTerrain* hill = NULL;
+	if (with_height_map)
+	{
+		apperance_hill = new GLAppearance("../../data/shaders/displacement_terrain.vs", "../../data/shaders/displacement_terrain.fs");
+		apperance_hill->addLightSource(light_source);
+		apperance_hill->setMaterial(material_ground);
+		hill_texture = new GLTexture();
+		hill_texture->loadAndCreateTexture("../../data/textures/texture_grass_512x512.bmp");
+		apperance_hill->setTexture(hill_texture);
+		apperance_hill->finalize();
+
+		hill = new GLDisplacementTerrain("../../data/textures/height_map.bmp", 500.0f, 70.0f, 64, 4);
+		hill->setApperance(*apperance_hill);
+		hill->init();
+		hill->setMatrix(glm::translate(glm::vec3(0.0f, -1.0f, -500.0f)));
+		apperance_hill->updateLightSources();
+		culler.add(hill);
+	}
+	int last_num_visible = -1;
+
+	// Only opaque geometry is an occluder. Objects and obstacles behind it are not drawn.
+	// The obstacles are translucent as long as material_0 is, they are seen through.
+	GLOcclusionCuller occlusion;
+	int first_obstacle_occluder = -1;
+	if (!apperance_1->isTransparent())
+	{
+		for (int i = 0; i < obstacles->size(); i++)
+		{
+			int index = occlusion.addOccluder(obstacle_points, obstacle_indices, obstacles->getInstanceMatrix(i));
+			if (i == 0) first_obstacle_occluder = index;
+		}
+	}
+
+	// The car is a box inside its body, the half size of the bounds around their center.
+	glm::vec3 car_center = (loadedModel1->getBoundsMin() + loadedModel1->getBoundsMax()) * 0.5f;
+	glm::vec3 car_half = (loadedModel1->getBoundsMax() - loadedModel1->getBoundsMin()) * 0.25f;
+	int car_occluder = -1;
+	if (loadedModel1->hasBounds())
+	{
+		car_occluder = occlusion.addBoxOccluder(car_center - car_half, car_center + car_half, loadedModel1->getMatrix());
+	}
+	int last_num_occluded = -1;
+
+	// Shadows of the spotlight. The road and the obstacles are static casters and are
+	// rendered only when the light, a tile, or an obstacle moves, the car is rendered every frame.
+	GLShadowMap* shadow_map = new GLShadowMap();
+	int first_obstacle_caster = -1;
+	if (shadow_map->init())
+	{
+		shadow_map->setSpotLight(spotlight_source);
+		for (int i = 0; i < num_road_tiles; i++) shadow_map->addCaster(road_tiles[i], true);
+		for (int i = 0; i < obstacles->size(); i++)
+		{
+			int index = shadow_map->addCaster(obstacle_points, obstacle_indices, obstacles->getInstanceMatrix(i), true);
+			if (i == 0) first_obstacle_caster = index;
+		}
+		shadow_map->addCaster(loadedModel1, false);
+	}
+
+	// The visible objects are drawn sorted by state and depth. The transparent obstacles
+	// are blended with order-independent transparency and need no depth sort.
+	GLRenderQueue render_queue;
+	GLTransparencyPass* transparency_pass = new GLTransparencyPass();
+	if (transparency_pass->init(WINDOW_WIDTH, WINDOW_HEIGHT)) render_queue.setTransparencyPass(transparency_pass);
+
+	// The sky is a cubemap from sky.bmp, drawn only on the pixels the road and the objects leave free
+	GLSkybox* skybox = new GLSkybox();
+	if (skybox->init("sky.bmp")) render_queue.setSkybox(skybox);
+
+	// The display of the frame times and counters, key h
+	GLHud::Get().init();
+
+	// Key n switches the normal, tangent, and wireframe lines of the visible objects on and off
+	GLDebugOverlay::Get().setLength(2.0f);
+
+	// The scene is drawn with a lower resolution if it misses the GPU time, then scaled up.
+	// The output size is the viewport, the framebuffer of a window can be larger than the window.
+	GLDynamicResolution* dynamic_resolution = NULL;
+	int last_num_scale_changes = 0;
+	if (dynres_ms > 0.0)
+	{
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		dynamic_resolution = new GLDynamicResolution();
+		if (!dynamic_resolution->init(viewport[2], viewport[3], dynres_ms))
+		{
+			delete dynamic_resolution;
+			dynamic_resolution = NULL;
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//// Simulation
+	// The car moves in fixed 120 Hz steps. The rendered car matrix is interpolated
+	// between the last two steps, so the speed does not depend on the frame rate.
+	GLGameLoop game_loop(1.0/120.0);
+	GLTransformState car_state(init_mat);
+	const float car_speed = 6.0f; // units per second, 0.1 per frame at 60 fps
+
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //// Main render loop
     
@@ -486,8 +696,50 @@ int main(int argc, const char * argv[])
     //// Main render loop
 	initKeyframeAnimation();
     // This is our render loop. As long as our window remains open (ESC is not pressed), we'll continue to render things.
-    while(!glfwWindowShouldClose(window))
+    int frame = 0;
+    while(headless ? frame < num_frames : !glfwWindowShouldClose(window))
     {
+        GLProfiler::Get().beginFrame();
+        
+        // headless runs use a fixed frame time, so every run is the same
+        double frame_time = headless ? frame / 60.0 : glfwGetTime();
+        
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        //// Simulation steps
+        game_loop.beginFrame(frame_time);
+        while(game_loop.step())
+        {
+            car_state.store();
+            
+            if (statevar == 1)
+            {
+                glm::mat4 translate2 = glm::translate(glm::vec3(-car_speed * (float)game_loop.getStep(), 0.0f, 0.0f));
+                car_state.set(car_state.get() * translate2);
+            }
+            
+            // a lane change is one step
+            if (statevarleft == 1)
+            {
+                glm::mat4 translate3 = glm::translate(glm::vec3(0.0f, 0.0f, 10.0f));
+                car_state.set(car_state.get() * translate3);
+                statevarleft = 0;
+            }
+            
+            if (statevarright == 1)
+            {
+                glm::mat4 translate3 = glm::translate(glm::vec3(0.0f, 0.0f, -10.0f));
+                car_state.set(car_state.get() * translate3);
+                statevarright = 0;
+            }
+        }
+        car_node->setMatrix(car_state.interpolate(game_loop.getAlpha()));
+        
+        // tiles and obstacles behind the car move to the front of the road
+        glm::vec3 car_position = glm::vec3(car_node->getMatrix()[3]);
+        road.update(car_position);
+        
+        // everything up to the scene is drawn with the dynamic resolution
+        if(dynamic_resolution != NULL) dynamic_resolution->begin();
         
         // Clear the entire buffer with our green color (sets the background to be green).
         glClearBufferfv(GL_COLOR , 0, clear_color);
@@ -497,99 +749,182 @@ int main(int argc, const char * argv[])
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         //// This renders the objects
         
-        // Set the trackball locatiom
-        SetTrackballLocation(GetCurrentCameraMatrix(), GetCurrentCameraTranslation());
+        // the camera follows the car along the road, the lane changes stay visible
+        glm::vec3 road_offset = glm::vec3(0.0f, 0.0f, -1.0f) * road.getDistance(car_position);
+        SetTrackballLocation(GetCurrentCameraMatrix() * glm::translate(-road_offset));
+        
+        // update the world matrices of all nodes that moved
+        {
+            GL_PROFILE_ZONE("Update");
+            scene.update();
+            textured_batch->update();
+            
+            road.updateBounds();
+        }
+        
+        // the static shadow layer is cached, only the car is rendered every frame
+        if(shadow_map->isValid())
+        {
+            GL_PROFILE_ZONE("Shadows");
+            for(int i=0; i<obstacles->size(); i++) shadow_map->setCasterMatrix(first_obstacle_caster + i, obstacles->getInstanceMatrix(i));
+            shadow_map->render();
+            shadow_map->apply(apperance_0->getProgram());
+        }
+        
+        // draw the objects inside the view frustum
+        glm::mat4 view_projection = GetViewProjectionMatrix();
+        if(terrain != NULL) terrain->update(view_projection);
+        {
+            GL_PROFILE_ZONE("Cull");
+            culler.cull(view_projection);
+            
+            if(first_obstacle_occluder >= 0)
+            {
+                for(int i=0; i<obstacles->size(); i++) occlusion.setOccluderMatrix(first_obstacle_occluder + i, obstacles->getInstanceMatrix(i));
+            }
+            occlusion.setOccluderMatrix(car_occluder, loadedModel1->getMatrix());
+            occlusion.render(view_projection);
+            occlusion.cull(culler);
+            
+            glm::vec3 bmin, bmax;
+            for(int i=0; i<obstacles->size(); i++)
+            {
+                obstacles->getInstanceBounds(i, bmin, bmax);
+                obstacles->setInstanceVisible(i, road.isObstacleActive(i) && occlusion.isVisible(bmin, bmax));
+            }
+            
+            // every road tile and the car are culled on their own inside the batch
+            for(int i=0; i<textured_batch->size(); i++)
+            {
+                textured_batch->getDrawBounds(i, bmin, bmax);
+                textured_batch->setDrawVisible(i, culler.isVisible(bmin, bmax) && occlusion.isVisible(bmin, bmax));
+            }
+        }
         
-        // draw the objects
-        cs->draw();
-        plane_0->draw();
-		loadedModel1->draw();
-		loadedModel2->draw();
-		loadedModel3->draw();
-		loadedModel4->draw();
-		loadedModel5->draw();
-		loadedModel6->draw();
-		loadedModel7->draw();
-		loadedModel8->draw();
-		loadedModel9->draw();
+        // prepare the draw packets on the worker threads, then draw them on this thread
+        {
+            GL_PROFILE_ZONE("Prepare");
+            render_queue.begin(view_projection);
+            render_queue.submit(culler);
+            render_queue.sort();
+        }
+        
+        {
+            GL_PROFILE_ZONE("Scene");
+            GL_PROFILE_GPU_ZONE("Scene");
+            render_queue.execute();
+        }
+        
+        GLDebugOverlay::Get().draw(culler, view_projection);
+        
+        // the coordinate system, and with key b the bounds of the visible objects
+        GLDebugDraw::Get().axis(glm::mat4(1.0f), 40.0f);
+        if (g_draw_bounds)
+        {
+            glm::vec3 bmin, bmax;
+            for(int i=0; i<culler.size(); i++)
+            {
+                if(!culler.isVisible(i)) continue;
+                culler.getBounds(i, bmin, bmax);
+                GLDebugDraw::Get().aabb(bmin, bmax, glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+            for(int i=0; i<obstacles->size(); i++)
+            {
+                if(!road.isObstacleActive(i)) continue;
+                obstacles->getInstanceBounds(i, bmin, bmax);
+                GLDebugDraw::Get().aabb(bmin, bmax, obstacles->isInstanceVisible(i) ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f));
+            }
+        }
+        GLDebugDraw::Get().flush(view_projection);
+        
+        if(dynamic_resolution != NULL)
+        {
+            dynamic_resolution->end();
+            
+            if(dynamic_resolution->numChanges() != last_num_scale_changes)
+            {
+                last_num_scale_changes = dynamic_resolution->numChanges();
+                cout << "[DynamicResolution] scale: " << dynamic_resolution->getScale()
+                     << ", gpu time: " << dynamic_resolution->getGPUTime() << " ms\n";
+            }
+        }
+        
+        if(culler.numVisible() != last_num_visible || occlusion.numOccluded() != last_num_occluded)
+        {
+            last_num_visible = culler.numVisible();
+            last_num_occluded = occlusion.numOccluded();
+            cout << "[Culling] visible: " << culler.numVisible() << ", culled: " << culler.numCulled()
+                 << ", occluded boxes: " << occlusion.numOccluded() << " of " << occlusion.numTested() << "\n";
+        }
+        
+        // key h shows the frame time graph and the counters, drawn at the full resolution
+        GLHud::Get().setStateChanges(render_queue.numProgramChanges(), render_queue.numTextureChanges());
+        GLHud::Get().draw();
         // change the texture appearance blend mode
 		//badri_change
 		if (statevar == 1)
 		{bool ret = texture->setTextureBlendMode(g_change_texture_blend);
 		
         if(ret)apperance_0->updateTextures();
-		
-		     
-			glm::mat4 translate2 = glm::translate(glm::vec3(-0.1f, 0.0f, 0.0f));
-			init_mat = init_mat*translate2;
-			loadedModel1->setMatrix(init_mat);
-		}
-        
-		if (statevarleft == 1)
-		{
-			j = 0;
-			if (j == 0)
-			{
-				glm::mat4 translate3 = glm::translate(glm::vec3(0.0f, 0.0f, 10.0f));
-				init_mat = init_mat*translate3;
-				loadedModel1->setMatrix(init_mat);
-				j++;
-				statevarleft = 0;
-			}
-		}
-			
-
-		if (statevarright == 1)
-		{
-			jk = 0;
-			if (jk == 0)
-			{
-				glm::mat4 translate3 = glm::translate(glm::vec3(0.0f, 0.0f, -10.0f));
-				init_mat = init_mat*translate3;
-				loadedModel1->setMatrix(init_mat);
-				j++;
-				statevarright = 0;
-			}
 		}
 
         
         //// This renders the objects
         ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		
-
-		Keyframe k0, k1, k_res;
-
-		float time = glfwGetTime();
-		
-		if (time <= 60.0)
-		{
-			cout << time << endl;
-			float f = getTimeFraction(time, 60.0); // we assume that the animation takes 8 seconds
-
-			int num = getKeyframes(myKeyframes, f, k0, k1);
-
-			bool ret = interpolateKeyframe(f, k0, k1, k_res);
-
-
-			//k_res.print();
-
-			glm::mat4 translate7 = glm::translate(k_res._p);
-			//glm::mat4 matrix = mat4_cast(k_res._q);
-
-			//glm::mat4 rotate9 = glm::rotate(matrix);
-			//init_mat = init_mat*translate7;
-			//loadedModel1->setMatrix(translate7);
-		}
-
         
         // Swap the buffers so that what we drew will appear on the screen.
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        if(!headless)
+        {
+            {
+                GL_PROFILE_ZONE("SwapBuffers");
+                glfwSwapBuffers(window);
+            }
+            glfwPollEvents();
+            
+            if(num_frames >= 0 && frame + 1 >= num_frames) glfwSetWindowShouldClose(window, GL_TRUE);
+        }
         
+        GLStreamBuffer::Get().endFrame();
+        GLMemoryTracker::Get().endFrame();
+        GLProfiler::Get().endFrame();
+        frame++;
+    }
+    
+    if(headless && image_file.length() > 0)
+    {
+        if(offscreen->saveBitmap(image_file)) cout << "[main] - Wrote frame " << frame << " to " << image_file << endl;
+    }
+    
+    if(trace_file.length() > 0)
+    {
+        GLProfiler::Get().exportChromeTrace(trace_file);
+    }
+    
+    if(budget_mb >= 0)
+    {
+        GLMemoryTracker::Get().report(cout);
     }
     
     
-    delete cs;
+    delete texture;
+    delete transparency_pass;
+    delete dynamic_resolution;
+    delete terrain;
+    delete terrain_texture;
+    delete apperance_terrain;
+    delete hill;
+    delete hill_texture;
+    delete apperance_hill;
+    delete shadow_map;
+    GLStreamBuffer::Get().release();
+    GLDebugDraw::Get().release();
+    GLHud::Get().release();
+    
+    if(headless)
+    {
+        delete offscreen;
+        shutdownHeadless();
+    }
     
     
 }
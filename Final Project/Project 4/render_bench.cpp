@@ -0,0 +1,613 @@
+//
+//  render_bench.cpp
+//  HCI557_Simple_Texture
+//
+//  Renders a generated scene along a fixed camera path and reports the frame
+//  times, draw calls and triangles as JSON. Use it to track regressions while
+//  the object counts grow.
+//
+//  render_bench [--boxes N] [--cars M] [--lights K] [--planes P] [--spheres S]
+//               [--frames F] [--warmup W] [--car <obj file>] [--data <data dir>]
+//               [--occlusion] [--threads T] [--budget MB] [--dynres MS] [--terrain] [--height-map] [--skybox] [--debug-overlay] [--debug-bounds] [--hud] [--window] [--out <json file>] [--trace <trace file>]
+//
+//  --occlusion uses the boxes as occluders for the software occlusion culler.
+//  --threads sets the number of threads for culling and packet preparation,
+//  1 runs everything on the GL thread. The default uses all cores, up to eight.
+//  --budget sets the GPU memory budget in MB above which unused textures are evicted.
+//  --dynres renders with a dynamic resolution that holds this GPU time of the scene in ms.
+//  --terrain adds a streamed noise terrain below the scene.
+//  --height-map adds a terrain displaced on the GPU from data/textures/height_map.bmp.
+//  --spheres adds S spheres above the boxes, drawn with one instanced draw call.
+//  --skybox draws a cubemap sky from data/textures/environment.bmp behind the scene.
+//  --debug-overlay draws the normals, tangents, and wireframe of the visible objects.
+//  --debug-bounds draws the bounding box of every visible object with GLDebugDraw.
+//  --hud draws the frame time graph and counters and reports their CPU time.
+//
+//  The benchmark runs headless by default, --window opens a GLFW window.
+//
+
+// stl include
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+
+// glfw includes
+#include <GLFW/glfw3.h>
+
+
+// include local files
+#include "controls.h"
+#include "HCI557Common.h"
+#include "GLObjectObj.h"
+#include "Plane3D.h"
+#include "Texture.h"
+#include "Box3D.h"
+#include "GLFrustumCuller.h"
+#include "GLOcclusionCuller.h"
+#include "GLRenderQueue.h"
+#include "GLProfiler.h"
+#include "GLThreadPool.h"
+#include "GLStreamBuffer.h"
+#include "GLResource.h"
+#include "GLDynamicResolution.h"
+#include "GLTerrain.h"
+#include "GLDisplacementTerrain.h"
+#include "GLSkybox.h"
+#include "GLDebugOverlay.h"
+#include "GLDebugDraw.h"
+#include "GLHud.h"
+#include "GLInstancedSpheres.h"
+#include "GLHeadless.h"
+#include "GLFramebuffer.h"
+
+
+using namespace std;
+
+
+// The handle to the window object, see controls.cpp
+GLFWwindow*         window = NULL;
+
+
+
+/*!
+ The parameters of one benchmark run
+ */
+typedef struct _BenchSettings
+{
+    int         boxes;
+    int         cars;
+    int         lights;
+    int         planes;
+    int         spheres;
+    int         frames;
+    int         warmup;
+    int         threads;
+    int         budget_mb;
+    double      dynres_ms;
+    bool        headless;
+    bool        occlusion;
+    bool        terrain;
+    bool        height_map;
+    bool        skybox;
+    bool        debug_overlay;
+    bool        debug_bounds;
+    bool        hud;
+    string      car_file;
+    string      data_dir;
+    string      out_file;
+    string      trace_file;
+
+    _BenchSettings()
+    {
+        boxes = 100;
+        cars = 4;
+        lights = 2;
+        planes = 16;
+        spheres = 0;
+        frames = 600;
+        warmup = 60;
+        threads = 0;
+        budget_mb = 0;
+        dynres_ms = 0.0;
+        headless = true;
+        occlusion = false;
+        terrain = false;
+        height_map = false;
+        skybox = false;
+        debug_overlay = false;
+        debug_bounds = false;
+        hud = false;
+        car_file = "../../data/teapot_t.obj";
+        data_dir = "../../data/";
+        out_file = "";
+        trace_file = "";
+    }
+}BenchSettings;
+
+
+/*!
+ The value at percentile p of a sorted vector, nearest rank
+ */
+double percentile(const vector<double>& sorted, double p)
+{
+    if(sorted.size() == 0) return 0.0;
+    int rank = (int)ceil(p / 100.0 * sorted.size()) - 1;
+    rank = std::min(std::max(rank, 0), (int)sorted.size() - 1);
+    return sorted[rank];
+}
+
+
+/*!
+ Adds K lights to an appearance. The first light is a direct light, all
+ others are spot lights on a circle above the scene.
+ */
+void addLights(GLAppearance* apperance, int num_lights, float radius)
+{
+    GLDirectLightSource light_source;
+    light_source._lightPos = glm::vec4(0.0, 20.0, 20.0, 0.0);
+    light_source._ambient_intensity = 0.2;
+    light_source._specular_intensity = 5.5;
+    light_source._diffuse_intensity = 2.0;
+    light_source._attenuation_coeff = 0.0;
+    apperance->addLightSource(light_source);
+
+    for(int i=1; i<num_lights; i++)
+    {
+        float a = 6.2831853f * i / num_lights;
+
+        GLSpotLightSource spotlight_source;
+        spotlight_source._lightPos = glm::vec4(radius * cos(a), 30.0, radius * sin(a), 1.0);
+        spotlight_source._ambient_intensity = 0.0;
+        spotlight_source._specular_intensity = 10.0;
+        spotlight_source._diffuse_intensity = 5.0;
+        spotlight_source._attenuation_coeff = 0.0002;
+        spotlight_source._cone_direction = glm::vec3(-cos(a), -1.0, -sin(a));
+        spotlight_source._cone_angle = 30.0;
+        apperance->addLightSource(spotlight_source);
+    }
+}
+
+
+
+int main(int argc, const char * argv[])
+{
+    BenchSettings settings;
+
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = i+1 < argc;
+
+        if(arg == "--boxes" && has_value) settings.boxes = atoi(argv[++i]);
+        else if(arg == "--cars" && has_value) settings.cars = atoi(argv[++i]);
+        else if(arg == "--lights" && has_value) settings.lights = atoi(argv[++i]);
+        else if(arg == "--planes" && has_value) settings.planes = atoi(argv[++i]);
+        else if(arg == "--spheres" && has_value) settings.spheres = atoi(argv[++i]);
+        else if(arg == "--frames" && has_value) settings.frames = atoi(argv[++i]);
+        else if(arg == "--warmup" && has_value) settings.warmup = atoi(argv[++i]);
+        else if(arg == "--car" && has_value) settings.car_file = argv[++i];
+        else if(arg == "--data" && has_value) settings.data_dir = argv[++i];
+        else if(arg == "--out" && has_value) settings.out_file = argv[++i];
+        else if(arg == "--trace" && has_value) settings.trace_file = argv[++i];
+        else if(arg == "--threads" && has_value) settings.threads = atoi(argv[++i]);
+        else if(arg == "--budget" && has_value) settings.budget_mb = atoi(argv[++i]);
+        else if(arg == "--dynres" && has_value) settings.dynres_ms = atof(argv[++i]);
+        else if(arg == "--window") settings.headless = false;
+        else if(arg == "--occlusion") settings.occlusion = true;
+        else if(arg == "--terrain") settings.terrain = true;
+        else if(arg == "--height-map") settings.height_map = true;
+        else if(arg == "--skybox") settings.skybox = true;
+        else if(arg == "--debug-overlay") settings.debug_overlay = true;
+        else if(arg == "--debug-bounds") settings.debug_bounds = true;
+        else if(arg == "--hud") settings.hud = true;
+        else
+        {
+            cerr << "[render_bench] - Unknown argument " << arg << endl;
+            return -1;
+        }
+    }
+
+    // the shaders support up to 10 lights
+    settings.lights = std::min(std::max(settings.lights, 1), 10);
+    settings.frames = std::max(settings.frames, 1);
+    settings.warmup = std::max(settings.warmup, 0);
+    GLThreadPool::SetDefaultThreads(std::max(settings.threads, 0));
+    GLMemoryTracker::Get().setBudget((size_t)std::max(settings.budget_mb, 0) * 1024 * 1024);
+
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //// Context
+
+    GLFramebuffer* offscreen = NULL;
+    if(settings.headless)
+    {
+        if(!initHeadless(WINDOW_WIDTH, WINDOW_HEIGHT)) return -1;
+    }
+    else
+    {
+        window = initWindow();
+    }
+
+    if(!initGlew()) return -1;
+
+    if(settings.headless)
+    {
+        offscreen = new GLFramebuffer();
+        if(!offscreen->init(WINDOW_WIDTH, WINDOW_HEIGHT)) return -1;
+        offscreen->bind();
+    }
+    else
+    {
+        // measure the frame, not the display refresh rate
+        glfwSwapInterval(0);
+    }
+
+    GLProfiler::Get().setEnabled(settings.trace_file.length() > 0);
+
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //// Scene
+
+    // the boxes stand on a square grid, the size of the grid defines the size of the scene
+    int grid = std::max((int)ceil(sqrt((double)settings.boxes)), 1);
+    float spacing = 8.0f;
+    float extent = grid * spacing * 0.5f;
+
+    GLAppearance* apperance_lit = new GLAppearance(settings.data_dir + "shaders/multi_vertex_lights.vs", settings.data_dir + "shaders/multi_vertex_lights.fs");
+    GLAppearance* apperance_tex = new GLAppearance(settings.data_dir + "shaders/single_texture.vs", settings.data_dir + "shaders/single_texture.fs");
+
+    addLights(apperance_lit, settings.lights, extent);
+    addLights(apperance_tex, settings.lights, extent);
+
+    GLMaterial material_0;
+    material_0._diffuse_material = glm::vec3(0.2, 0.0, 1.0);
+    material_0._ambient_material = glm::vec3(0.2, 0.0, 1.0);
+    material_0._specular_material = glm::vec3(1.0, 1.0, 1.0);
+    material_0._shininess = 12.0;
+    material_0._transparency = 1.0;
+    apperance_lit->setMaterial(material_0);
+    apperance_tex->setMaterial(material_0);
+
+    GLTexture* texture = new GLTexture();
+    texture->loadAndCreateTexture(settings.data_dir + "textures/texture_brick.bmp");
+    apperance_tex->setTexture(texture);
+
+    apperance_lit->finalize();
+    apperance_tex->finalize();
+
+    vector<GLObject*> objects;
+    GLFrustumCuller culler;
+    GLOcclusionCuller occlusion;
+
+    // N boxes
+    for(int i=0; i<settings.boxes; i++)
+    {
+        GLBox3D* box = new GLBox3D(2.0, 2.0, 2.0);
+        box->setApperance(*apperance_lit);
+        box->init();
+        box->setMatrix(glm::translate(glm::vec3((i % grid) * spacing - extent, 1.0f, (i / grid) * spacing - extent)));
+        objects.push_back(box);
+
+        if(settings.occlusion) occlusion.addOccluder(box);
+    }
+
+    // M cars on a circle around the boxes
+    for(int i=0; i<settings.cars; i++)
+    {
+        float a = 6.2831853f * i / std::max(settings.cars, 1);
+        GLObjectObj* car = new GLObjectObj(settings.car_file);
+        car->setApperance(*apperance_tex);
+        car->init();
+        car->setMatrix(glm::translate(glm::vec3((extent + 10.0f) * cos(a), 0.0f, (extent + 10.0f) * sin(a))));
+        objects.push_back(car);
+    }
+
+    // P textured ground tiles, the planes are created in the xy plane
+    int plane_grid = std::max((int)ceil(sqrt((double)settings.planes)), 1);
+    float plane_size = (2.0f * extent + 40.0f) / plane_grid;
+    for(int i=0; i<settings.planes; i++)
+    {
+        float x = ((i % plane_grid) + 0.5f) * plane_size - (extent + 20.0f);
+        float z = ((i / plane_grid) + 0.5f) * plane_size - (extent + 20.0f);
+        GLPlane3D* plane = new GLPlane3D(0.0, 0.0, 0.0, plane_size, plane_size);
+        plane->setApperance(*apperance_tex);
+        plane->init();
+        plane->setMatrix(glm::translate(glm::vec3(x, 0.0f, z)) * glm::rotate(-1.5707963f, glm::vec3(1.0f, 0.0f, 0.0f)));
+        objects.push_back(plane);
+    }
+
+    // a terrain below the ground tiles, its chunks are loaded while the benchmark runs
+    GLTerrain* terrain = NULL;
+    if(settings.terrain)
+    {
+        terrain = new GLTerrain(GLTerrain::NoiseHeight(60.0f, 400.0f, 5, 7), 512.0f, 5);
+        terrain->setApperance(*apperance_tex);
+        terrain->init();
+        terrain->setMatrix(glm::translate(glm::vec3(0.0f, -61.0f, 0.0f)));
+        culler.add(terrain);
+    }
+
+    // a displaced terrain around the scene, one shared grid drawn instanced
+    GLAppearance* apperance_hill = NULL;
+    if(settings.height_map)
+    {
+        apperance_hill = new GLAppearance(settings.data_dir + "shaders/displacement_terrain.vs", settings.data_dir + "shaders/displacement_terrain.fs");
+        addLights(apperance_hill, settings.lights, extent);
+        apperance_hill->setMaterial(material_0);
+        apperance_hill->setTexture(texture);
+        apperance_hill->finalize();
+
+        GLDisplacementTerrain* hill = new GLDisplacementTerrain(settings.data_dir + "textures/height_map.bmp", 4.0f * extent + 200.0f, 40.0f, 64, 4);
+        hill->setApperance(*apperance_hill);
+        hill->init();
+        hill->setMatrix(glm::translate(glm::vec3(0.0f, -41.0f, 0.0f)));
+        apperance_hill->updateLightSources();
+        objects.push_back(hill);
+    }
+
+    // S spheres in a box above the boxes, one shared sphere mesh and one draw call
+    GLAppearance* apperance_spheres = NULL;
+    if(settings.spheres > 0)
+    {
+        apperance_spheres = new GLAppearance(settings.data_dir + "shaders/instanced_lights.vs", settings.data_dir + "shaders/multi_vertex_lights.fs");
+        addLights(apperance_spheres, settings.lights, extent);
+        apperance_spheres->setMaterial(material_0);
+        apperance_spheres->finalize();
+
+        GLInstancedSpheres* spheres = new GLInstancedSpheres(8, 16, settings.spheres);
+        spheres->setApperance(*apperance_spheres);
+        spheres->init();
+
+        // the same spheres in every run
+        unsigned int random = 12345;
+        for(int i=0; i<settings.spheres; i++)
+        {
+            float r[5];
+            for(int j=0; j<5; j++)
+            {
+                random = random * 1664525u + 1013904223u;
+                r[j] = (random >> 8) / 16777216.0f;
+            }
+            glm::vec3 center((r[0] * 2.0f - 1.0f) * extent, 4.0f + r[1] * 20.0f, (r[2] * 2.0f - 1.0f) * extent);
+            spheres->addSphere(center, 0.3f + r[3], glm::vec4(r[4], 1.0f - r[4], 1.0f, 1.0f));
+        }
+
+        apperance_spheres->updateLightSources();
+        objects.push_back(spheres);
+    }
+
+    apperance_lit->updateLightSources();
+    apperance_tex->updateLightSources();
+
+    for(int i=0; i<objects.size(); i++) culler.add(objects[i]);
+
+    GLRenderQueue render_queue;
+
+    GLSkybox* skybox = NULL;
+    if(settings.skybox)
+    {
+        skybox = new GLSkybox();
+        if(!skybox->init(settings.data_dir + "textures/environment.bmp")) return -1;
+        render_queue.setSkybox(skybox);
+    }
+
+    if(settings.debug_overlay) GLDebugOverlay::Get().setModes(GLDebugOverlay::ALL);
+
+    if(settings.hud)
+    {
+        if(!GLHud::Get().init()) return -1;
+        GLHud::Get().setVisible(true);
+    }
+
+    static const GLfloat clear_color[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    static const GLfloat clear_depth[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLDynamicResolution* dynamic_resolution = NULL;
+    if(settings.dynres_ms > 0.0)
+    {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        dynamic_resolution = new GLDynamicResolution();
+        if(!dynamic_resolution->init(viewport[2], viewport[3], settings.dynres_ms)) return -1;
+    }
+
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //// Frames
+
+    vector<double> frame_times;
+    long long total_draw_calls = 0;
+    long long total_triangles = 0;
+    long long total_occluded = 0;
+    double total_scale = 0.0;
+    double total_hud_ms = 0.0;
+    long long total_terrain_chunks = 0;
+    float radius = extent * 1.5f + 20.0f;
+
+    int total_frames = settings.warmup + settings.frames;
+    for(int frame = 0; frame < total_frames; frame++)
+    {
+        if(window != NULL && glfwWindowShouldClose(window)) break;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        GLProfiler::Get().beginFrame();
+
+        // one orbit around the scene during the measured frames
+        float a = 6.2831853f * frame / settings.frames;
+        SetViewAsLookAt(glm::vec3(radius * cos(a), radius * 0.4f, radius * sin(a)), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        if(dynamic_resolution != NULL) dynamic_resolution->begin();
+
+        glClearBufferfv(GL_COLOR , 0, clear_color);
+        glClearBufferfv(GL_DEPTH , 0, clear_depth);
+
+        glm::mat4 view_projection = GetViewProjectionMatrix();
+        if(terrain != NULL) terrain->update(view_projection);
+        culler.cull(view_projection);
+
+        if(settings.occlusion)
+        {
+            occlusion.render(view_projection);
+            occlusion.cull(culler);
+        }
+
+        {
+            GL_PROFILE_GPU_ZONE("Scene");
+            render_queue.begin(view_projection);
+            render_queue.submit(culler);
+            render_queue.sort();
+            render_queue.execute();
+        }
+        GLDebugOverlay::Get().draw(culler, view_projection);
+
+        if(settings.debug_bounds)
+        {
+            glm::vec3 bmin, bmax;
+            for(int i=0; i<culler.size(); i++)
+            {
+                if(!culler.isVisible(i)) continue;
+                culler.getBounds(i, bmin, bmax);
+                GLDebugDraw::Get().aabb(bmin, bmax, glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+            GLDebugDraw::Get().flush(view_projection);
+        }
+
+        if(dynamic_resolution != NULL) dynamic_resolution->end();
+
+        if(settings.hud)
+        {
+            GLHud::Get().setStateChanges(render_queue.numProgramChanges(), render_queue.numTextureChanges());
+            GLHud::Get().draw();
+        }
+
+        if(window != NULL)
+        {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // the frame is complete when the gpu is done
+        glFinish();
+
+        GLStreamBuffer::Get().endFrame();
+        GLMemoryTracker::Get().endFrame();
+        GLProfiler::Get().endFrame();
+        double ms = chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+
+        if(frame < settings.warmup) continue;
+
+        frame_times.push_back(ms);
+        total_draw_calls += GLProfiler::Get().getDrawCalls();
+        total_triangles += GLProfiler::Get().getTriangles();
+        total_occluded += occlusion.numOccluded();
+        total_terrain_chunks += terrain != NULL ? terrain->numVisible() : 0;
+        total_scale += dynamic_resolution != NULL ? dynamic_resolution->getScale() : 1.0;
+        total_hud_ms += GLProfiler::Get().getCPUTime("GLHud::draw");
+    }
+
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //// Report
+
+    int n = (int)frame_times.size();
+    double total_ms = 0.0;
+    for(int i=0; i<n; i++) total_ms += frame_times[i];
+
+    vector<double> sorted = frame_times;
+    std::sort(sorted.begin(), sorted.end());
+
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+
+    stringstream json;
+    json.setf(ios::fixed);
+    json.precision(3);
+    json << "{" << endl;
+    json << "  \"renderer\": \"" << (renderer != NULL ? renderer : "unknown") << "\"," << endl;
+    json << "  \"headless\": " << (settings.headless ? "true" : "false") << "," << endl;
+    json << "  \"scene\": { \"boxes\": " << settings.boxes << ", \"cars\": " << settings.cars
+         << ", \"lights\": " << settings.lights << ", \"planes\": " << settings.planes << ", \"spheres\": " << settings.spheres
+         << ", \"objects\": " << objects.size() << ", \"skybox\": " << (skybox != NULL ? "true" : "false")
+         << ", \"debug_overlay\": " << (settings.debug_overlay ? "true" : "false")
+         << ", \"debug_lines\": " << GLDebugDraw::Get().numLines() << " }," << endl;
+    json << "  \"threads\": " << GLThreadPool::Get().numThreads() << "," << endl;
+    json << "  \"gpu_memory_kb\": { \"total\": " << GLMemoryTracker::Get().getTotal() / 1024
+         << ", \"buffers\": " << GLMemoryTracker::Get().getBytes(GLResource::BUFFER) / 1024
+         << ", \"textures\": " << GLMemoryTracker::Get().getBytes(GLResource::TEXTURE) / 1024
+         << ", \"renderbuffers\": " << GLMemoryTracker::Get().getBytes(GLResource::RENDERBUFFER) / 1024
+         << ", \"budget\": " << GLMemoryTracker::Get().getBudget() / 1024
+         << ", \"evictions\": " << GLMemoryTracker::Get().numEvictions() << " }," << endl;
+    json << "  \"resolution_scale\": { \"mean\": " << (n > 0 ? total_scale / n : 1.0)
+         << ", \"target_ms\": " << settings.dynres_ms
+         << ", \"changes\": " << (dynamic_resolution != NULL ? dynamic_resolution->numChanges() : 0) << " }," << endl;
+    json << "  \"terrain\": { \"chunks_per_frame\": " << (n > 0 ? (double)total_terrain_chunks / n : 0.0)
+         << ", \"resident\": " << (terrain != NULL ? terrain->numResident() : 0)
+         << ", \"pending\": " << (terrain != NULL ? terrain->numPending() : 0) << " }," << endl;
+    json << "  \"frames\": " << n << "," << endl;
+    json << "  \"warmup\": " << settings.warmup << "," << endl;
+    json << "  \"frame_ms\": { \"mean\": " << (n > 0 ? total_ms / n : 0.0)
+         << ", \"p50\": " << percentile(sorted, 50.0)
+         << ", \"p95\": " << percentile(sorted, 95.0)
+         << ", \"p99\": " << percentile(sorted, 99.0)
+         << ", \"min\": " << (n > 0 ? sorted.front() : 0.0)
+         << ", \"max\": " << (n > 0 ? sorted.back() : 0.0) << " }," << endl;
+    json << "  \"draw_calls_per_frame\": " << (n > 0 ? (double)total_draw_calls / n : 0.0) << "," << endl;
+    if(settings.hud) json << "  \"hud_cpu_ms_per_frame\": " << (n > 0 ? total_hud_ms / n : 0.0) << "," << endl;
+    json << "  \"occluded_per_frame\": " << (n > 0 ? (double)total_occluded / n : 0.0) << "," << endl;
+    json << "  \"triangles_per_frame\": " << (n > 0 ? (double)total_triangles / n : 0.0) << "," << endl;
+    json << "  \"triangles_per_second\": " << (total_ms > 0.0 ? total_triangles / (total_ms / 1000.0) : 0.0) << endl;
+    json << "}" << endl;
+
+    if(settings.out_file.length() > 0)
+    {
+        ofstream out(settings.out_file.c_str());
+        if(!out.is_open())
+        {
+            cerr << "[render_bench] - Cannot open " << settings.out_file << endl;
+            return -1;
+        }
+        out << json.str();
+        out.close();
+    }
+    else
+    {
+        cout << json.str();
+    }
+
+    if(settings.trace_file.length() > 0)
+    {
+        GLProfiler::Get().exportChromeTrace(settings.trace_file);
+    }
+
+
+    for(int i=0; i<objects.size(); i++) delete objects[i];
+    delete terrain;
+    delete texture;
+    delete dynamic_resolution;
+    delete offscreen;
+    GLStreamBuffer::Get().release();
+    GLDebugDraw::Get().release();
+    GLHud::Get().release();
+
+    if(settings.headless) shutdownHeadless();
+
+    return 0;
+}
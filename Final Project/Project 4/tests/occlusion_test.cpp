@@ -0,0 +1,126 @@
+//
+//  occlusion_test.cpp
+//  HCI557_Simple_Texture
+//
+//  Rasterizes one quad with GLOcclusionCuller and tests boxes in front of it,
+//  behind it, beside it, larger than it, and just beside its edge. The culler makes no GL calls, the
+//  test runs without GPU.
+//
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// glfw includes
+#include <GLFW/glfw3.h>
+
+
+// include local files
+#include "GLOcclusionCuller.h"
+#include "HCI557Datatypes.h"
+
+
+using namespace std;
+
+
+// The handle to the window object, see controls.cpp
+GLFWwindow*         window = NULL;
+
+
+/*!
+ Tests a box of the half size h around a center, returns the number of errors
+ */
+int checkBox(GLOcclusionCuller& occlusion, const char* name, const glm::vec3& center, float h, bool expected)
+{
+    glm::vec3 half(h, h, h);
+    bool visible = occlusion.isVisible(center - half, center + half);
+    if(visible == expected) return 0;
+
+    cerr << "[occlusion_test] - The box " << name << " is " << (visible ? "visible" : "occluded")
+         << ", expected " << (expected ? "visible" : "occluded") << "." << endl;
+    return 1;
+}
+
+
+
+int main(int argc, const char * argv[])
+{
+    // the camera is at the origin and looks along -z, the quad at z = -10 covers x, y in [-4, 4]
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 1.0f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    vector<Vertex> points;
+    points.push_back(Vertex(-4.0f, -4.0f, -10.0f));
+    points.push_back(Vertex( 4.0f, -4.0f, -10.0f));
+    points.push_back(Vertex( 4.0f,  4.0f, -10.0f));
+    points.push_back(Vertex(-4.0f,  4.0f, -10.0f));
+
+    vector<GLuint> indices;
+    GLuint quad[6] = {0, 1, 2, 0, 2, 3};
+    indices.assign(quad, quad + 6);
+
+    // one band, the test does not need the thread pool
+    GLOcclusionCuller occlusion(256, 128, 1);
+    occlusion.addOccluder(points, indices);
+    occlusion.render(projection * view);
+
+    int errors = 0;
+    if(occlusion.numTriangles() != 2)
+    {
+        cerr << "[occlusion_test] - " << occlusion.numTriangles() << " triangles were rasterized, expected 2." << endl;
+        errors++;
+    }
+
+    // the depth buffer has the quad in the center and is empty at the border
+    const vector<float>& depth = occlusion.getDepthBuffer();
+    int w = occlusion.getWidth(), h = occlusion.getHeight();
+    if(!(depth[(h / 2) * w + w / 2] < 1.0f) || depth[0] != 1.0f)
+    {
+        cerr << "[occlusion_test] - The quad is not in the center of the depth buffer." << endl;
+        errors++;
+    }
+
+    errors += checkBox(occlusion, "in front", glm::vec3(0.0f, 0.0f, -5.0f), 0.5f, true);
+    errors += checkBox(occlusion, "behind", glm::vec3(0.0f, 0.0f, -20.0f), 0.5f, false);
+    errors += checkBox(occlusion, "behind, at the corner", glm::vec3(-6.0f, 6.0f, -20.0f), 0.5f, false);
+    errors += checkBox(occlusion, "beside", glm::vec3(16.0f, 0.0f, -20.0f), 0.5f, true);
+    errors += checkBox(occlusion, "larger than the quad", glm::vec3(0.0f, 0.0f, -20.0f), 12.0f, true);
+    errors += checkBox(occlusion, "through the quad", glm::vec3(0.0f, 0.0f, -10.0f), 1.0f, true);
+
+    if(occlusion.numTested() != 6 || occlusion.numOccluded() != 2)
+    {
+        cerr << "[occlusion_test] - " << occlusion.numOccluded() << " of " << occlusion.numTested() << " boxes were occluded, expected 2 of 6." << endl;
+        errors++;
+    }
+
+    // an empty depth buffer hides nothing
+    GLOcclusionCuller empty(256, 128, 1);
+    empty.render(projection * view);
+    errors += checkBox(empty, "without occluders", glm::vec3(0.0f, 0.0f, -20.0f), 0.5f, true);
+
+    // The right edge of this quad is at x = 174.56 in the depth buffer, so pixel 174 is covered.
+    // A box behind it that ends at x = 174.86 is visible on a strip of 0.3 pixels.
+    points[1].x() = 4.2f;
+    points[2].x() = 4.2f;
+
+    GLOcclusionCuller edge(256, 128, 1);
+    edge.addOccluder(points, indices);
+    edge.render(projection * view);
+    errors += checkBox(edge, "behind, less than a pixel beside the edge", glm::vec3(7.7432f, 0.0f, -20.0f), 0.5f, true);
+    errors += checkBox(edge, "behind, inside the edge", glm::vec3(6.0f, 0.0f, -20.0f), 0.5f, false);
+
+    if(errors > 0)
+    {
+        cerr << "[occlusion_test] - " << errors << " errors." << endl;
+        return 1;
+    }
+
+    cout << "[occlusion_test] - Passed." << endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+//
+//  stream_buffer_test.cpp
+//  HCI557_Simple_Texture
+//
+//  Maps vertices of 20 bytes, a position, a texture coordinate and a packed
+//  color, in all three ranges of a GLStreamBuffer and checks that every offset
+//  is a multiple of the vertex size and lies in the range of its frame. The
+//  4 MB ranges are no multiple of 20 bytes.
+//
+//  The offsets are checked without GPU first. With a headless context the test
+//  also maps the real buffer, otherwise that part is skipped.
+//
+
+// stl include
+#include <iostream>
+#include <string>
+
+// GLEW include
+#include <GL/glew.h>
+
+// glfw includes
+#include <GLFW/glfw3.h>
+
+
+// include local files
+#include "HCI557Common.h"
+#include "GLStreamBuffer.h"
+#include "GLHeadless.h"
+
+
+using namespace std;
+
+
+// The handle to the window object, see controls.cpp
+GLFWwindow*         window = NULL;
+
+
+// the size of a vertex with a position, a texture coordinate and a packed color
+static const GLsizeiptr VERTEX_SIZE = 20;
+
+// the vertex counts of the map() calls of one frame
+static const int MAP_COUNTS[] = {1, 7, 120, 3};
+static const int NUM_MAPS = 4;
+
+
+/*!
+ Checks one offset, returns the number of errors
+ */
+int checkOffset(const char* part, int range, GLsizeiptr frame_size, GLintptr offset, GLsizeiptr size)
+{
+    int errors = 0;
+    if(offset % VERTEX_SIZE != 0)
+    {
+        cerr << "[stream_buffer_test] - " << part << ": offset " << offset << " of range " << range << " is not a multiple of " << VERTEX_SIZE << endl;
+        errors++;
+    }
+    if(offset < range * frame_size || offset + size > (range + 1) * frame_size)
+    {
+        cerr << "[stream_buffer_test] - " << part << ": offset " << offset << " is outside of range " << range << endl;
+        errors++;
+    }
+    return errors;
+}
+
+
+
+int main(int argc, const char * argv[])
+{
+    GLsizeiptr frame_size = 4 * 1024 * 1024;
+    int errors = 0;
+
+    // the offsets, without GPU
+    for(int range=0; range<GLStreamBuffer::NUM_FRAMES; range++)
+    {
+        GLsizeiptr head = 0;
+        for(int i=0; i<NUM_MAPS; i++)
+        {
+            GLsizeiptr size = MAP_COUNTS[i] * VERTEX_SIZE;
+            GLintptr offset = GLStreamBuffer::alignOffset(range, frame_size, head, VERTEX_SIZE);
+            errors += checkOffset("alignOffset", range, frame_size, offset, size);
+            head = offset - range * frame_size + size;
+        }
+    }
+
+    // the real buffer, two rounds through all ranges
+    if(initHeadless(64, 64) && initGlew())
+    {
+        GLStreamBuffer stream(frame_size);
+        for(int frame=0; frame<2 * GLStreamBuffer::NUM_FRAMES; frame++)
+        {
+            int range = frame % GLStreamBuffer::NUM_FRAMES;
+            for(int i=0; i<NUM_MAPS; i++)
+            {
+                GLsizeiptr size = MAP_COUNTS[i] * VERTEX_SIZE;
+                GLintptr offset = -1;
+                char* data = (char*)stream.map(size, VERTEX_SIZE, offset);
+                if(data == NULL)
+                {
+                    cerr << "[stream_buffer_test] - map() failed in range " << range << endl;
+                    errors++;
+                    continue;
+                }
+                for(int b=0; b<size; b++) data[b] = (char)b;
+                stream.unmap();
+
+                errors += checkOffset("map", range, frame_size, offset, size);
+            }
+            stream.endFrame();
+        }
+        stream.release();
+        shutdownHeadless();
+    }
+    else
+    {
+        cout << "[stream_buffer_test] - No headless context, the mapped buffer is not tested." << endl;
+    }
+
+    if(errors > 0)
+    {
+        cerr << "[stream_buffer_test] - " << errors << " errors." << endl;
+        return 1;
+    }
+
+    cout << "[stream_buffer_test] - Passed." << endl;
+    return 0;
+}
@@ -0,0 +1,256 @@
+//
+//  transform_bench.cpp
+//  HCI557_Simple_Texture
+//
+//  Computes the world matrices of 1k, 10k, and 100k objects with glm, one
+//  object at a time, and with GLTransformSystem, and reports the times as JSON.
+//
+//  transform_bench [--counts N,N,...] [--iterations I] [--threads T] [--gpu] [--out <json file>]
+//
+//  --counts sets the object counts, 1000,10000,100000 by default.
+//  --threads sets the number of threads of update(), 1 runs everything on the calling thread.
+//  --gpu creates a headless context and also times write() into a GLStreamBuffer.
+//
+//  "simd" is avx2 if compute() uses the AVX2 / FMA kernel on this CPU.
+//  "glm" is translate(p) * mat4_cast(q) * scale(s) per object, "scalar" and "simd" are
+//  GLTransformSystem::computeScalar() and compute() on one thread, "pool" is update().
+//  "max_error" is the largest difference of a matrix element of compute() and glm.
+//  "simd_error" and "pool_error" are the largest differences of compute() and update() to
+//  computeScalar(), relative to the size of the element. The program returns 1 if one of
+//  them exceeds SIMD_TOLERANCE, so the benchmark also runs as a test of the AVX2 kernel.
+//
+
+// stl include
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+// glfw includes
+#include <GLFW/glfw3.h>
+
+
+// include local files
+#include "HCI557Common.h"
+#include "GLTransformSystem.h"
+#include "GLStreamBuffer.h"
+#include "GLThreadPool.h"
+#include "GLHeadless.h"
+
+
+using namespace std;
+
+
+// The handle to the window object, see controls.cpp
+GLFWwindow*         window = NULL;
+
+// the largest relative difference of the AVX2 / FMA kernel to the scalar code, FMA rounds
+// once instead of twice, the products differ in the last bits only
+static const float SIMD_TOLERANCE = 1.0e-5f;
+
+
+
+/*!
+ Returns the largest difference of two arrays, relative to the size of the elements
+ */
+float compareMatrices(const float* a, const float* b, int count)
+{
+    float max_error = 0.0f;
+    for(int i=0; i<count; i++)
+    {
+        float error = (float)fabs(a[i] - b[i]) / std::max(1.0f, (float)fabs(b[i]));
+        if(!(error <= max_error)) max_error = error; // NaN counts as an error
+    }
+    return max_error;
+}
+
+
+
+/*!
+ Runs a function I times and returns the smallest time of one run in ms
+ */
+template<typename Function>
+double measure(int iterations, Function function)
+{
+    double best = 1.0e30;
+    for(int i=0; i<iterations; i++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        function();
+        double ms = chrono::duration<double, std::milli>(chrono::steady_clock::now() - start).count();
+        best = std::min(best, ms);
+    }
+    return best;
+}
+
+
+
+int main(int argc, const char * argv[])
+{
+    vector<int> counts;
+    int iterations = 20;
+    int threads = 0;
+    bool gpu = false;
+    string out_file = "";
+
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = i+1 < argc;
+
+        if(arg == "--counts" && has_value)
+        {
+            stringstream list(argv[++i]);
+            string count;
+            while(getline(list, count, ',')) counts.push_back(atoi(count.c_str()));
+        }
+        else if(arg == "--iterations" && has_value) iterations = atoi(argv[++i]);
+        else if(arg == "--threads" && has_value) threads = atoi(argv[++i]);
+        else if(arg == "--out" && has_value) out_file = argv[++i];
+        else if(arg == "--gpu") gpu = true;
+        else
+        {
+            cerr << "[transform_bench] - Unknown argument " << arg << endl;
+            return -1;
+        }
+    }
+
+    if(counts.size() == 0)
+    {
+        counts.push_back(1000);
+        counts.push_back(10000);
+        counts.push_back(100000);
+    }
+    iterations = std::max(iterations, 1);
+    GLThreadPool::SetDefaultThreads(std::max(threads, 0));
+
+    if(gpu)
+    {
+        if(!initHeadless(WINDOW_WIDTH, WINDOW_HEIGHT)) return -1;
+        if(!initGlew()) return -1;
+    }
+
+
+    stringstream json;
+    json.setf(ios::fixed);
+    json.precision(3);
+    json << "{" << endl;
+    json << "  \"simd\": \"" << (GLSimdHasAVX() ? "avx2" : "none") << "\"," << endl;
+    json << "  \"threads\": " << GLThreadPool::Get().numThreads() << "," << endl;
+    json << "  \"iterations\": " << iterations << "," << endl;
+    json << "  \"runs\": [" << endl;
+
+    bool passed = true;
+
+    for(int c=0; c<counts.size(); c++)
+    {
+        int n = std::max(counts[c], 1);
+
+        // the same objects in every run
+        GLTransformSystem transforms;
+        transforms.reserve(n);
+        unsigned int random = 12345;
+        for(int i=0; i<n; i++)
+        {
+            float r[8];
+            for(int j=0; j<8; j++)
+            {
+                random = random * 1664525u + 1013904223u;
+                r[j] = (random >> 8) / 16777216.0f;
+            }
+            glm::quat q = glm::normalize(glm::quat(r[0] - 0.5f, r[1] - 0.5f, r[2] - 0.5f, r[3] - 0.5f));
+            transforms.add(glm::vec3(r[4] * 200.0f - 100.0f, r[5] * 20.0f, r[6] * 200.0f - 100.0f), q, glm::vec3(0.5f + r[7]));
+        }
+
+        vector<glm::mat4> reference(n);
+        vector<glm::mat4> scalar(n);
+        vector<glm::mat4> matrices(n);
+        float* out = &matrices[0][0][0];
+
+        double glm_ms = measure(iterations, [&](){
+            for(int i=0; i<n; i++)
+            {
+                reference[i] = glm::translate(transforms.getPosition(i)) * glm::mat4_cast(transforms.getRotation(i)) * glm::scale(transforms.getScale(i));
+            }
+        });
+        double scalar_ms = measure(iterations, [&](){ transforms.computeScalar(0, n, &scalar[0][0][0]); });
+        double simd_ms = measure(iterations, [&](){ transforms.compute(0, n, out); });
+        float simd_error = compareMatrices(out, &scalar[0][0][0], n * 16);
+        double pool_ms = measure(iterations, [&](){ transforms.update(out); });
+        float pool_error = compareMatrices(out, &scalar[0][0][0], n * 16);
+
+        float max_error = 0.0f;
+        const float* expected = &reference[0][0][0];
+        for(int i=0; i<n * 16; i++)
+        {
+            max_error = std::max(max_error, (float)fabs(out[i] - expected[i]));
+        }
+
+        if(!(simd_error <= SIMD_TOLERANCE) || !(pool_error <= SIMD_TOLERANCE))
+        {
+            cerr << "[transform_bench] - compute() differs from computeScalar() for " << n << " objects, " << simd_error << " and " << pool_error << " with the pool." << endl;
+            passed = false;
+        }
+
+        json << "    { \"objects\": " << n
+             << ", \"glm_ms\": " << glm_ms
+             << ", \"scalar_ms\": " << scalar_ms
+             << ", \"simd_ms\": " << simd_ms
+             << ", \"pool_ms\": " << pool_ms
+             << ", \"speedup\": " << (simd_ms > 0.0 ? glm_ms / simd_ms : 0.0);
+
+        if(gpu)
+        {
+            // one frame of the buffer holds all matrices
+            GLStreamBuffer stream(n * sizeof(glm::mat4));
+            double write_ms = measure(iterations, [&](){
+                if(transforms.write(stream) < 0) cerr << "[transform_bench] - The stream buffer is full." << endl;
+                stream.endFrame();
+            });
+            stream.release();
+
+            json << ", \"gpu_write_ms\": " << write_ms;
+        }
+
+        json.precision(7);
+        json << ", \"max_error\": " << max_error << ", \"simd_error\": " << simd_error << ", \"pool_error\": " << pool_error << " }" << (c + 1 < counts.size() ? "," : "") << endl;
+        json.precision(3);
+    }
+
+    json << "  ]" << endl;
+    json << "}" << endl;
+
+    if(out_file.length() > 0)
+    {
+        ofstream out(out_file.c_str());
+        if(!out.is_open())
+        {
+            cerr << "[transform_bench] - Cannot open " << out_file << endl;
+            return -1;
+        }
+        out << json.str();
+        out.close();
+    }
+    else
+    {
+        cout << json.str();
+    }
+
+    if(!passed) return 1;
+    return 0;
+}
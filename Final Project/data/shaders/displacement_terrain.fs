@@ -0,0 +1,118 @@
+#version 330 core
+#define MAX_LIGHTS 10
+
+// Transformations for the projections
+uniform mat4 modelMatrixBox;
+uniform mat4 inverseViewMatrix;
+
+uniform int numLights;
+
+// The light sources
+uniform struct Light {
+    vec4 light_position;
+    float diffuse_intensity;
+    float ambient_intensity;
+    float specular_intensity;
+    float attenuationCoefficient;
+    float cone_angle;
+    vec3 cone_direction;
+} allLights[MAX_LIGHTS];
+
+
+// The material parameters
+uniform struct Material {
+    vec3 diffuse;
+    vec3 ambient;
+    vec3 specular;
+    vec3 emissive;
+    float shininess;
+    float transparency;
+} allMaterials[1];
+
+
+uniform sampler2D tex; // the color texture
+uniform sampler2D height_map; // the height map of the vertex shader
+
+uniform float terrain_size;
+uniform float terrain_height;
+
+// 0: the texture is lit, 1: the texture only
+uniform int texture_blend;
+
+in vec2 pass_HeightCoord;
+in vec2 pass_TexCoord;
+in vec4 pass_surfacePostion;
+
+out vec4 color;
+
+
+
+vec3 useLight(Light light, vec4 surfacePostion, vec3 normal, Material material)
+{
+    // Calculate the vector from surface to the current light
+    vec3 surface_to_light = normalize(light.light_position.xyz - surfacePostion.xyz);
+    if(light.light_position.w == 0.0){
+        surface_to_light = normalize(light.light_position.xyz);
+    }
+
+    // Diffuse color
+    float diffuse_coefficient = max(dot(normal, surface_to_light), 0.0);
+    vec3 out_diffuse_color = material.diffuse * diffuse_coefficient * light.diffuse_intensity;
+
+    // Ambient color
+    vec3 out_ambient_color = material.ambient * light.ambient_intensity;
+
+    // Specular color
+    vec3 reflectionVector = reflect(-surface_to_light, normal);
+    vec3 cameraPosition = vec3(inverseViewMatrix[3][0], inverseViewMatrix[3][1], inverseViewMatrix[3][2]);
+    vec3 surfaceToCamera = normalize(cameraPosition - surfacePostion.xyz);
+    float cosAngle = max(dot(surfaceToCamera, reflectionVector), 0.0);
+    float specular_coefficient = pow(cosAngle, material.shininess);
+    vec3 out_specular_color = material.specular * specular_coefficient * light.specular_intensity;
+
+    // attenuation
+    float attenuation = 1.0;
+    if(light.light_position.w == 1.0)
+    {
+        float distanceToLight = length(light.light_position.xyz - surfacePostion.xyz);
+        attenuation = 1.0 / (1.0 + light.attenuationCoefficient * pow(distanceToLight, 2));
+
+        // Spotlight, no light outside the cone
+        float light_to_surface_angle = degrees(acos(dot(-surface_to_light, normalize(light.cone_direction))));
+        if(light_to_surface_angle > light.cone_angle){
+            attenuation = 0.0;
+        }
+    }
+
+    return out_ambient_color + attenuation * (out_diffuse_color + out_specular_color);
+}
+
+
+
+void main(void)
+{
+    // The normal vector from the gradient of the height map, central differences
+    vec2 texel = 1.0 / vec2(textureSize(height_map, 0));
+    float hl = texture(height_map, pass_HeightCoord - vec2(texel.x, 0.0)).r;
+    float hr = texture(height_map, pass_HeightCoord + vec2(texel.x, 0.0)).r;
+    float hd = texture(height_map, pass_HeightCoord - vec2(0.0, texel.y)).r;
+    float hu = texture(height_map, pass_HeightCoord + vec2(0.0, texel.y)).r;
+
+    vec2 gradient = vec2(hr - hl, hu - hd) * terrain_height / (2.0 * terrain_size * texel);
+    vec3 normal = normalize(mat3(modelMatrixBox) * vec3(-gradient.x, 1.0, -gradient.y));
+
+    vec4 tex_color = texture(tex, pass_TexCoord);
+
+    if(texture_blend == 1)
+    {
+        color = tex_color;
+        return;
+    }
+
+    vec3 linearColor = vec3(0.0);
+    for (int i=0; i<numLights; i++) {
+        linearColor = linearColor + useLight(allLights[i], pass_surfacePostion, normal, allMaterials[0]);
+    }
+
+    color = vec4(tex_color.rgb * linearColor, 1.0);
+}
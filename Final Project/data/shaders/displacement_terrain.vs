@@ -0,0 +1,48 @@
+#version 330 core
+
+// The vertex buffer input, one cell of the shared grid in [0, 1] x [0, 1]
+in vec3 in_Position;
+
+// Transformations for the projections
+uniform mat4 projectionMatrixBox;
+uniform mat4 viewMatrixBox;
+uniform mat4 modelMatrixBox;
+uniform mat4 inverseViewMatrix;
+
+// The height map, the red channel in [0, 1]
+uniform sampler2D height_map;
+
+// The terrain covers [-size/2, size/2] in x and z, a white pixel is height units high
+uniform float terrain_size;
+uniform float terrain_height;
+
+// The grid is drawn tiles x tiles times, one instance per tile
+uniform int terrain_tiles;
+
+// The number of color texture repeats across the terrain
+uniform float texture_repeat;
+
+
+// The height map coordinate, the texture coordinate, and the world position
+out vec2 pass_HeightCoord;
+out vec2 pass_TexCoord;
+out vec4 pass_surfacePostion;
+
+
+void main(void)
+{
+    // the tile of this instance
+    vec2 tile = vec2(gl_InstanceID % terrain_tiles, gl_InstanceID / terrain_tiles);
+    vec2 uv = (tile + in_Position.xz) / float(terrain_tiles);
+
+    // the vertex is moved up by the height map, no mipmaps in the vertex shader
+    float h = textureLod(height_map, uv, 0.0).r * terrain_height;
+    vec4 position = vec4((uv.x - 0.5) * terrain_size, h, (uv.y - 0.5) * terrain_size, 1.0);
+
+    pass_HeightCoord = uv;
+    pass_TexCoord = uv * texture_repeat;
+    pass_surfacePostion = modelMatrixBox * position;
+
+    // Passes the projected position to the fragment shader / rasterization process.
+    gl_Position = projectionMatrixBox * viewMatrixBox * pass_surfacePostion;
+}
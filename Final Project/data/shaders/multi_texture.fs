@@ -2,44 +2,72 @@
 
 uniform sampler2D texture_background; //this is the texture
 uniform sampler2D texture_foreground; //this is the texture
-uniform sampler2D texture_between;
 in vec2 pass_TexCoord; //this is the texture coord
 in vec4 pass_Color;
+in vec4 pass_WorldPosition;
 out vec4 color;
 
 uniform int texture_blend;
 
+// The static and the dynamic shadow layer, see GLShadowMap
+uniform sampler2DShadow shadowMapStatic;
+uniform sampler2DShadow shadowMapDynamic;
+uniform mat4 shadowMatrixStatic;
+uniform mat4 shadowMatrixDynamic;
+uniform int shadowEnabled;
+uniform int shadowDynamicEnabled;
+
+
+// Returns 1.0 if the position is lit and 0.0 if it is in the shadow
+float shadowLookup(sampler2DShadow shadow_map, mat4 shadow_matrix)
+{
+    vec4 p = shadow_matrix * pass_WorldPosition;
+    
+    // behind the light or beyond the far plane
+    if(p.w <= 0.0 || p.z > p.w) return 1.0;
+    
+    return textureProj(shadow_map, p);
+}
+
 void main(void)                                                   
-{//texture_blend=2;
+{
     // This function finds the color component for each texture coordinate. 
+    // The sky is drawn behind the scene, see GLSkybox.
     vec4 tex_color =  texture(texture_background, pass_TexCoord);
     
     vec4 tex_color_light =  texture(texture_foreground, pass_TexCoord);
     
-    vec4 tex_color_light1 = texture(texture_between, pass_TexCoord);
     // This mixes the background color with the texture color.
     // The GLSL shader code replaces the former envrionment. It is now up to us
     // to figure out how we like to blend a texture with the background color.
     if(texture_blend == 0)
     {          //blend combination one (I have used this to obtain the output "compgraph.jpg")
 
-        //color = 0.1* pass_Color + 0.4*tex_color + 1.0*tex_color_light+0.6*tex_color_light1 ;
+        //color = 0.1* pass_Color + 0.4*tex_color + 1.0*tex_color_light ;
 
         //blend combination two (I have used this to obtain the output "compgraph2.jpg")
-         color = (tex_color_light.r)*tex_color+2*0.25*tex_color_light1;
-         //color=0.1*pass_Color+1.0*tex_color+0.1*tex_color_light+0.5*tex_color_light1;
+         color = (tex_color_light.r)*tex_color;
+         //color=0.1*pass_Color+1.0*tex_color+0.1*tex_color_light;
     }
     else if(texture_blend == 1)
     {
-        color = tex_color * tex_color_light+tex_color_light1;
+        color = tex_color * tex_color_light;
     }
     else if(texture_blend == 2)
     {
-        color = (tex_color_light.r)*tex_color+tex_color_light1 ;
+        color = (tex_color_light.r)*tex_color ;
     }
     else
     {
-        color = 0.1 * pass_Color + tex_color+tex_color_light1;
+        color = 0.1 * pass_Color + tex_color;
     }
     
-}
\ No newline at end of file
+    
+    // Darkens the color in the shadow of the static and the dynamic casters
+    if(shadowEnabled != 0)
+    {
+        float lit = shadowLookup(shadowMapStatic, shadowMatrixStatic);
+        if(shadowDynamicEnabled != 0) lit = min(lit, shadowLookup(shadowMapDynamic, shadowMatrixDynamic));
+        color.rgb *= mix(0.4, 1.0, lit);
+    }
+}
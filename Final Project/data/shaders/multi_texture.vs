@@ -41,6 +41,9 @@ uniform struct Material {
 out vec4 pass_Color;
 out vec2 pass_TexCoord;
 
+// The world space position for the shadow lookup
+out vec4 pass_WorldPosition;
+
 
 vec4 useLight(Light light, vec4 surfacePostion, vec4 normal_transformed, vec3 normal, Material material )
 {
@@ -158,6 +161,9 @@ void main(void)
     // Passes the texture coordinates to the next pipeline processes.
     pass_TexCoord = in_TexCoord;
     
+    // Passes the world space position for the shadow maps
+    pass_WorldPosition = surfacePostion;
+    
 }
 
 
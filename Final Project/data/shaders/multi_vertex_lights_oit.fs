@@ -0,0 +1,22 @@
+#version 410 core                                                 
+
+
+in vec4 pass_Color;
+
+// weighted blended order-independent transparency, see GLTransparencyPass
+layout(location = 0) out vec4 accum;
+layout(location = 1) out float weight;
+
+void main(void)                                                   
+{                                                                 
+    float alpha = clamp(pass_Color.a, 0.0, 1.0);
+
+    // near fragments get a larger weight than far fragments. The weight is clamped to
+    // [1e-2, 3e3] like in the paper, so the 16 bit float targets hold the sums of
+    // about 21 opaque layers; GLTransparencyPass handles an overflow in the composite.
+    float w = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 *
+                    pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+
+    accum = vec4(pass_Color.rgb * alpha * w, alpha);
+    weight = alpha * w;
+}                           
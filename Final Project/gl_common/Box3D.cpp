@@ -7,6 +7,7 @@
 //
 
 #include "Box3D.h"
+#include "GLProfiler.h"
 
 
 
@@ -25,10 +26,7 @@ GLBox3D::GLBox3D(float width, float height, float length,  int rows, int cols  )
 
 GLBox3D::~GLBox3D()
 {
-    // Program clean up when the window gets closed.
-    glDeleteVertexArrays(1, _vaoID);
-    glDeleteProgram(_program);
-
+    // the program belongs to the appearance, the handles delete the buffers
 }
 
 
@@ -53,23 +51,17 @@ void GLBox3D::init(void)
 /*!
  Draw the objects
  */
-void GLBox3D::draw(void)
+bool GLBox3D::drawGeometry(void)
 {
+    GL_PROFILE_ZONE("GLBox3D::drawGeometry");
     
     //////////////////////////////////////////////////
     // Renders the sphere
     
-    // Enable the shader program
-    glUseProgram(_program);
-    
-    // this changes the camera location
-    glm::mat4 rotated_view =  rotatedViewMatrix();
-    glUniformMatrix4fv(_viewMatrixLocation, 1, GL_FALSE, &rotated_view[0][0]); // send the view matrix to our shader
-    glUniformMatrix4fv(_inverseViewMatrixLocation, 1, GL_FALSE, &invRotatedViewMatrix()[0][0]);
     glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
     
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
+    glBindVertexArray(_vao.id());
     
    // glPolygonMode( GL_FRONT_AND_BACK, GL_LINE ); // allows to see the primitives
     // Draw the triangles
@@ -79,14 +71,45 @@ void GLBox3D::draw(void)
     glDrawArrays(GL_TRIANGLE_STRIP, 12, 4);
     glDrawArrays(GL_TRIANGLE_STRIP, 16, 4);
     glDrawArrays(GL_TRIANGLE_STRIP, 20, 4);
+    for(int i=0; i<6; i++) GLProfiler::Get().countDraw(2);
     
     // Unbind our Vertex Array Object
     glBindVertexArray(0);
     
-    // Unbind the shader program
-    glUseProgram(0);
+    return true;
+}
+
+
+
+/*!
+ Returns the box as indexed triangles, e.g., to share the geometry with a
+ GLInstancedMesh. Each side is a triangle strip with four vertices,
+ which becomes two triangles.
+ */
+bool GLBox3D::getTriangles(vector<Vertex>& points, vector<Vertex>& normals, vector<GLuint>& indices)
+{
+    make_box(_center_x, _center_y, _center_z, _width, _height, _rows, _cols, points, normals);
     
+    indices.clear();
+    for(GLuint i=0; i<points.size(); i+=4)
+    {
+        indices.push_back(i); indices.push_back(i+1); indices.push_back(i+2);
+        indices.push_back(i+2); indices.push_back(i+1); indices.push_back(i+3);
+    }
     
+    return true;
+}
+
+
+/*!
+ Draws the triangles of the vertex array with the bound program
+ */
+bool GLBox3D::drawVertexArray(void)
+{
+    glBindVertexArray(_vao.id());
+    for(int i=0; i<6; i++) glDrawArrays(GL_TRIANGLE_STRIP, i * 4, 4);
+    glBindVertexArray(0);
+    return true;
 }
 
 
@@ -132,6 +155,7 @@ void GLBox3D::initShader(void)
  */
 void GLBox3D::initVBO(void)
 {
+    GL_PROFILE_ZONE("GLBox3D::initVBO");
     
     
     _vertex_points.clear();
@@ -163,19 +187,24 @@ void GLBox3D::initVBO(void)
 
     }
     
+    // the local bounds for view-frustum culling
+    computeBounds(vertices, _num_vertices, 5);
+    
     glUseProgram(_program);
     
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
+    _vao.create(GLResource::VERTEX_ARRAY, "GLBox3D"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
     
-    glGenBuffers(3, _vboID); // Generate our Vertex Buffer Object
+    _vbo[0].create(GLResource::BUFFER, "GLBox3D"); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, "GLBox3D");
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // vertices
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 5 * sizeof(GLfloat), &vertices[0], GL_DYNAMIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[0].setSize(_num_vertices * 5 * sizeof(GLfloat));
     
     
     int locPos = glGetAttribLocation(_program, "in_Position");
@@ -191,8 +220,9 @@ void GLBox3D::initVBO(void)
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //Normals
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our second Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our second Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 *  sizeof(GLfloat), normals, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[1].setSize(_num_vertices * 3 *  sizeof(GLfloat));
     
     int locNorm = glGetAttribLocation(_program, "in_Normal");
     glEnableVertexAttribArray(locNorm); //
@@ -202,8 +232,8 @@ void GLBox3D::initVBO(void)
     glBindVertexArray(0); // Disable our Vertex Buffer Object
     
     // delete the memory
-    delete vertices;
-    delete normals;
+    delete[] vertices;
+    delete[] normals;
 }
 
 
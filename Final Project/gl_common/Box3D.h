@@ -51,9 +51,29 @@ public:
     
     
     /*!
-     Draw the objects
+     Draw the objects with the bound program and textures
+     See GLObject::drawGeometry()
      */
-    virtual void draw(void);
+    virtual bool drawGeometry(void);
+
+    
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
+    
+    
+    /*!
+     Returns the box as indexed triangles, e.g., to share the geometry with a
+     GLInstancedMesh. This function does not need an OpenGL context.
+     */
+    virtual bool getTriangles(vector<Vertex>& points, vector<Vertex>& normals, vector<GLuint>& indices);
+    
+    
+    /*!
+     Draws the triangles of the vertex array with the bound program
+     */
+    virtual bool drawVertexArray(void);
     
     
 protected:
@@ -98,8 +118,8 @@ protected:
     // the program
     GLuint                  _program;
     
-    unsigned int            _vaoID[1]; // Our Vertex Array Object
-    unsigned int            _vboID[2]; // Our Vertex Buffer Object
+    GLResource              _vao; // Our Vertex Array Object
+    GLResource              _vbo[2]; // Our Vertex Buffer Object
 
 
 };
@@ -1,6 +1,7 @@
 
 
 #include "CoordSystem.h"
+#include "GLProfiler.h"
 
 
 
@@ -53,7 +54,6 @@ CoordSystem::CoordSystem(float length):
 CoordSystem::~CoordSystem()
 {
     // Program clean up when the window gets closed.
-    glDeleteVertexArrays(1, _vaoID);
     glDeleteProgram(_program);
 }
 
@@ -63,6 +63,7 @@ CoordSystem::~CoordSystem()
  */
 void CoordSystem::draw(void)
 {
+    GL_PROFILE_ZONE("CoordSystem::draw");
     
     // Enable the shader program
     glUseProgram(_program);
@@ -75,11 +76,12 @@ void CoordSystem::draw(void)
     
 
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
+    glBindVertexArray(_vao.id());
     
     glLineWidth((GLfloat)3.0);
     // Draw the triangles
     glDrawArrays(GL_LINES, 0, 6);
+    GLProfiler::Get().countDraw(0);
     
     // Unbind our Vertex Array Object
     glBindVertexArray(0);
@@ -101,6 +103,7 @@ void CoordSystem::draw(void)
  */
 void CoordSystem::initVBO(void)
 {
+    GL_PROFILE_ZONE("CoordSystem::initVBO");
 
 
 
@@ -112,24 +115,30 @@ void CoordSystem::initVBO(void)
                         0.0, 1.0, 0.0, 0.0, 1.0, 0.0,
                         0.0, 0.0, 1.0, 0.0, 0.0, 1.0};
     
+    // the local bounds for view-frustum culling
+    computeBounds(vertices, 6, 3);
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
     
+    _vao.create(GLResource::VERTEX_ARRAY, "CoordSystem"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
-    glGenBuffers(2, _vboID); // Generate our Vertex Buffer Object
+    
+    _vbo[0].create(GLResource::BUFFER, "CoordSystem"); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, "CoordSystem");
     
     // vertices
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(GLfloat), vertices, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[0].setSize(18 * sizeof(GLfloat));
     
     glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(0); //
     
     
     //Color
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our second Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our second Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(GLfloat), colors, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[1].setSize(18 * sizeof(GLfloat));
     
     glVertexAttribPointer((GLuint)1, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(1); //
@@ -32,6 +32,12 @@ public:
      Draw the objects
      */
     void draw(void);
+
+    
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
     
 
     
@@ -59,9 +65,9 @@ private:
     glm::mat4               _modelMatrix; // Store the model matrix
     
     
-    unsigned int            _vaoID[1]; // Our Vertex Array Object
+    GLResource              _vao; // Our Vertex Array Object
     
-    unsigned int            _vboID[1]; // Our Vertex Buffer Object
+    GLResource              _vbo[2]; // Our Vertex Buffer Object
     
     // length of the line
     float                   _length;
@@ -283,6 +283,10 @@ GLAppearance::GLAppearance(string vertex_shader_file, string fragment_shader_fil
     // This loads the shader program from a file
     _program = LoadAndCreateShaderProgram(vertex_shader_file, fragment_shader_file);
     
+    // copies of this appearance share the program, the last one deletes it
+    _program_handle = make_shared<GLResource>();
+    _program_handle->adopt(GLResource::PROGRAM, _program, fragment_shader_file);
+    
     GLint params;
     glGetProgramiv( _program, GL_LINK_STATUS, &params);
     if(params == GL_FALSE)
@@ -294,6 +298,7 @@ GLAppearance::GLAppearance(string vertex_shader_file, string fragment_shader_fil
     glUseProgram(_program);
     
     _num_light_sources = 0;
+    _material = NULL;
     
     _exists = true;
     _finalized = false;
@@ -303,6 +308,7 @@ GLAppearance::GLAppearance(string vertex_shader_file, string fragment_shader_fil
 GLAppearance::GLAppearance()
 {
     _program = -1;
+    _material = NULL;
     _exists = false;
 }
 
@@ -310,8 +316,7 @@ GLAppearance::GLAppearance()
 
 GLAppearance::~GLAppearance()
 {
-
-
+    // the program handle deletes the program with the last copy
 }
 
 
@@ -468,4 +473,62 @@ void GLAppearance::setTexture(GLMultiTexture* texture)
 }
 
 
+/*!
+ Returns the OpenGL id of the first texture, or 0 if the appearance has no texture.
+ */
+GLuint GLAppearance::getTextureID(void)
+{
+    if(_textures.size() == 0) return 0;
+    
+    GLTexture* texture = dynamic_cast<GLTexture*>(_textures[0]);
+    if(texture != NULL) return texture->_texture.id();
+    
+    GLMultiTexture* multi_texture = dynamic_cast<GLMultiTexture*>(_textures[0]);
+    if(multi_texture != NULL) return multi_texture->_texture_1.id();
+    
+    return 0;
+}
+
+
+/*!
+ Binds the textures to their texture units. Evicted textures are loaded again.
+ @return the number of bound textures
+ */
+int GLAppearance::bindTextures(void)
+{
+    int count = 0;
+    
+    for(int i=0; i<_textures.size(); i++)
+    {
+        GLTexture* texture = dynamic_cast<GLTexture*>(_textures[i]);
+        if(texture != NULL)
+        {
+            texture->bind();
+            count++;
+            continue;
+        }
+        
+        GLMultiTexture* multi_texture = dynamic_cast<GLMultiTexture*>(_textures[i]);
+        if(multi_texture != NULL)
+        {
+            multi_texture->bind();
+            count++;
+        }
+    }
+    
+    return count;
+}
+
+
+/*!
+ Returns true if a material is set and its transparency is smaller than 1
+ */
+bool GLAppearance::isTransparent(void)
+{
+    if(_material == NULL) return false;
+    
+    return _material->_transparency < 1.0;
+}
+
+
 
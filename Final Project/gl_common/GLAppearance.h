@@ -13,6 +13,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <memory>
 
 // GLEW include
 #include <GL/glew.h>
@@ -351,6 +352,25 @@ public:
     void setTexture(GLTexture* texture);
     void setTexture(GLMultiTexture* texture);
     
+    
+    /*!
+     Returns the OpenGL id of the first texture, or 0 if the appearance has no texture.
+     */
+    GLuint getTextureID(void);
+    
+    
+    /*!
+     Binds the textures to their texture units. Evicted textures are loaded again.
+     @return the number of bound textures
+     */
+    int bindTextures(void);
+    
+    
+    /*!
+     Returns true if a material is set and its transparency is smaller than 1
+     */
+    bool isTransparent(void);
+    
 protected:
     
     /*!
@@ -367,6 +387,9 @@ private:
     // The shader program
     GLuint                      _program;
     
+    // owns the program, shared by all copies of this appearance
+    shared_ptr<GLResource>      _program_handle;
+    
     
     // The material for this object
     GLMaterial*                 _material;
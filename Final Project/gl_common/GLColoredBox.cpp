@@ -91,7 +91,6 @@ GLColoredBox::GLColoredBox(float size_x, float size_y, float size_z):
 GLColoredBox::~GLColoredBox()
 {
     // Program clean up when the window gets closed.
-    glDeleteVertexArrays(1, _vaoID);
     glDeleteProgram(_program);
 }
 
@@ -114,7 +113,7 @@ void GLColoredBox::draw(void)
     glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
     
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
+    glBindVertexArray(_vao.id());
     
 
     // Draw the triangles
@@ -184,23 +183,26 @@ void GLColoredBox::initVBO(void)
                         };
     
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
+    _vao.create(GLResource::VERTEX_ARRAY, "GLColoredBox"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
     
-    glGenBuffers(2, _vboID); // Generate our Vertex Buffer Object
+    _vbo[0].create(GLResource::BUFFER, "GLColoredBox"); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, "GLColoredBox");
     
     // vertices
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, 72 * sizeof(GLfloat), vertices, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[0].setSize(72 * sizeof(GLfloat));
     
     glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(0); //
     
     
     //Color
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our second Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our second Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, 72 * sizeof(GLfloat), colors, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[1].setSize(72 * sizeof(GLfloat));
     
     glVertexAttribPointer((GLuint)1, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(1); //
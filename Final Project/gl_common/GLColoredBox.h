@@ -41,6 +41,12 @@ public:
      Draw the objects
      */
     void draw(void);
+
+    
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
     
     
     /*!
@@ -78,9 +84,9 @@ private:
     glm::mat4               _modelMatrix; // Store the model matrix
     
     
-    unsigned int            _vaoID[1]; // Our Vertex Array Object
+    GLResource              _vao; // Our Vertex Array Object
     
-    unsigned int            _vboID[1]; // Our Vertex Buffer Object
+    GLResource              _vbo[2]; // Our Vertex Buffer Object
     
     // the dimensions of the box
     float                   _size_x;
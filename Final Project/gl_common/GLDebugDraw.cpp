@@ -0,0 +1,399 @@
+//
+//  GLDebugDraw.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLDebugDraw.h"
+#include "Shaders.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+#include <math.h>
+
+
+// the number of lines of a circle of sphere()
+static const int CIRCLE_SEGMENTS = 16;
+
+
+static const string debug_vs =
+"#version 330 core                                                  \n"
+"uniform mat4 view_projection;                                      \n"
+"in vec3 in_Position;                                               \n"
+"in vec4 in_Color;                                                  \n"
+"out vec4 pass_Color;                                               \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    gl_Position = view_projection * vec4(in_Position, 1.0);        \n"
+"    pass_Color = in_Color;                                         \n"
+"}                                                                  \n";
+
+static const string debug_fs =
+"#version 330 core                                                  \n"
+"in vec4 pass_Color;                                                \n"
+"out vec4 color;                                                    \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    color = pass_Color;                                            \n"
+"}                                                                  \n";
+
+
+
+/*!
+ Returns the debug draw of this application
+ */
+//static
+GLDebugDraw& GLDebugDraw::Get(void)
+{
+    static GLDebugDraw debug_draw;
+    return debug_draw;
+}
+
+
+GLDebugDraw::GLDebugDraw()
+{
+    for(int i=0; i<2; i++)
+    {
+        Stream& s = _streams[i];
+        s.buffer = new GLStreamBuffer((i == 0 ? MAX_VERTICES : MAX_OVERLAY_VERTICES) * sizeof(DebugVertex));
+        s.data = NULL;
+        s.used = 0;
+        s.first = 0;
+        s.count = 0;
+        s.lines = 0;
+        s.full = false;
+    }
+
+    _enabled = true;
+    _num_lines = 0;
+
+    _viewProjectionLocation = -1;
+    _positionLocation = -1;
+    _colorLocation = -1;
+}
+
+
+GLDebugDraw::~GLDebugDraw()
+{
+    for(int i=0; i<2; i++) delete _streams[i].buffer;
+}
+
+
+/*!
+ Deletes the buffers and the program
+ */
+void GLDebugDraw::release(void)
+{
+    for(int i=0; i<2; i++)
+    {
+        _streams[i].buffer->release();
+        _streams[i].data = NULL;
+    }
+    _vao.release();
+    _program.release();
+}
+
+
+/*!
+ Packs a color with components from 0 to 1
+ */
+//static
+GLuint GLDebugDraw::pack(const glm::vec3& color)
+{
+    GLuint r = (GLuint)(std::min(std::max(color.x, 0.0f), 1.0f) * 255.0f + 0.5f);
+    GLuint g = (GLuint)(std::min(std::max(color.y, 0.0f), 1.0f) * 255.0f + 0.5f);
+    GLuint b = (GLuint)(std::min(std::max(color.z, 0.0f), 1.0f) * 255.0f + 0.5f);
+
+    // the bytes in memory are r, g, b, a
+    return r | (g << 8) | (b << 16) | (255u << 24);
+}
+
+
+/*!
+ Returns room for count vertices, maps the next chunk if needed
+ */
+GLDebugDraw::DebugVertex* GLDebugDraw::reserve(bool depth_test, int count)
+{
+    Stream& s = _streams[depth_test ? 0 : 1];
+    if(s.full) return NULL;
+
+    if(s.data == NULL || s.used + count > CHUNK_VERTICES)
+    {
+        if(s.data != NULL)
+        {
+            // the next chunk follows this one, the rest of this chunk becomes lines of length 0
+            for(int i=s.used; i<CHUNK_VERTICES; i++)
+            {
+                s.data[i].position = glm::vec3(0.0f, 0.0f, 0.0f);
+                s.data[i].color = 0;
+            }
+            s.count += CHUNK_VERTICES - s.used;
+            s.buffer->unmap();
+            s.data = NULL;
+        }
+
+        GLintptr offset = 0;
+        void* data = s.buffer->map(CHUNK_VERTICES * sizeof(DebugVertex), sizeof(DebugVertex), offset);
+        if(data == NULL)
+        {
+            s.full = true;
+            return NULL;
+        }
+
+        if(s.count == 0) s.first = (GLint)(offset / sizeof(DebugVertex));
+        s.data = (DebugVertex*)data;
+        s.used = 0;
+    }
+
+    DebugVertex* v = s.data + s.used;
+    s.used += count;
+    s.count += count;
+    s.lines += count / 2;
+    return v;
+}
+
+
+/*!
+ Adds a line
+ */
+void GLDebugDraw::line(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color, bool depth_test)
+{
+    if(!_enabled) return;
+
+    DebugVertex* v = reserve(depth_test, 2);
+    if(v == NULL) return;
+
+    GLuint c = pack(color);
+    v[0].position = a;
+    v[0].color = c;
+    v[1].position = b;
+    v[1].color = c;
+}
+
+
+/*!
+ Adds the 12 edges of a box from its corners
+ */
+void GLDebugDraw::box(const glm::vec3 corners[8], const glm::vec3& color, bool depth_test)
+{
+    DebugVertex* v = reserve(depth_test, 24);
+    if(v == NULL) return;
+
+    GLuint c = pack(color);
+
+    // an edge connects two corners which differ in one bit
+    for(int i=0; i<8; i++)
+    {
+        for(int bit=1; bit<8; bit<<=1)
+        {
+            if(i & bit) continue;
+
+            v->position = corners[i];
+            v->color = c;
+            v++;
+            v->position = corners[i | bit];
+            v->color = c;
+            v++;
+        }
+    }
+}
+
+
+/*!
+ Adds the 12 edges of an axis aligned box
+ */
+void GLDebugDraw::aabb(const glm::vec3& bmin, const glm::vec3& bmax, const glm::vec3& color, bool depth_test)
+{
+    if(!_enabled) return;
+
+    glm::vec3 corners[8];
+    for(int i=0; i<8; i++)
+    {
+        corners[i] = glm::vec3((i & 1) ? bmax.x : bmin.x, (i & 2) ? bmax.y : bmin.y, (i & 4) ? bmax.z : bmin.z);
+    }
+    box(corners, color, depth_test);
+}
+
+
+/*!
+ Adds three circles around the x, y, and z axis
+ */
+void GLDebugDraw::sphere(const glm::vec3& center, float radius, const glm::vec3& color, bool depth_test)
+{
+    if(!_enabled) return;
+
+    static float cos_table[CIRCLE_SEGMENTS + 1];
+    static float sin_table[CIRCLE_SEGMENTS + 1];
+    static bool tables = false;
+    if(!tables)
+    {
+        for(int i=0; i<=CIRCLE_SEGMENTS; i++)
+        {
+            cos_table[i] = (float)cos(2.0 * 3.14159265358979323846 * i / CIRCLE_SEGMENTS);
+            sin_table[i] = (float)sin(2.0 * 3.14159265358979323846 * i / CIRCLE_SEGMENTS);
+        }
+        tables = true;
+    }
+
+    DebugVertex* v = reserve(depth_test, 3 * CIRCLE_SEGMENTS * 2);
+    if(v == NULL) return;
+
+    GLuint c = pack(color);
+    for(int axis=0; axis<3; axis++)
+    {
+        for(int i=0; i<CIRCLE_SEGMENTS; i++)
+        {
+            for(int k=i; k<=i + 1; k++)
+            {
+                glm::vec3 p(0.0f, 0.0f, 0.0f);
+                p[(axis + 1) % 3] = cos_table[k] * radius;
+                p[(axis + 2) % 3] = sin_table[k] * radius;
+
+                v->position = center + p;
+                v->color = c;
+                v++;
+            }
+        }
+    }
+}
+
+
+/*!
+ Adds the 12 edges of a view frustum
+ */
+void GLDebugDraw::frustum(const glm::mat4& view_projection, const glm::vec3& color, bool depth_test)
+{
+    if(!_enabled) return;
+
+    glm::mat4 inv = glm::inverse(view_projection);
+
+    glm::vec3 corners[8];
+    for(int i=0; i<8; i++)
+    {
+        glm::vec4 p = inv * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+        corners[i] = glm::vec3(p) / p.w;
+    }
+    box(corners, color, depth_test);
+}
+
+
+/*!
+ Adds the x, y, and z axis of a coordinate system
+ */
+void GLDebugDraw::axis(const glm::mat4& matrix, float length, bool depth_test)
+{
+    if(!_enabled) return;
+
+    DebugVertex* v = reserve(depth_test, 6);
+    if(v == NULL) return;
+
+    glm::vec3 origin = glm::vec3(matrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    for(int i=0; i<3; i++)
+    {
+        glm::vec4 end(0.0f, 0.0f, 0.0f, 1.0f);
+        end[i] = length;
+
+        glm::vec3 color(0.0f, 0.0f, 0.0f);
+        color[i] = 1.0f;
+        GLuint c = pack(color);
+
+        v[2 * i].position = origin;
+        v[2 * i].color = c;
+        v[2 * i + 1].position = glm::vec3(matrix * end);
+        v[2 * i + 1].color = c;
+    }
+}
+
+
+/*!
+ Creates the program and the vertex array
+ */
+bool GLDebugDraw::initProgram(void)
+{
+    if(_program.isValid()) return true;
+
+    GLuint program = CreateShaderProgram(debug_vs, debug_fs);
+    if(program == 0)
+    {
+        cerr << "[GLDebugDraw] - Cannot create the debug program." << endl;
+        return false;
+    }
+    _program.adopt(GLResource::PROGRAM, program, "GLDebugDraw");
+
+    _viewProjectionLocation = glGetUniformLocation(program, "view_projection");
+    _positionLocation = glGetAttribLocation(program, "in_Position");
+    _colorLocation = glGetAttribLocation(program, "in_Color");
+    glUseProgram(0);
+
+    // the pointers are set in flush(), the buffers of the two streams differ
+    _vao.create(GLResource::VERTEX_ARRAY, "GLDebugDraw");
+    glBindVertexArray(_vao.id());
+    glEnableVertexAttribArray(_positionLocation);
+    glEnableVertexAttribArray(_colorLocation);
+    glBindVertexArray(0);
+
+    return true;
+}
+
+
+/*!
+ Draws all lines of this frame and starts the next frame
+ */
+void GLDebugDraw::flush(const glm::mat4& view_projection)
+{
+    GL_PROFILE_ZONE("GLDebugDraw::flush");
+
+    _num_lines = 0;
+    for(int i=0; i<2; i++)
+    {
+        Stream& s = _streams[i];
+        if(s.data != NULL) s.buffer->unmap();
+        s.data = NULL;
+        _num_lines += s.lines;
+    }
+
+    if(_num_lines > 0 && initProgram())
+    {
+        GLboolean depth_test;
+        GLboolean depth_mask;
+        glGetBooleanv(GL_DEPTH_TEST, &depth_test);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+        glDepthMask(GL_FALSE);
+
+        glUseProgram(_program.id());
+        glUniformMatrix4fv(_viewProjectionLocation, 1, GL_FALSE, &view_projection[0][0]);
+        glBindVertexArray(_vao.id());
+
+        for(int i=0; i<2; i++)
+        {
+            Stream& s = _streams[i];
+            if(s.count == 0) continue;
+
+            glBindBuffer(GL_ARRAY_BUFFER, s.buffer->getID());
+            glVertexAttribPointer(_positionLocation, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), 0);
+            glVertexAttribPointer(_colorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), (const GLvoid*)sizeof(glm::vec3));
+
+            // the second stream is drawn on top of the scene
+            if(i == 1) glDisable(GL_DEPTH_TEST);
+            glDrawArrays(GL_LINES, s.first, s.count);
+            GLProfiler::Get().countDraw(0);
+            if(i == 1 && depth_test) glEnable(GL_DEPTH_TEST);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        glUseProgram(0);
+        glDepthMask(depth_mask);
+    }
+
+    // the fences go behind the draws of this frame
+    for(int i=0; i<2; i++)
+    {
+        Stream& s = _streams[i];
+        s.buffer->endFrame();
+        s.used = 0;
+        s.first = 0;
+        s.count = 0;
+        s.lines = 0;
+        s.full = false;
+    }
+}
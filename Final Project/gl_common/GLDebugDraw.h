@@ -0,0 +1,183 @@
+//
+//  GLDebugDraw.h
+//  HCI557_Simple_Texture
+//
+//  Lines for debugging, e.g. bounding boxes, collision shapes, or the view
+//  frustum of another camera. The shapes can be added anywhere in the frame
+//  and are drawn together at the end of the frame.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLResource.h"
+#include "GLStreamBuffer.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The shapes are written as line vertices directly into a GLStreamBuffer of the debug draw,
+ one buffer for the lines with depth test and one for the lines on top of the scene. The
+ buffers are filled in chunks; a chunk is mapped when the previous one is full, so the lines
+ of one frame are contiguous and flush() draws each buffer with one glDrawArrays() call.
+
+ A vertex is a position and a packed RGBA color, 16 bytes. The lines with depth test get
+ MAX_VERTICES vertices per frame, about 2700 boxes, the lines on top MAX_OVERLAY_VERTICES.
+ Shapes beyond this are dropped until the next flush().
+
+ The calls use GL with buffers that cannot be mapped persistently, call them from the
+ GL thread only. All calls return at once while the debug draw is disabled.
+ */
+class GLDebugDraw
+{
+public:
+
+    /*!
+     Returns the debug draw of this application
+     */
+    static GLDebugDraw& Get(void);
+
+
+    /*!
+     Enables or disables all calls, enabled by default
+     */
+    inline void setEnabled(bool enabled){_enabled = enabled;}
+    inline bool isEnabled(void){return _enabled;}
+
+
+    /*!
+     Adds a line
+     @param depth_test - false draws the line on top of the scene
+     */
+    void line(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color, bool depth_test = true);
+
+
+    /*!
+     Adds the 12 edges of an axis aligned box
+     */
+    void aabb(const glm::vec3& bmin, const glm::vec3& bmax, const glm::vec3& color, bool depth_test = true);
+
+
+    /*!
+     Adds three circles around the x, y, and z axis
+     */
+    void sphere(const glm::vec3& center, float radius, const glm::vec3& color, bool depth_test = true);
+
+
+    /*!
+     Adds the 12 edges of a view frustum
+     @param view_projection - the projection matrix * view matrix of the frustum
+     */
+    void frustum(const glm::mat4& view_projection, const glm::vec3& color, bool depth_test = true);
+
+
+    /*!
+     Adds the x, y, and z axis of a coordinate system in red, green, and blue
+     @param matrix - the location and orientation of the coordinate system
+     @param length - the length of the axes
+     */
+    void axis(const glm::mat4& matrix, float length, bool depth_test = true);
+
+
+    /*!
+     Draws all lines of this frame and starts the next frame. Call it once per frame,
+     after the scene.
+     @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+     */
+    void flush(const glm::mat4& view_projection);
+
+
+    /*!
+     Returns the number of lines of the last flush() call
+     */
+    inline int numLines(void){return _num_lines;}
+
+
+    /*!
+     Deletes the buffers and the program. Call this before the context is destroyed.
+     */
+    void release(void);
+
+
+    // the number of vertices per frame with and without depth test, and per mapped chunk
+    static const int MAX_VERTICES = 64 * 1024;
+    static const int MAX_OVERLAY_VERTICES = 8 * 1024;
+    static const int CHUNK_VERTICES = 4096;
+
+
+private:
+
+    GLDebugDraw();
+    ~GLDebugDraw();
+
+
+    typedef struct _DebugVertex
+    {
+        glm::vec3       position;
+        GLuint          color; // RGBA, 8 bits each
+    }DebugVertex;
+
+
+    // the lines of one buffer in this frame
+    typedef struct _Stream
+    {
+        GLStreamBuffer* buffer;
+        DebugVertex*    data;       // the mapped chunk, NULL if none is mapped
+        int             used;       // the vertices written to the chunk
+        GLint           first;      // the first vertex of this frame
+        int             count;      // the vertices of this frame, including padding
+        int             lines;      // the lines of this frame
+        bool            full;       // the buffer has no free chunk until the next frame
+    }Stream;
+
+
+    /*!
+     Returns room for count vertices, maps the next chunk if needed
+     @return NULL if the frame is full
+     */
+    DebugVertex* reserve(bool depth_test, int count);
+
+
+    /*!
+     Adds the 12 edges of a box from its corners, bit 0 of the index is x, bit 1 y, bit 2 z
+     */
+    void box(const glm::vec3 corners[8], const glm::vec3& color, bool depth_test);
+
+
+    /*!
+     Creates the program and the vertex array
+     */
+    bool initProgram(void);
+
+
+    /*!
+     Packs a color with components from 0 to 1
+     */
+    static GLuint pack(const glm::vec3& color);
+
+
+    Stream                  _streams[2]; // with and without depth test
+
+    bool                    _enabled;
+    int                     _num_lines;
+
+    GLResource              _program;
+    int                     _viewProjectionLocation;
+    int                     _positionLocation;
+    int                     _colorLocation;
+    GLResource              _vao;
+};
@@ -0,0 +1,258 @@
+//
+//  GLDebugOverlay.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLDebugOverlay.h"
+#include "Shaders.h"
+#include "GLProfiler.h"
+
+
+// World space position, normal vector, and texture coordinate of every vertex. The per-draw
+// matrix of batches and instanced meshes is multiplied like in their own vertex shaders.
+static const string overlay_vs =
+"#version 330 core                                                  \n"
+"uniform mat4 model;                                                \n"
+"uniform bool has_normal;                                           \n"
+"uniform bool has_texcoord;                                         \n"
+"uniform bool has_object_matrix;                                    \n"
+"in vec3 in_Position;                                               \n"
+"in vec3 in_Normal;                                                 \n"
+"in vec2 in_TexCoord;                                               \n"
+"in mat4 in_ObjectMatrix;                                           \n"
+"out vec3 pass_Position;                                            \n"
+"out vec3 pass_Normal;                                              \n"
+"out vec2 pass_TexCoord;                                            \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    mat4 m = has_object_matrix ? model * in_ObjectMatrix : model;  \n"
+"    pass_Position = (m * vec4(in_Position, 1.0)).xyz;              \n"
+"    pass_Normal = has_normal ? transpose(inverse(mat3(m))) * in_Normal : vec3(0.0); \n"
+"    pass_TexCoord = has_texcoord ? in_TexCoord : vec2(0.0);        \n"
+"    gl_Position = vec4(pass_Position, 1.0);                        \n"
+"}                                                                  \n";
+
+// One triangle in, up to 4 wireframe vertices and 2 x 3 x 2 vertices for the normals
+// and tangents out. The tangent follows the u direction of the texture coordinates.
+static const string overlay_gs =
+"#version 330 core                                                  \n"
+"layout(triangles) in;                                              \n"
+"layout(line_strip, max_vertices = 16) out;                         \n"
+"uniform mat4 view_projection;                                      \n"
+"uniform float line_length;                                         \n"
+"uniform int modes;                                                 \n"
+"uniform bool has_normal;                                           \n"
+"uniform bool has_texcoord;                                         \n"
+"in vec3 pass_Position[];                                           \n"
+"in vec3 pass_Normal[];                                             \n"
+"in vec2 pass_TexCoord[];                                           \n"
+"out vec3 pass_Color;                                               \n"
+"void emit(vec3 p, vec3 color)                                      \n"
+"{                                                                  \n"
+"    vec4 q = view_projection * vec4(p, 1.0);                       \n"
+"    q.z -= 0.0001 * q.w; // in front of the surface                \n"
+"    gl_Position = q;                                               \n"
+"    pass_Color = color;                                            \n"
+"    EmitVertex();                                                  \n"
+"}                                                                  \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    vec3 e1 = pass_Position[1] - pass_Position[0];                 \n"
+"    vec3 e2 = pass_Position[2] - pass_Position[0];                 \n"
+"    vec3 face = cross(e1, e2);                                     \n"
+"    if(dot(face, face) < 1e-12) return;                            \n"
+"    face = normalize(face);                                        \n"
+"    if((modes & 4) != 0)                                           \n"
+"    {                                                              \n"
+"        for(int i=0; i<4; i++) emit(pass_Position[i % 3], vec3(1.0, 1.0, 0.0)); \n"
+"        EndPrimitive();                                            \n"
+"    }                                                              \n"
+"    vec3 tangent = e1;                                             \n"
+"    if(has_texcoord)                                               \n"
+"    {                                                              \n"
+"        vec2 d1 = pass_TexCoord[1] - pass_TexCoord[0];             \n"
+"        vec2 d2 = pass_TexCoord[2] - pass_TexCoord[0];             \n"
+"        float det = d1.x * d2.y - d2.x * d1.y;                     \n"
+"        if(abs(det) > 1e-12) tangent = (e1 * d2.y - e2 * d1.y) / det; \n"
+"    }                                                              \n"
+"    for(int i=0; i<3; i++)                                         \n"
+"    {                                                              \n"
+"        vec3 p = pass_Position[i];                                 \n"
+"        vec3 n = face;                                             \n"
+"        if(has_normal && dot(pass_Normal[i], pass_Normal[i]) > 1e-12) n = normalize(pass_Normal[i]); \n"
+"        if((modes & 1) != 0)                                       \n"
+"        {                                                          \n"
+"            emit(p, vec3(0.0, 0.0, 1.0));                          \n"
+"            emit(p + n * line_length, vec3(0.0, 0.0, 1.0));        \n"
+"            EndPrimitive();                                        \n"
+"        }                                                          \n"
+"        vec3 t = tangent - n * dot(n, tangent);                    \n"
+"        if((modes & 2) != 0 && dot(t, t) > 1e-12)                  \n"
+"        {                                                          \n"
+"            emit(p, vec3(1.0, 0.0, 0.0));                          \n"
+"            emit(p + normalize(t) * line_length, vec3(1.0, 0.0, 0.0)); \n"
+"            EndPrimitive();                                        \n"
+"        }                                                          \n"
+"    }                                                              \n"
+"}                                                                  \n";
+
+static const string overlay_fs =
+"#version 330 core                                                  \n"
+"in vec3 pass_Color;                                                \n"
+"out vec4 color;                                                    \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    color = vec4(pass_Color, 1.0);                                 \n"
+"}                                                                  \n";
+
+
+
+/*!
+ Returns the overlay, the programs are created on the first draw
+ */
+//static
+GLDebugOverlay& GLDebugOverlay::Get(void)
+{
+    static GLDebugOverlay overlay;
+    return overlay;
+}
+
+
+GLDebugOverlay::GLDebugOverlay()
+{
+    _modes = NONE;
+    _length = 1.0f;
+}
+
+
+GLDebugOverlay::~GLDebugOverlay()
+{
+    // the programs go with the context, it is gone when static objects are destroyed
+}
+
+
+/*!
+ Switches to the next combination of modes
+ */
+int GLDebugOverlay::nextModes(void)
+{
+    switch(_modes)
+    {
+        case NONE: _modes = NORMALS; break;
+        case NORMALS: _modes = TANGENTS; break;
+        case TANGENTS: _modes = WIREFRAME; break;
+        case WIREFRAME: _modes = ALL; break;
+        default: _modes = NONE; break;
+    }
+    return _modes;
+}
+
+
+/*!
+ Returns the overlay program for an object program, links it on the first call
+ */
+GLDebugOverlay::Program* GLDebugOverlay::getProgram(GLuint object_program)
+{
+    map<GLuint, Program>::iterator itr = _programs.find(object_program);
+    if(itr != _programs.end())
+    {
+        return itr->second.program != 0 ? &itr->second : NULL;
+    }
+
+    Program& p = _programs[object_program];
+    p.program = 0;
+    if(object_program == 0) return NULL;
+
+    GLint position = glGetAttribLocation(object_program, "in_Position");
+    GLint normal = glGetAttribLocation(object_program, "in_Normal");
+    GLint texcoord = glGetAttribLocation(object_program, "in_TexCoord");
+    GLint matrix = glGetAttribLocation(object_program, "in_DrawMatrix");
+    if(matrix == -1) matrix = glGetAttribLocation(object_program, "in_InstanceMatrix");
+
+    if(position == -1)
+    {
+        cerr << "[GLDebugOverlay] - The shader program " << object_program << " has no in_Position attribute." << endl;
+        return NULL;
+    }
+
+    GLuint program = CreateShaderProgram(overlay_vs, overlay_gs, overlay_fs);
+
+    // the overlay reads the vertex array of the object, so its attributes need the same locations
+    glBindAttribLocation(program, position, "in_Position");
+    if(normal != -1) glBindAttribLocation(program, normal, "in_Normal");
+    if(texcoord != -1) glBindAttribLocation(program, texcoord, "in_TexCoord");
+    if(matrix != -1) glBindAttribLocation(program, matrix, "in_ObjectMatrix");
+    glLinkProgram(program);
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(!linked)
+    {
+        cerr << "[GLDebugOverlay] - Cannot link the overlay for the shader program " << object_program << "." << endl;
+        glDeleteProgram(program);
+        glUseProgram(0);
+        return NULL;
+    }
+
+    p.program = program;
+    p.modelMatrixLocation = glGetUniformLocation(program, "model");
+    p.viewProjectionLocation = glGetUniformLocation(program, "view_projection");
+    p.lengthLocation = glGetUniformLocation(program, "line_length");
+    p.modesLocation = glGetUniformLocation(program, "modes");
+    p.hasNormalLocation = glGetUniformLocation(program, "has_normal");
+    p.hasTexCoordLocation = glGetUniformLocation(program, "has_texcoord");
+    p.hasObjectMatrixLocation = glGetUniformLocation(program, "has_object_matrix");
+    p.has_normal = normal != -1;
+    p.has_texcoord = texcoord != -1;
+    p.has_object_matrix = matrix != -1;
+
+    glUseProgram(0);
+    return &p;
+}
+
+
+/*!
+ Draws the overlay of one object
+ */
+void GLDebugOverlay::draw(GLObject* object, const glm::mat4& view_projection, int modes)
+{
+    if(object == NULL || (modes & ALL) == NONE) return;
+
+    Program* p = getProgram(object->getProgram());
+    if(p == NULL) return;
+
+    GL_PROFILE_ZONE("GLDebugOverlay::draw");
+
+    // the lines are tested against the scene but do not hide each other
+    GLboolean depth_mask;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+    glDepthMask(GL_FALSE);
+
+    glUseProgram(p->program);
+    glUniformMatrix4fv(p->modelMatrixLocation, 1, GL_FALSE, &object->getMatrix()[0][0]);
+    glUniformMatrix4fv(p->viewProjectionLocation, 1, GL_FALSE, &view_projection[0][0]);
+    glUniform1f(p->lengthLocation, _length);
+    glUniform1i(p->modesLocation, modes & ALL);
+    glUniform1i(p->hasNormalLocation, p->has_normal);
+    glUniform1i(p->hasTexCoordLocation, p->has_texcoord);
+    glUniform1i(p->hasObjectMatrixLocation, p->has_object_matrix);
+
+    object->drawVertexArray();
+
+    glUseProgram(0);
+    glDepthMask(depth_mask);
+}
+
+
+/*!
+ Draws the overlay of all visible objects of the culler
+ */
+void GLDebugOverlay::draw(GLFrustumCuller& culler, const glm::mat4& view_projection)
+{
+    if(_modes == NONE) return;
+
+    for(int i=0; i<culler.size(); i++)
+    {
+        if(culler.isVisible(i)) draw(culler.getObject(i), view_projection, _modes);
+    }
+}
@@ -0,0 +1,139 @@
+//
+//  GLDebugOverlay.h
+//  HCI557_Simple_Texture
+//
+//  Draws the normal vectors, tangents, and the wireframe of an object with a
+//  geometry shader. The overlay reads the vertex array of the object, it needs
+//  no buffers of its own and no copy of the vertices in memory.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <map>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLFrustumCuller.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The overlay draws an object again with a program of its own: the vertex shader reads the
+ attributes in_Position, in_Normal, in_TexCoord, and the per-draw matrix in_DrawMatrix or
+ in_InstanceMatrix at the locations of the object program. The geometry shader turns every
+ triangle into lines: the three edges, one line along the normal vector and one along the
+ tangent at every corner. Objects without in_Normal show the face normal, objects without
+ in_TexCoord a tangent along the first edge of the triangle.
+
+ An overlay program is linked once per object program. The object draws itself with
+ GLObject::drawVertexArray(), objects that return false are not shown.
+
+ The lines are drawn with a small depth bias and without depth writes, the depth test
+ of the scene hides the lines behind other objects.
+ */
+class GLDebugOverlay
+{
+public:
+
+    typedef enum
+    {
+        NONE = 0,
+        NORMALS = 1,    // blue lines along the vertex normal vectors
+        TANGENTS = 2,   // red lines along the tangents
+        WIREFRAME = 4,  // yellow triangle edges
+        ALL = 7
+    }Mode;
+
+
+    /*!
+     Returns the overlay, the programs are created on the first draw
+     */
+    static GLDebugOverlay& Get(void);
+
+
+    /*!
+     The modes for draw(GLFrustumCuller&, ...), a combination of Mode bits
+     */
+    inline void setModes(int modes){_modes = modes & ALL;}
+    inline int getModes(void){return _modes;}
+
+
+    /*!
+     Switches to the next combination of modes: none, normals, tangents, wireframe,
+     all modes, and none again
+     @return the new modes
+     */
+    int nextModes(void);
+
+
+    /*!
+     The length of the normal and tangent lines in world units
+     */
+    inline void setLength(float length){_length = length;}
+    inline float getLength(void){return _length;}
+
+
+    /*!
+     Draws the overlay of one object
+     @param object - the object, its model matrix and program are used
+     @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+     @param modes - a combination of Mode bits
+     */
+    void draw(GLObject* object, const glm::mat4& view_projection, int modes);
+
+
+    /*!
+     Draws the overlay of all visible objects of the culler with the modes of setModes()
+     */
+    void draw(GLFrustumCuller& culler, const glm::mat4& view_projection);
+
+
+private:
+
+    GLDebugOverlay();
+    ~GLDebugOverlay();
+
+
+    // an overlay program with the attribute locations of one object program
+    typedef struct _Program
+    {
+        GLuint  program;
+        int     modelMatrixLocation;
+        int     viewProjectionLocation;
+        int     lengthLocation;
+        int     modesLocation;
+        int     hasNormalLocation;
+        int     hasTexCoordLocation;
+        int     hasObjectMatrixLocation;
+
+        bool    has_normal;
+        bool    has_texcoord;
+        bool    has_object_matrix;
+    }Program;
+
+
+    /*!
+     Returns the overlay program for an object program, links it on the first call
+     @return NULL if the object program has no in_Position or linking fails
+     */
+    Program* getProgram(GLuint object_program);
+
+
+    map<GLuint, Program>    _programs; // by object program, a program of 0 marks a failed link
+
+    int                     _modes;
+    float                   _length;
+};
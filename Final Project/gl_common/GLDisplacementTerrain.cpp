@@ -0,0 +1,239 @@
+//
+//  GLDisplacementTerrain.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLDisplacementTerrain.h"
+#include "GLProfiler.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+
+
+GLDisplacementTerrain::GLDisplacementTerrain(string height_map, float size, float height, int grid, int tiles):
+    _file(height_map), _size(size), _height(height)
+{
+    // the indices are 16 bit
+    _grid = std::max(1, std::min(grid, 254));
+    _tiles = std::max(1, tiles);
+    _texture_repeat = 16.0f;
+
+    _program = 0;
+    _heightMapLocation = -1;
+    _sizeLocation = -1;
+    _heightLocation = -1;
+    _tilesLocation = -1;
+    _repeatLocation = -1;
+    _num_indices = 0;
+}
+
+
+GLDisplacementTerrain::~GLDisplacementTerrain()
+{
+    // the program belongs to the appearance, the handles delete the buffers and the height map
+}
+
+
+/*!
+ Init the geometry object
+ */
+void GLDisplacementTerrain::init(void)
+{
+    initShader();
+    initVBO();
+    loadHeightMap();
+
+    // the bounds of the highest terrain, the height map is not known to the culler
+    float corners[6] = { -_size / 2.0f, 0.0f, -_size / 2.0f, _size / 2.0f, _height, _size / 2.0f };
+    computeBounds(corners, 2, 3);
+}
+
+
+/*!
+ Set the number of color texture repeats across the terrain
+ */
+void GLDisplacementTerrain::setTextureRepeat(float repeat)
+{
+    _texture_repeat = repeat;
+
+    if(_program == 0) return;
+    glUseProgram(_program);
+    glUniform1f(_repeatLocation, _texture_repeat);
+    glUseProgram(0);
+}
+
+
+/*
+ Inits the shader program for this object
+ */
+void GLDisplacementTerrain::initShader(void)
+{
+    if(!_apperance.exists())return;
+
+    // This loads the shader program from a file
+    _program = _apperance.getProgram();
+
+    glUseProgram(_program);
+
+    _heightMapLocation = glGetUniformLocation(_program, "height_map");
+    _sizeLocation = glGetUniformLocation(_program, "terrain_size");
+    _heightLocation = glGetUniformLocation(_program, "terrain_height");
+    _tilesLocation = glGetUniformLocation(_program, "terrain_tiles");
+    _repeatLocation = glGetUniformLocation(_program, "texture_repeat");
+
+    if(_heightMapLocation == -1)
+    {
+        cerr << "[GLDisplacementTerrain] - The program has no height_map, use displacement_terrain.vs." << endl;
+    }
+
+    // the color texture of the appearance uses texture unit 0
+    glUniform1i(_heightMapLocation, 1);
+    glUniform1f(_sizeLocation, _size);
+    glUniform1f(_heightLocation, _height);
+    glUniform1i(_tilesLocation, _tiles);
+    glUniform1f(_repeatLocation, _texture_repeat);
+
+    addModelViewMatrixToProgram(_program);
+
+    glUseProgram(0);
+}
+
+
+/*!
+ Create the vertex buffer object for this element
+ */
+void GLDisplacementTerrain::initVBO(void)
+{
+    GL_PROFILE_ZONE("GLDisplacementTerrain::initVBO");
+
+    const int row = _grid + 1;
+
+    // the grid lies in the x-z plane, the height comes from the shader
+    vector<GLfloat> points(row * row * 3);
+    for(int z=0; z<row; z++)
+    {
+        for(int x=0; x<row; x++)
+        {
+            GLfloat* p = &points[(z * row + x) * 3];
+            p[0] = (float)x / _grid;
+            p[1] = 0.0f;
+            p[2] = (float)z / _grid;
+        }
+    }
+
+    vector<GLushort> indices;
+    indices.reserve(_grid * _grid * 6);
+    for(int z=0; z<_grid; z++)
+    {
+        for(int x=0; x<_grid; x++)
+        {
+            GLushort a = z * row + x;
+            GLushort b = a + 1;
+            GLushort c = a + row;
+            GLushort d = c + 1;
+
+            indices.push_back(a); indices.push_back(c); indices.push_back(b);
+            indices.push_back(b); indices.push_back(c); indices.push_back(d);
+        }
+    }
+    _num_indices = (int)indices.size();
+
+    _vao.create(GLResource::VERTEX_ARRAY, "GLDisplacementTerrain"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
+
+    _vbo[0].create(GLResource::BUFFER, "GLDisplacementTerrain");
+    _vbo[1].create(GLResource::BUFFER, "GLDisplacementTerrain");
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // vertices
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id());
+    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GLfloat), &points[0], GL_STATIC_DRAW);
+    _vbo[0].setSize(points.size() * sizeof(GLfloat));
+
+    int locPos = glGetAttribLocation(_program, "in_Position");
+    glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(locPos);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // indices
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo[1].id());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _num_indices * sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+    _vbo[1].setSize(_num_indices * sizeof(GLushort));
+
+    glBindVertexArray(0); // Disable our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+/*!
+ Loads the height map into a single channel texture
+ */
+bool GLDisplacementTerrain::loadHeightMap(void)
+{
+    unsigned int channels;
+    unsigned int width;
+    unsigned int height;
+
+    unsigned char* data = loadBitmapFile(_file, channels, width, height);
+    if(data == NULL)
+    {
+        cerr << "[GLDisplacementTerrain] - Cannot read the height map " << _file << "." << endl;
+        return false;
+    }
+
+    // the first channel, the maps are gray
+    vector<unsigned char> heights(width * height);
+    for(unsigned int i=0; i<width * height; i++) heights[i] = data[i * channels];
+    free(data);
+
+    _height_texture.create(GLResource::TEXTURE, _file);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _height_texture.id());
+
+    // no mipmaps, the vertex shader reads level 0
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, &heights[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    _height_texture.setSize(width * height);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    return true;
+}
+
+
+/*!
+ Draw the objects
+ */
+bool GLDisplacementTerrain::drawGeometry(void)
+{
+    GL_PROFILE_ZONE("GLDisplacementTerrain::drawGeometry");
+
+    glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
+
+    // unit 1 stays bound, a GLMultiTexture binds all its units again when it is used
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _height_texture.id());
+    glActiveTexture(GL_TEXTURE0);
+
+    // Bind the buffer and switch it to an active buffer
+    glBindVertexArray(_vao.id());
+
+    // one instance per tile
+    glDrawElementsInstanced(GL_TRIANGLES, _num_indices, GL_UNSIGNED_SHORT, 0, _tiles * _tiles);
+    GLProfiler::Get().countDraw(_num_indices / 3, _tiles * _tiles);
+
+    // Unbind our Vertex Array Object
+    glBindVertexArray(0);
+
+    return true;
+}
@@ -0,0 +1,131 @@
+//
+//  GLDisplacementTerrain.h
+//  HCI557_Simple_Texture
+//
+//  A terrain from a height map texture. One small grid is drawn once per
+//  tile and the vertex shader moves every vertex up by the height map,
+//  see ../data/shaders/displacement_terrain.vs.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The terrain covers [-size/2, size/2] in x and z of the model matrix, a white pixel
+ of the height map is height units high. The first channel of the bmp is the height,
+ it is stored as a single channel texture on texture unit 1.
+
+ The geometry is one grid of grid x grid quads in [0, 1] x [0, 1]. It is drawn with
+ one instanced draw call, tiles x tiles instances, and the vertex shader places every
+ instance on its tile. The fragment shader computes the normal vectors from the
+ gradient of the height map, so the lighting has the resolution of the map, not of the grid.
+
+ The appearance needs the program ../data/shaders/displacement_terrain.vs/.fs and a
+ GLTexture for the color.
+ */
+class GLDisplacementTerrain : public GLObject
+{
+public:
+
+    /*!
+     @param height_map - the bmp file of the height map
+     @param size - the edge length of the terrain
+     @param height - the height of a white pixel
+     @param grid - the number of quads along the edge of the shared grid
+     @param tiles - the number of grid copies along the edge of the terrain
+     */
+    GLDisplacementTerrain(string height_map, float size, float height, int grid = 64, int tiles = 4);
+    ~GLDisplacementTerrain();
+
+
+    /*!
+     Init the geometry object
+     */
+    void init(void);
+
+
+    /*!
+     Draw the objects with the bound program and textures
+     See GLObject::drawGeometry()
+     */
+    virtual bool drawGeometry(void);
+
+
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
+
+
+    /*!
+     Set the number of color texture repeats across the terrain, default 16
+     */
+    void setTextureRepeat(float repeat);
+
+
+    /*!
+     Returns the number of triangles of one draw
+     */
+    inline int numTriangles(void){return _num_indices / 3 * _tiles * _tiles;}
+
+
+private:
+
+    /*!
+     Create the vertex buffer object for this element
+     */
+    virtual void initVBO(void);
+
+    /*
+     Inits the shader program for this object
+     */
+    virtual void initShader(void);
+
+
+    /*!
+     Loads the height map into a single channel texture
+     */
+    bool loadHeightMap(void);
+
+
+    string                  _file;
+    float                   _size;
+    float                   _height;
+    int                     _grid;
+    int                     _tiles;
+    float                   _texture_repeat;
+
+    // the program
+    GLuint                  _program;
+
+    int                     _heightMapLocation;
+    int                     _sizeLocation;
+    int                     _heightLocation;
+    int                     _tilesLocation;
+    int                     _repeatLocation;
+
+    GLResource              _height_texture;
+
+    GLResource              _vao; // Our Vertex Array Object
+    GLResource              _vbo[2]; // the grid positions and the indices
+    int                     _num_indices;
+};
@@ -0,0 +1,292 @@
+//
+//  GLDynamicResolution.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLDynamicResolution.h"
+#include "Shaders.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+// A full-screen triangle, the positions come from gl_VertexID
+static const string upscale_vs =
+"#version 330 core                                                  \n"
+"out vec2 pass_TexCoord;                                            \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2)); \n"
+"    pass_TexCoord = p;                                             \n"
+"    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);                   \n"
+"}                                                                  \n";
+
+// Bilinear upscale of the rendered part of the texture. The sharpen filter adds
+// the difference to the four neighbours, an unsharp mask with a cross kernel.
+// The coordinates are clamped, so no texel outside the rendered part is read.
+static const string upscale_fs =
+"#version 330 core                                                  \n"
+"uniform sampler2D scene_texture;                                   \n"
+"uniform vec2 uv_scale;                                             \n"
+"uniform vec2 texel_size;                                           \n"
+"uniform float sharpness;                                           \n"
+"in vec2 pass_TexCoord;                                             \n"
+"out vec4 color;                                                    \n"
+"vec3 fetch(vec2 uv)                                                \n"
+"{                                                                  \n"
+"    uv = clamp(uv, texel_size * 0.5, uv_scale - texel_size * 0.5); \n"
+"    return texture(scene_texture, uv).rgb;                         \n"
+"}                                                                  \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    vec2 uv = pass_TexCoord * uv_scale;                            \n"
+"    vec3 c = fetch(uv);                                            \n"
+"    if(sharpness > 0.0)                                            \n"
+"    {                                                              \n"
+"        vec3 n = fetch(uv + vec2(texel_size.x, 0.0)) + fetch(uv - vec2(texel_size.x, 0.0)) + \n"
+"                 fetch(uv + vec2(0.0, texel_size.y)) + fetch(uv - vec2(0.0, texel_size.y));  \n"
+"        c = clamp(c + sharpness * (c - n * 0.25), 0.0, 1.0);       \n"
+"    }                                                              \n"
+"    color = vec4(c, 1.0);                                          \n"
+"}                                                                  \n";
+
+
+
+GLDynamicResolution::GLDynamicResolution()
+{
+    _target_fbo = 0;
+    for(int i=0; i<4; i++) _target_viewport[i] = 0;
+    _target_blend = GL_FALSE;
+    _target_depth_test = GL_FALSE;
+
+    for(int i=0; i<NUM_QUERIES; i++) _pending[i] = false;
+    _query_index = 0;
+    _query_active = false;
+
+    _textureLocation = -1;
+    _uvScaleLocation = -1;
+    _texelSizeLocation = -1;
+    _sharpnessLocation = -1;
+
+    _target_ms = 16.0;
+    _scale = 1.0f;
+    _min_scale = 0.5f;
+    _max_scale = 1.0f;
+    _sharpness = 0.25f;
+    _interval = 8;
+    _frame = 0;
+    _sum_ms = 0.0;
+    _num_samples = 0;
+    _last_ms = 0.0;
+    _num_changes = 0;
+}
+
+
+GLDynamicResolution::~GLDynamicResolution()
+{
+}
+
+
+/*!
+ Create the framebuffer, the queries and the upscale program
+ */
+bool GLDynamicResolution::init(int width, int height, double target_ms)
+{
+    _target_ms = target_ms;
+
+    if(!_framebuffer.init(width, height))
+    {
+        cerr << "[GLDynamicResolution] - Cannot create the framebuffer." << endl;
+        return false;
+    }
+
+    GLuint program = CreateShaderProgram(upscale_vs, upscale_fs);
+    if(program == 0)
+    {
+        cerr << "[GLDynamicResolution] - Cannot create the upscale program." << endl;
+        return false;
+    }
+    _program.adopt(GLResource::PROGRAM, program, "GLDynamicResolution");
+
+    glUseProgram(program);
+    _textureLocation = glGetUniformLocation(program, "scene_texture");
+    _uvScaleLocation = glGetUniformLocation(program, "uv_scale");
+    _texelSizeLocation = glGetUniformLocation(program, "texel_size");
+    _sharpnessLocation = glGetUniformLocation(program, "sharpness");
+    glUniform1i(_textureLocation, 0);
+    glUseProgram(0);
+
+    // core profiles need a bound vertex array for every draw
+    _vao.create(GLResource::VERTEX_ARRAY, "GLDynamicResolution");
+
+    for(int i=0; i<NUM_QUERIES; i++)
+    {
+        _queries[i][0].create(GLResource::QUERY, "GLDynamicResolution");
+        _queries[i][1].create(GLResource::QUERY, "GLDynamicResolution");
+    }
+
+    return true;
+}
+
+
+/*!
+ Set the limits of the scale
+ */
+void GLDynamicResolution::setScaleRange(float min_scale, float max_scale)
+{
+    _min_scale = std::max(0.1f, std::min(min_scale, 1.0f));
+    _max_scale = std::max(_min_scale, std::min(max_scale, 1.0f));
+    _scale = std::max(_min_scale, std::min(_scale, _max_scale));
+}
+
+
+/*!
+ Returns the scaled size of the output
+ */
+void GLDynamicResolution::getScaledSize(int& width, int& height)
+{
+    width = std::max(1, (int)(_framebuffer.getWidth() * _scale + 0.5f));
+    height = std::max(1, (int)(_framebuffer.getHeight() * _scale + 0.5f));
+}
+
+
+/*!
+ Binds the framebuffer and sets the viewport to the scaled size
+ */
+void GLDynamicResolution::begin(void)
+{
+    GL_PROFILE_ZONE("GLDynamicResolution::begin");
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_target_fbo);
+    glGetIntegerv(GL_VIEWPORT, _target_viewport);
+    _target_blend = glIsEnabled(GL_BLEND);
+    _target_depth_test = glIsEnabled(GL_DEPTH_TEST);
+
+    if(!isValid()) return;
+
+    // follow the size of the target
+    if(_target_viewport[2] != _framebuffer.getWidth() || _target_viewport[3] != _framebuffer.getHeight())
+    {
+        _framebuffer.resize(_target_viewport[2], _target_viewport[3]);
+    }
+
+    readQueries();
+
+    // all queries still in flight, this frame is not measured
+    _query_active = !_pending[_query_index];
+    if(_query_active) glQueryCounter(_queries[_query_index][0].id(), GL_TIMESTAMP);
+
+    int width, height;
+    getScaledSize(width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer.getID());
+    glViewport(0, 0, width, height);
+}
+
+
+/*!
+ Scales the image up into the target framebuffer and updates the scale
+ */
+void GLDynamicResolution::end(void)
+{
+    GL_PROFILE_ZONE("GLDynamicResolution::end");
+
+    if(!isValid()) return;
+
+    if(_query_active)
+    {
+        glQueryCounter(_queries[_query_index][1].id(), GL_TIMESTAMP);
+        _pending[_query_index] = true;
+        _query_index = (_query_index + 1) % NUM_QUERIES;
+        _query_active = false;
+    }
+
+    int width, height;
+    getScaledSize(width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _target_fbo);
+    glViewport(_target_viewport[0], _target_viewport[1], _target_viewport[2], _target_viewport[3]);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glUseProgram(_program.id());
+    glUniform2f(_uvScaleLocation, (float)width / _framebuffer.getWidth(), (float)height / _framebuffer.getHeight());
+    glUniform2f(_texelSizeLocation, 1.0f / _framebuffer.getWidth(), 1.0f / _framebuffer.getHeight());
+    glUniform1f(_sharpnessLocation, _scale < 1.0f ? _sharpness : 0.0f);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _framebuffer.getColorTexture());
+
+    glBindVertexArray(_vao.id());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    // the state of begin()
+    if(_target_blend) glEnable(GL_BLEND);
+    if(_target_depth_test) glEnable(GL_DEPTH_TEST);
+
+    _frame++;
+    if(_frame % _interval == 0) updateScale();
+}
+
+
+/*!
+ Reads the finished queries without waiting
+ */
+void GLDynamicResolution::readQueries(void)
+{
+    // oldest first, the slot of this frame is the oldest
+    for(int i=0; i<NUM_QUERIES; i++)
+    {
+        int index = (_query_index + i) % NUM_QUERIES;
+        if(!_pending[index]) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(_queries[index][1].id(), GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) break;
+
+        GLuint64 start = 0, stop = 0;
+        glGetQueryObjectui64v(_queries[index][0].id(), GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(_queries[index][1].id(), GL_QUERY_RESULT, &stop);
+        _pending[index] = false;
+
+        _last_ms = (double)(stop - start) / 1000000.0;
+        _sum_ms += _last_ms;
+        _num_samples++;
+    }
+}
+
+
+/*!
+ Sets a new scale from the average GPU time of the interval
+ */
+void GLDynamicResolution::updateScale(void)
+{
+    if(_num_samples == 0) return;
+
+    double average = _sum_ms / _num_samples;
+    _sum_ms = 0.0;
+    _num_samples = 0;
+    if(average <= 0.0) return;
+
+    // shrink when the target is missed, grow only with 15% headroom
+    if(average <= _target_ms && average >= _target_ms * 0.85) return;
+
+    float scale = _scale * (float)sqrt(_target_ms / average);
+
+    // limited steps in multiples of 0.05, so small changes of the time do not resize the image
+    scale = std::max(_scale - 0.1f, std::min(scale, _scale + 0.1f));
+    scale = floor(scale * 20.0f + 0.5f) / 20.0f;
+    scale = std::max(_min_scale, std::min(scale, _max_scale));
+
+    if(scale != _scale)
+    {
+        _scale = scale;
+        _num_changes++;
+    }
+}
@@ -0,0 +1,174 @@
+//
+//  GLDynamicResolution.h
+//  HCI557_Simple_Texture
+//
+//  Renders the scene with a variable resolution. The render scale follows the
+//  measured GPU time of the scene, so the frame time stays near a target, and
+//  the image is scaled up to the output size with an optional sharpen filter.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+
+// GLEW include
+#include <GL/glew.h>
+
+// locals
+#include "GLFramebuffer.h"
+#include "GLResource.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The scene is drawn into the lower left part of a framebuffer with the output size,
+ scale * width by scale * height pixels. A new scale only changes the viewport,
+ the framebuffer is never reallocated.
+
+ begin() and end() place two GL_TIMESTAMP queries around the scene. The results are
+ read without waiting, NUM_QUERIES - 1 frames later. Every getInterval() frames the
+ average GPU time sets a new scale. The GPU time is roughly proportional to the
+ number of pixels, so the scale changes with sqrt(target / time). The step is
+ limited and the scale only grows again with some headroom, against oscillation.
+
+ Timestamps do not conflict with the GL_TIME_ELAPSED queries of GLProfiler, so
+ GL_PROFILE_GPU_ZONE can be used inside begin() and end().
+ */
+class GLDynamicResolution
+{
+public:
+
+    GLDynamicResolution();
+    ~GLDynamicResolution();
+
+
+    /*!
+     Create the framebuffer, the queries and the upscale program
+     @param width, height - the output size, it follows the viewport of the target in begin()
+     @param target_ms - the GPU time of the scene to hold, in milliseconds
+     @return true if the object can be used
+     */
+    bool init(int width, int height, double target_ms);
+
+
+    /*!
+     Binds the framebuffer and sets the viewport to the scaled size.
+     The current framebuffer and viewport are the target of end(), the blend and
+     depth test state is restored by end().
+     */
+    void begin(void);
+
+
+    /*!
+     Scales the image up into the target framebuffer and updates the scale
+     */
+    void end(void);
+
+
+    /*!
+     Set the limits of the scale, default 0.5 to 1.0
+     */
+    void setScaleRange(float min_scale, float max_scale);
+
+
+    /*!
+     Set the sharpen amount of the upscale, 0.0 is a plain bilinear filter, default 0.25
+     */
+    inline void setSharpness(float sharpness){_sharpness = sharpness;}
+
+
+    /*!
+     Set the number of frames between two scale changes, default 8
+     */
+    inline void setInterval(int frames){_interval = frames < 1 ? 1 : frames;}
+    inline int getInterval(void){return _interval;}
+
+
+    inline void setTargetTime(double target_ms){_target_ms = target_ms;}
+    inline double getTargetTime(void){return _target_ms;}
+
+
+    /*!
+     Returns the current scale
+     */
+    inline float getScale(void){return _scale;}
+
+
+    /*!
+     Returns the last measured GPU time of the scene in milliseconds, 0 before the first result
+     */
+    inline double getGPUTime(void){return _last_ms;}
+
+
+    /*!
+     Returns the number of scale changes since the start
+     */
+    inline int numChanges(void){return _num_changes;}
+
+
+    inline bool isValid(void){return _program.isValid();}
+
+
+    // the number of frames the queries can be behind
+    static const int NUM_QUERIES = 3;
+
+
+private:
+
+    /*!
+     Reads the finished queries without waiting
+     */
+    void readQueries(void);
+
+
+    /*!
+     Sets a new scale from the average GPU time of the interval
+     */
+    void updateScale(void);
+
+
+    /*!
+     Returns the scaled size of the output
+     */
+    void getScaledSize(int& width, int& height);
+
+
+    GLFramebuffer   _framebuffer;
+
+    // the target of the upscale
+    GLint           _target_fbo;
+    GLint           _target_viewport[4];
+    GLboolean       _target_blend;
+    GLboolean       _target_depth_test;
+
+    // a begin and an end timestamp per frame
+    GLResource      _queries[NUM_QUERIES][2];
+    bool            _pending[NUM_QUERIES];
+    int             _query_index;
+    bool            _query_active;
+
+    // the upscale program
+    GLResource      _program;
+    GLResource      _vao;
+    int             _textureLocation;
+    int             _uvScaleLocation;
+    int             _texelSizeLocation;
+    int             _sharpnessLocation;
+
+    // the controller
+    double          _target_ms;
+    float           _scale;
+    float           _min_scale;
+    float           _max_scale;
+    float           _sharpness;
+    int             _interval;
+    int             _frame;
+    double          _sum_ms;
+    int             _num_samples;
+    double          _last_ms;
+    int             _num_changes;
+};
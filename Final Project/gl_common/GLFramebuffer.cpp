@@ -0,0 +1,186 @@
+//
+//  GLFramebuffer.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLFramebuffer.h"
+
+#include <fstream>
+
+
+
+GLFramebuffer::GLFramebuffer()
+{
+    _width = 0;
+    _height = 0;
+}
+
+
+GLFramebuffer::~GLFramebuffer()
+{
+    release();
+}
+
+
+/*!
+ Deletes all gl objects
+ */
+void GLFramebuffer::release(void)
+{
+    _fbo.release();
+    _color.release();
+    _depth.release();
+}
+
+
+/*!
+ Create the framebuffer
+ */
+bool GLFramebuffer::init(int width, int height)
+{
+    if(width <= 0 || height <= 0)
+    {
+        cerr << "[GLFramebuffer] - Invalid size " << width << "x" << height << "." << endl;
+        return false;
+    }
+
+    release();
+
+    _width = width;
+    _height = height;
+
+    _color.create(GLResource::TEXTURE, "GLFramebuffer");
+    glBindTexture(GL_TEXTURE_2D, _color.id());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    _color.setSize((size_t)_width * _height * 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _depth.create(GLResource::RENDERBUFFER, "GLFramebuffer");
+    glBindRenderbuffer(GL_RENDERBUFFER, _depth.id());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, _width, _height);
+    _depth.setSize((size_t)_width * _height * 4);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    _fbo.create(GLResource::FRAMEBUFFER, "GLFramebuffer");
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo.id());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _color.id(), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depth.id());
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        cerr << "[GLFramebuffer] - The framebuffer is not complete, status " << status << "." << endl;
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+ Changes the size of the framebuffer. The content is lost.
+ */
+bool GLFramebuffer::resize(int width, int height)
+{
+    if(width == _width && height == _height && _fbo.isValid()) return true;
+    return init(width, height);
+}
+
+
+/*!
+ Binds the framebuffer and sets the viewport to its size
+ */
+void GLFramebuffer::bind(void)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo.id());
+    glViewport(0, 0, _width, _height);
+}
+
+
+/*!
+ Binds the default framebuffer
+ */
+void GLFramebuffer::unbind(void)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+
+/*!
+ Reads the color buffer, bottom row first.
+ */
+bool GLFramebuffer::readPixels(vector<unsigned char>& rgb)
+{
+    if(!_fbo.isValid()) return false;
+
+    rgb.resize(_width * _height * 3);
+
+    GLint last_fbo = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &last_fbo);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _fbo.id());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, _width, _height, GL_RGB, GL_UNSIGNED_BYTE, &rgb[0]);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, last_fbo);
+
+    return true;
+}
+
+
+/*!
+ Writes the color buffer into a 24 bit bmp file.
+ */
+bool GLFramebuffer::saveBitmap(string path_and_file)
+{
+    vector<unsigned char> rgb;
+    if(!readPixels(rgb)) return false;
+
+    ofstream out(path_and_file.c_str(), ios::binary);
+    if(!out.is_open())
+    {
+        cerr << "[GLFramebuffer] - Cannot open " << path_and_file << " to write the image." << endl;
+        return false;
+    }
+
+    // the rows of a bmp file are padded to 4 bytes
+    int row_size = (_width * 3 + 3) & ~3;
+    unsigned int image_size = row_size * _height;
+
+    unsigned char header[54] = {0};
+    header[0] = 'B'; header[1] = 'M';
+    *(unsigned int*)&header[2] = 54 + image_size;   // file size
+    *(unsigned int*)&header[10] = 54;               // data offset
+    *(unsigned int*)&header[14] = 40;               // info header size
+    *(int*)&header[18] = _width;
+    *(int*)&header[22] = _height;                   // positive, bottom row first
+    *(unsigned short*)&header[26] = 1;              // planes
+    *(unsigned short*)&header[28] = 24;             // bits per pixel
+    *(unsigned int*)&header[34] = image_size;
+    out.write((const char*)header, 54);
+
+    // bmp stores bgr
+    vector<unsigned char> row(row_size, 0);
+    for(int y=0; y<_height; y++)
+    {
+        for(int x=0; x<_width; x++)
+        {
+            const unsigned char* p = &rgb[(y * _width + x) * 3];
+            row[x*3+0] = p[2];
+            row[x*3+1] = p[1];
+            row[x*3+2] = p[0];
+        }
+        out.write((const char*)&row[0], row_size);
+    }
+
+    out.close();
+
+    return true;
+}
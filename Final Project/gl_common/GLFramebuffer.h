@@ -0,0 +1,104 @@
+//
+//  GLFramebuffer.h
+//  HCI557_Simple_Texture
+//
+//  An offscreen render target with a color texture and a depth buffer.
+//
+#pragma once
+
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// locals
+#include "GLResource.h"
+
+
+using namespace std;
+
+
+
+
+/*!
+ A framebuffer object with an RGBA8 color texture and a 24 bit depth / 8 bit
+ stencil renderbuffer. Everything drawn between bind() and unbind() ends up
+ in the color texture.
+ */
+class GLFramebuffer
+{
+public:
+
+    GLFramebuffer();
+    ~GLFramebuffer();
+
+
+    /*!
+     Create the framebuffer
+     @param width, height - the size in pixels
+     @return true if the framebuffer is complete
+     */
+    bool init(int width, int height);
+
+
+    /*!
+     Changes the size of the framebuffer. The content is lost.
+     */
+    bool resize(int width, int height);
+
+
+    /*!
+     Binds the framebuffer and sets the viewport to its size
+     */
+    void bind(void);
+
+
+    /*!
+     Binds the default framebuffer
+     */
+    void unbind(void);
+
+
+    /*!
+     Reads the color buffer, bottom row first.
+     @param rgb - three bytes per pixel
+     @return true if the pixels were read
+     */
+    bool readPixels(vector<unsigned char>& rgb);
+
+
+    /*!
+     Writes the color buffer into a 24 bit bmp file, which can be
+     read with loadBitmapFile().
+     @param path_and_file - the output file
+     @return true if the file was written
+     */
+    bool saveBitmap(string path_and_file);
+
+
+    inline GLuint getColorTexture(void){return _color.id();}
+    inline GLuint getID(void){return _fbo.id();}
+    inline int getWidth(void){return _width;}
+    inline int getHeight(void){return _height;}
+
+
+private:
+
+    /*!
+     Deletes all gl objects
+     */
+    void release(void);
+
+
+    // a render target, it is never evicted
+    GLResource  _fbo;
+    GLResource  _color;
+    GLResource  _depth;
+
+    int         _width;
+    int         _height;
+};
@@ -0,0 +1,311 @@
+//
+//  GLFrustumCuller.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLFrustumCuller.h"
+#include "GLThreadPool.h"
+
+#include <cmath>
+
+#ifdef GL_CULL_SSE
+    #include <xmmintrin.h>
+#endif
+
+#ifdef GL_SIMD_AVX
+    #include <immintrin.h>
+#endif
+
+
+// half extent used for objects without bounds, they always pass the test
+static const float NO_BOUNDS_EXTENT = 1.0e30f;
+
+// the objects per chunk of the thread pool, a multiple of eight for AVX
+static const int CULL_CHUNK_SIZE = 256;
+
+
+
+GLFrustumCuller::GLFrustumCuller()
+{
+    _num_visible = 0;
+
+    for(int i=0; i<6; i++)
+    {
+        _planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+
+GLFrustumCuller::~GLFrustumCuller()
+{
+
+}
+
+
+/*!
+ Add an object to the culler. The objects are drawn in the order they were added.
+ The culler does not own the object.
+ @param object - the object, must be initialized so that its bounds are known
+ @return the index of the object
+ */
+int GLFrustumCuller::add(GLObject* object)
+{
+    if(object == NULL)
+    {
+        cerr << "[GLFrustumCuller] - Cannot add a NULL object." << endl;
+        return -1;
+    }
+
+    if(!object->hasBounds())
+    {
+        cerr << "[GLFrustumCuller] - The object has no bounds. It will never be culled." << endl;
+    }
+
+    _objects.push_back(object);
+    _cx.push_back(0.0f); _cy.push_back(0.0f); _cz.push_back(0.0f);
+    _ex.push_back(0.0f); _ey.push_back(0.0f); _ez.push_back(0.0f);
+    _visible.push_back(1);
+
+    _num_visible = (int)_objects.size();
+
+    return (int)_objects.size() - 1;
+}
+
+
+/*!
+ Writes the world space bounding box of object i into the SoA arrays.
+ The box is transformed as center and half extent, the new half extent is
+ |M| * extent, which gives the box around the transformed local box.
+ */
+void GLFrustumCuller::updateBounds(int i)
+{
+    GLObject* object = _objects[i];
+
+    if(!object->hasBounds())
+    {
+        _cx[i] = 0.0f; _cy[i] = 0.0f; _cz[i] = 0.0f;
+        _ex[i] = NO_BOUNDS_EXTENT; _ey[i] = NO_BOUNDS_EXTENT; _ez[i] = NO_BOUNDS_EXTENT;
+        return;
+    }
+
+    const glm::mat4& m = object->getMatrix();
+    glm::vec3 c = (object->getBoundsMax() + object->getBoundsMin()) * 0.5f;
+    glm::vec3 e = (object->getBoundsMax() - object->getBoundsMin()) * 0.5f;
+
+    glm::vec4 wc = m * glm::vec4(c.x, c.y, c.z, 1.0f);
+
+    _cx[i] = wc.x;
+    _cy[i] = wc.y;
+    _cz[i] = wc.z;
+
+    _ex[i] = fabs(m[0][0]) * e.x + fabs(m[1][0]) * e.y + fabs(m[2][0]) * e.z;
+    _ey[i] = fabs(m[0][1]) * e.x + fabs(m[1][1]) * e.y + fabs(m[2][1]) * e.z;
+    _ez[i] = fabs(m[0][2]) * e.x + fabs(m[1][2]) * e.y + fabs(m[2][2]) * e.z;
+}
+
+
+/*!
+ Test all objects against the view frustum.
+ @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+ */
+void GLFrustumCuller::cull(const glm::mat4& view_projection)
+{
+    const glm::mat4& m = view_projection;
+
+    // Extract the planes from the rows of the matrix (Gribb/Hartmann).
+    // glm stores columns, m[col][row].
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    _planes[0] = row3 + row0; // left
+    _planes[1] = row3 - row0; // right
+    _planes[2] = row3 + row1; // bottom
+    _planes[3] = row3 - row1; // top
+    _planes[4] = row3 + row2; // near
+    _planes[5] = row3 - row2; // far
+
+    // the worker threads test chunks of the boxes
+    GLThreadPool::Get().parallelFor((int)_objects.size(), CULL_CHUNK_SIZE,
+        [this](int start, int end, int){ cullRange(start, end); });
+
+    _num_visible = 0;
+    for(int i=0; i<_visible.size(); i++)
+    {
+        _num_visible += _visible[i];
+    }
+}
+
+
+/*!
+ Tests a world space box against the planes of the last cull() call, see cullScalar()
+ */
+bool GLFrustumCuller::isVisible(const glm::vec3& bmin, const glm::vec3& bmax)
+{
+    glm::vec3 c = (bmin + bmax) * 0.5f;
+    glm::vec3 e = (bmax - bmin) * 0.5f;
+
+    for(int j=0; j<6; j++)
+    {
+        const glm::vec4& p = _planes[j];
+        float dist = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+        float r = fabs(p.x) * e.x + fabs(p.y) * e.y + fabs(p.z) * e.z;
+        if(dist + r < 0.0f) return false;
+    }
+    return true;
+}
+
+
+/*!
+ Updates the bounds of the boxes [start, end) and tests them with the widest instructions.
+ */
+void GLFrustumCuller::cullRange(int start, int end)
+{
+    for(int i=start; i<end; i++)
+    {
+        updateBounds(i);
+    }
+
+#ifdef GL_SIMD_AVX
+    if(GLSimdHasAVX()) start = cullAVX(start, end);
+#endif
+#ifdef GL_CULL_SSE
+    start = cullSSE(start, end);
+#endif
+    cullScalar(start, end);
+}
+
+
+/*!
+ Test the boxes [start, end) against the planes with plain C++.
+ A box is outside if it is completely behind one plane: n * c + d + |n| * e < 0.
+ */
+void GLFrustumCuller::cullScalar(int start, int end)
+{
+    for(int i=start; i<end; i++)
+    {
+        int visible = 1;
+        for(int j=0; j<6; j++)
+        {
+            const glm::vec4& p = _planes[j];
+            float dist = p.x * _cx[i] + p.y * _cy[i] + p.z * _cz[i] + p.w;
+            float r = fabs(p.x) * _ex[i] + fabs(p.y) * _ey[i] + fabs(p.z) * _ez[i];
+            if(dist + r < 0.0f)
+            {
+                visible = 0;
+                break;
+            }
+        }
+        _visible[i] = visible;
+    }
+}
+
+
+#ifdef GL_CULL_SSE
+/*!
+ Test the boxes [start, end) with SSE, four at a time.
+ @return the index of the first box that was not tested
+ */
+int GLFrustumCuller::cullSSE(int start, int end)
+{
+    int n = end;
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = start;
+    for(; i+4<=n; i+=4)
+    {
+        __m128 cx = _mm_loadu_ps(&_cx[i]);
+        __m128 cy = _mm_loadu_ps(&_cy[i]);
+        __m128 cz = _mm_loadu_ps(&_cz[i]);
+        __m128 ex = _mm_loadu_ps(&_ex[i]);
+        __m128 ey = _mm_loadu_ps(&_ey[i]);
+        __m128 ez = _mm_loadu_ps(&_ez[i]);
+
+        __m128 outside = zero;
+        for(int j=0; j<6; j++)
+        {
+            const glm::vec4& p = _planes[j];
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), cx),
+                                                _mm_mul_ps(_mm_set1_ps(p.y), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), cz),
+                                                _mm_set1_ps(p.w)));
+
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabs(p.x)), ex),
+                                             _mm_mul_ps(_mm_set1_ps(fabs(p.y)), ey)),
+                                  _mm_mul_ps(_mm_set1_ps(fabs(p.z)), ez));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, r), zero));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for(int k=0; k<4; k++)
+        {
+            _visible[i+k] = ((mask >> k) & 1) ? 0 : 1;
+        }
+    }
+
+    return i;
+}
+#endif
+
+
+#ifdef GL_SIMD_AVX
+/*!
+ Test the boxes [start, end) with AVX, eight at a time.
+ @return the index of the first box that was not tested
+ */
+GL_SIMD_AVX_TARGET int GLFrustumCuller::cullAVX(int start, int end)
+{
+    int n = start + ((end - start) & ~7);
+    const __m256 zero = _mm256_setzero_ps();
+
+    for(int i=start; i<n; i+=8)
+    {
+        __m256 cx = _mm256_loadu_ps(&_cx[i]);
+        __m256 cy = _mm256_loadu_ps(&_cy[i]);
+        __m256 cz = _mm256_loadu_ps(&_cz[i]);
+        __m256 ex = _mm256_loadu_ps(&_ex[i]);
+        __m256 ey = _mm256_loadu_ps(&_ey[i]);
+        __m256 ez = _mm256_loadu_ps(&_ez[i]);
+
+        __m256 outside = zero;
+        for(int j=0; j<6; j++)
+        {
+            const glm::vec4& p = _planes[j];
+
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x), cx),
+                                                      _mm256_mul_ps(_mm256_set1_ps(p.y), cy)),
+                                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.z), cz),
+                                                      _mm256_set1_ps(p.w)));
+
+            __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fabs(p.x)), ex),
+                                                   _mm256_mul_ps(_mm256_set1_ps(fabs(p.y)), ey)),
+                                     _mm256_mul_ps(_mm256_set1_ps(fabs(p.z)), ez));
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, r), zero, _CMP_LT_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(outside);
+        for(int k=0; k<8; k++)
+        {
+            _visible[i+k] = ((mask >> k) & 1) ? 0 : 1;
+        }
+    }
+
+    return n;
+}
+#endif
+
+
+/*!
+ Draw all objects which passed the last cull() call.
+ */
+void GLFrustumCuller::draw(void)
+{
+    for(int i=0; i<_objects.size(); i++)
+    {
+        if(_visible[i]) _objects[i]->draw();
+    }
+}
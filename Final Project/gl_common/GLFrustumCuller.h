@@ -0,0 +1,171 @@
+//
+//  GLFrustumCuller.h
+//  HCI557_Simple_Texture
+//
+//  View-frustum culling for GLObjects. The world space bounding boxes of all
+//  registered objects are kept in SoA arrays and tested against the six
+//  frustum planes, four (SSE) or eight (AVX) boxes at a time.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLSimd.h"
+
+using namespace std;
+
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define GL_CULL_SSE
+#endif
+
+
+
+class GLFrustumCuller
+{
+public:
+
+    GLFrustumCuller();
+    ~GLFrustumCuller();
+
+
+    /*!
+     Add an object to the culler. The objects are drawn in the order they were added.
+     The culler does not own the object.
+     @param object - the object, must be initialized so that its bounds are known
+     @return the index of the object
+     */
+    int add(GLObject* object);
+
+
+    /*!
+     Test all objects against the view frustum. Large object counts are split
+     into chunks which are tested on the threads of GLThreadPool.
+     @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+     */
+    void cull(const glm::mat4& view_projection);
+
+
+    /*!
+     Draw all objects which passed the last cull() call.
+     */
+    void draw(void);
+
+
+    /*!
+     Returns true if the object with the index passed the last cull() call
+     */
+    inline bool isVisible(int index){return _visible[index] != 0;}
+
+
+    /*!
+     Tests a world space box against the view frustum of the last cull() call,
+     e.g. for the draws of a GLStaticBatch
+     */
+    bool isVisible(const glm::vec3& bmin, const glm::vec3& bmax);
+
+
+    /*!
+     Hides a visible object until the next cull() call, e.g. if it is occluded
+     */
+    inline void hide(int index){if(_visible[index]){_visible[index] = 0; _num_visible--;}}
+
+
+    /*!
+     Returns the world space bounding box of the object with the index of the last cull() call
+     */
+    inline void getBounds(int index, glm::vec3& bmin, glm::vec3& bmax)
+    {
+        glm::vec3 c(_cx[index], _cy[index], _cz[index]);
+        glm::vec3 e(_ex[index], _ey[index], _ez[index]);
+        bmin = c - e;
+        bmax = c + e;
+    }
+
+
+    /*!
+     Returns the object with the index
+     */
+    inline GLObject* getObject(int index){return _objects[index];}
+
+
+    /*!
+     Returns the number of visible and culled objects of the last cull() call
+     */
+    inline int numVisible(void){return _num_visible;}
+    inline int numCulled(void){return (int)_objects.size() - _num_visible;}
+
+
+    /*!
+     Returns the number of objects
+     */
+    inline int size(void){return (int)_objects.size();}
+
+
+private:
+
+    /*!
+     Writes the world space bounding box of object i into the SoA arrays
+     */
+    void updateBounds(int i);
+
+    /*!
+     Updates the bounds of the boxes [start, end) and tests them. Runs on the worker threads.
+     */
+    void cullRange(int start, int end);
+
+    /*!
+     Test the boxes [start, end) against the planes with plain C++.
+     */
+    void cullScalar(int start, int end);
+
+#ifdef GL_CULL_SSE
+    /*!
+     Test the boxes [start, end) with SSE, four at a time.
+     @return the index of the first box that was not tested
+     */
+    int cullSSE(int start, int end);
+#endif
+
+#ifdef GL_SIMD_AVX
+    /*!
+     Test the boxes [start, end) with AVX, eight at a time.
+     @return the index of the first box that was not tested
+     */
+    GL_SIMD_AVX_TARGET int cullAVX(int start, int end);
+#endif
+
+
+    // the objects
+    vector<GLObject*>       _objects;
+
+    // world space bounding boxes as center and half extent, SoA
+    vector<float>           _cx;
+    vector<float>           _cy;
+    vector<float>           _cz;
+    vector<float>           _ex;
+    vector<float>           _ey;
+    vector<float>           _ez;
+
+    // 1 if the object is visible
+    vector<int>             _visible;
+
+    // the six frustum planes a*x + b*y + c*z + d, left, right, bottom, top, near, far
+    glm::vec4               _planes[6];
+
+    // the number of visible objects of the last cull() call
+    int                     _num_visible;
+};
@@ -0,0 +1,105 @@
+//
+//  GLGameLoop.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLGameLoop.h"
+
+#include <algorithm>
+
+
+
+GLGameLoop::GLGameLoop(double step, int max_steps)
+{
+    if(step <= 0.0)
+    {
+        cerr << "[GLGameLoop] - The step must be larger than 0, use 1/120 s." << endl;
+        step = 1.0/120.0;
+    }
+
+    _step = step;
+    _max_steps = std::max(max_steps, 1);
+    _last_time = -1.0;
+    _accumulator = 0.0;
+    _sim_time = 0.0;
+    _dropped = 0.0;
+    _frame_steps = 0;
+}
+
+
+GLGameLoop::~GLGameLoop()
+{
+
+}
+
+
+/*!
+ Adds the time since the last frame to the accumulator.
+ */
+void GLGameLoop::beginFrame(double time)
+{
+    _frame_steps = 0;
+
+    if(_last_time < 0.0)
+    {
+        _last_time = time;
+        return;
+    }
+
+    double elapsed = std::max(time - _last_time, 0.0);
+    _last_time = time;
+
+    _accumulator += elapsed;
+
+    // never simulate more than max_steps per frame
+    double max_time = _max_steps * _step;
+    if(_accumulator > max_time)
+    {
+        _dropped += _accumulator - max_time;
+        _accumulator = max_time;
+    }
+}
+
+
+/*!
+ Consumes one step from the accumulator.
+ */
+bool GLGameLoop::step(void)
+{
+    if(_accumulator < _step) return false;
+
+    _accumulator -= _step;
+    _sim_time += _step;
+    _frame_steps++;
+
+    return true;
+}
+
+
+/*!
+ Interpolates between two rigid transformations.
+ */
+glm::mat4 GLGameLoop::Interpolate(const glm::mat4& previous, const glm::mat4& current, float alpha)
+{
+    if(alpha <= 0.0f) return previous;
+    if(alpha >= 1.0f) return current;
+
+    glm::vec3 s0(glm::length(glm::vec3(previous[0])), glm::length(glm::vec3(previous[1])), glm::length(glm::vec3(previous[2])));
+    glm::vec3 s1(glm::length(glm::vec3(current[0])), glm::length(glm::vec3(current[1])), glm::length(glm::vec3(current[2])));
+
+    glm::mat3 r0(glm::vec3(previous[0]) / s0.x, glm::vec3(previous[1]) / s0.y, glm::vec3(previous[2]) / s0.z);
+    glm::mat3 r1(glm::vec3(current[0]) / s1.x, glm::vec3(current[1]) / s1.y, glm::vec3(current[2]) / s1.z);
+
+    glm::quat q = glm::slerp(glm::quat_cast(r0), glm::quat_cast(r1), alpha);
+    glm::vec3 s = glm::mix(s0, s1, alpha);
+    glm::vec3 t = glm::mix(glm::vec3(previous[3]), glm::vec3(current[3]), alpha);
+
+    glm::mat3 r = glm::mat3_cast(q);
+
+    glm::mat4 m(1.0f);
+    m[0] = glm::vec4(r[0] * s.x, 0.0f);
+    m[1] = glm::vec4(r[1] * s.y, 0.0f);
+    m[2] = glm::vec4(r[2] * s.z, 0.0f);
+    m[3] = glm::vec4(t, 1.0f);
+    return m;
+}
@@ -0,0 +1,164 @@
+//
+//  GLGameLoop.h
+//  HCI557_Simple_Texture
+//
+//  A fixed timestep driver for the main loop. The simulation advances in
+//  steps of constant length, independent of the frame rate. The renderer
+//  interpolates between the last two simulation states.
+//
+#pragma once
+
+
+// stl include
+#include <iostream>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+
+using namespace std;
+
+
+
+
+/*!
+ Usage, once per rendered frame:
+
+    loop.beginFrame(glfwGetTime());
+    while(loop.step())
+    {
+        // advance the simulation by loop.getStep() seconds
+    }
+    // render, interpolate with loop.getAlpha()
+
+ If a frame takes very long, at most max_steps steps are simulated and the
+ remaining time is dropped. The simulation slows down instead of falling
+ further behind with every frame.
+ */
+class GLGameLoop
+{
+public:
+
+    /*!
+     @param step - the length of one simulation step in seconds
+     @param max_steps - the maximum number of steps per frame
+     */
+    GLGameLoop(double step = 1.0/120.0, int max_steps = 8);
+    ~GLGameLoop();
+
+
+    /*!
+     Adds the time since the last frame to the accumulator.
+     The first call only stores the time.
+     @param time - the current time in seconds
+     */
+    void beginFrame(double time);
+
+
+    /*!
+     Consumes one step from the accumulator.
+     @return true if the simulation must advance by one step
+     */
+    bool step(void);
+
+
+    /*!
+     Returns the interpolation factor between the previous and the current
+     simulation state, in [0, 1).
+     */
+    inline float getAlpha(void){return (float)(_accumulator / _step);}
+
+
+    /*!
+     Returns the length of one simulation step in seconds
+     */
+    inline double getStep(void){return _step;}
+
+
+    /*!
+     Returns the simulated time in seconds
+     */
+    inline double getSimulationTime(void){return _sim_time;}
+
+
+    /*!
+     Returns the number of steps of the last frame
+     */
+    inline int numSteps(void){return _frame_steps;}
+
+
+    /*!
+     Returns the total time that was dropped because frames were too long
+     */
+    inline double getDroppedTime(void){return _dropped;}
+
+
+    /*!
+     Interpolates between two rigid transformations. The translation and the
+     scale are interpolated linearly, the rotation with a quaternion slerp.
+     Shear is not supported.
+     @param previous - the state of the previous step
+     @param current - the state of the current step
+     @param alpha - the interpolation factor, see getAlpha()
+     */
+    static glm::mat4 Interpolate(const glm::mat4& previous, const glm::mat4& current, float alpha);
+
+
+private:
+
+    // the length of one step and the maximum number of steps per frame
+    double      _step;
+    int         _max_steps;
+
+    // the time of the last frame, negative before the first frame
+    double      _last_time;
+
+    // the time that was not simulated yet
+    double      _accumulator;
+
+    double      _sim_time;
+    double      _dropped;
+    int         _frame_steps;
+};
+
+
+
+
+/*!
+ The previous and the current state of a simulated transformation.
+ Call store() at the beginning of every simulation step, before the
+ current matrix is changed.
+ */
+class GLTransformState
+{
+public:
+
+    GLTransformState(const glm::mat4& matrix = glm::mat4(1.0f)):
+        _previous(matrix), _current(matrix){}
+
+    /*!
+     Keeps the current matrix as the previous state
+     */
+    inline void store(void){_previous = _current;}
+
+    /*!
+     Sets the current matrix. reset() sets both states, e.g. to teleport an object.
+     */
+    inline void set(const glm::mat4& matrix){_current = matrix;}
+    inline void reset(const glm::mat4& matrix){_previous = matrix; _current = matrix;}
+
+    inline const glm::mat4& get(void){return _current;}
+
+    /*!
+     Returns the matrix to render
+     */
+    inline glm::mat4 interpolate(float alpha){return GLGameLoop::Interpolate(_previous, _current, alpha);}
+
+private:
+
+    glm::mat4   _previous;
+    glm::mat4   _current;
+};
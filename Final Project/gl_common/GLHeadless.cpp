@@ -0,0 +1,177 @@
+//
+//  GLHeadless.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLHeadless.h"
+
+#include <string.h>
+
+#ifdef GL_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+EGLDisplay  g_egl_display = EGL_NO_DISPLAY;
+EGLContext  g_egl_context = EGL_NO_CONTEXT;
+EGLSurface  g_egl_surface = EGL_NO_SURFACE;
+#endif
+
+// true if a headless context is current
+bool g_headless = false;
+
+
+
+/*!
+ Returns true if the application runs with a headless context
+ */
+bool isHeadless(void)
+{
+    return g_headless;
+}
+
+
+#ifdef GL_HEADLESS_EGL
+
+/*!
+ Returns a display that does not need a window system. Mesa provides a
+ surfaceless platform, otherwise the default display is used.
+ */
+static EGLDisplay getHeadlessDisplay(void)
+{
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    if(client_extensions != NULL && strstr(client_extensions, "EGL_MESA_platform_surfaceless") != NULL)
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+        if(getPlatformDisplay != NULL)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if(display != EGL_NO_DISPLAY) return display;
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+#endif
+
+
+/*!
+ Creates a headless context and makes it current
+ */
+bool initHeadless(int width, int height)
+{
+#ifdef GL_HEADLESS_EGL
+    g_egl_display = getHeadlessDisplay();
+
+    EGLint major = 0, minor = 0;
+    if(g_egl_display == EGL_NO_DISPLAY || !eglInitialize(g_egl_display, &major, &minor))
+    {
+        cerr << "[GLHeadless] - Cannot initialize EGL, error " << hex << eglGetError() << dec << "." << endl;
+        return false;
+    }
+
+    if(!eglBindAPI(EGL_OPENGL_API))
+    {
+        cerr << "[GLHeadless] - EGL " << major << "." << minor << " does not support desktop OpenGL." << endl;
+        shutdownHeadless();
+        return false;
+    }
+
+    // without a surface the application must render into a framebuffer object anyway
+    const char* extensions = eglQueryString(g_egl_display, EGL_EXTENSIONS);
+    bool surfaceless = extensions != NULL && strstr(extensions, "EGL_KHR_surfaceless_context") != NULL;
+
+    EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if(!eglChooseConfig(g_egl_display, config_attribs, &config, 1, &num_configs) || num_configs == 0)
+    {
+        cerr << "[GLHeadless] - No EGL config for an OpenGL context found." << endl;
+        shutdownHeadless();
+        return false;
+    }
+
+    // the same context as the window, see initWindow()
+    EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+
+    g_egl_context = eglCreateContext(g_egl_display, config, EGL_NO_CONTEXT, context_attribs);
+    if(g_egl_context == EGL_NO_CONTEXT)
+    {
+        cerr << "[GLHeadless] - Cannot create an OpenGL 3.3 core context, error " << hex << eglGetError() << dec << "." << endl;
+        shutdownHeadless();
+        return false;
+    }
+
+    if(!surfaceless)
+    {
+        EGLint pbuffer_attribs[] = {
+            EGL_WIDTH, width,
+            EGL_HEIGHT, height,
+            EGL_NONE
+        };
+        g_egl_surface = eglCreatePbufferSurface(g_egl_display, config, pbuffer_attribs);
+        if(g_egl_surface == EGL_NO_SURFACE)
+        {
+            cerr << "[GLHeadless] - Cannot create a pbuffer of " << width << "x" << height << "." << endl;
+            shutdownHeadless();
+            return false;
+        }
+    }
+
+    if(!eglMakeCurrent(g_egl_display, g_egl_surface, g_egl_surface, g_egl_context))
+    {
+        cerr << "[GLHeadless] - Cannot make the context current, error " << hex << eglGetError() << dec << "." << endl;
+        shutdownHeadless();
+        return false;
+    }
+
+    cout << "[GLHeadless] - EGL " << major << "." << minor << (surfaceless ? ", surfaceless" : ", pbuffer") << endl;
+
+    g_headless = true;
+    return true;
+#else
+    cerr << "[GLHeadless] - This build has no headless support. Install the EGL development files and run cmake again." << endl;
+    return false;
+#endif
+}
+
+
+/*!
+ Destroys the headless context
+ */
+void shutdownHeadless(void)
+{
+#ifdef GL_HEADLESS_EGL
+    if(g_egl_display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(g_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if(g_egl_surface != EGL_NO_SURFACE) eglDestroySurface(g_egl_display, g_egl_surface);
+        if(g_egl_context != EGL_NO_CONTEXT) eglDestroyContext(g_egl_display, g_egl_context);
+        eglTerminate(g_egl_display);
+    }
+
+    g_egl_display = EGL_NO_DISPLAY;
+    g_egl_context = EGL_NO_CONTEXT;
+    g_egl_surface = EGL_NO_SURFACE;
+#endif
+
+    g_headless = false;
+}
@@ -0,0 +1,39 @@
+//
+//  GLHeadless.h
+//  HCI557_Simple_Texture
+//
+//  Creates an OpenGL 3.3 core context without a window, e.g. on a build server
+//  without display and GPU (Mesa llvmpipe). The context comes from EGL, either
+//  surfaceless or with a pbuffer. Render into a GLFramebuffer.
+//
+//  The EGL backend is compiled if GL_HEADLESS_EGL is defined, see CMakeLists.txt.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+
+
+using namespace std;
+
+
+
+/*!
+ Creates a headless context and makes it current
+ @param width, height - the size of the pbuffer, if a pbuffer is required
+ @return true if the context is current
+ */
+bool initHeadless(int width, int height);
+
+
+/*!
+ Destroys the headless context
+ */
+void shutdownHeadless(void);
+
+
+/*!
+ Returns true if the application runs with a headless context
+ */
+bool isHeadless(void);
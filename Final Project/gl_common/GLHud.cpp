@@ -0,0 +1,419 @@
+//
+//  GLHud.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLHud.h"
+#include "Shaders.h"
+#include "GLProfiler.h"
+#include "GLStreamBuffer.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+
+// the texture unit of the atlas, units 0 - 5 belong to the scene
+static const int HUD_UNIT = 6;
+
+// the atlas has 16 x 5 cells of 6 x 8 pixels, the glyphs of the characters 32 to 95
+// and a white cell
+static const int CELL_WIDTH = 6;
+static const int CELL_HEIGHT = 8;
+static const int ATLAS_COLUMNS = 16;
+static const int ATLAS_ROWS = 5;
+static const int CELLS = 65;
+
+// the glyphs are drawn with 2 x 2 screen pixels per atlas pixel
+static const float SCALE = 2.0f;
+
+// the graph below the text
+static const float GRAPH_HEIGHT = 60.0f;
+static const float GRAPH_MAX_MS = 33.3f;
+static const float BAR_WIDTH = 2.0f;
+static const float MARGIN = 8.0f;
+
+// the time between two text refreshes
+static const double TEXT_INTERVAL_MS = 250.0;
+
+
+// A 5 x 7 font for the characters 32 to 95. Five columns per glyph, bit 0 is the top row.
+static const unsigned char font_5x7[64][5] =
+{
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14}, //  !"#
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00}, // $%&'
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08}, // ()*+
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02}, // ,-./
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31}, // 0123
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03}, // 4567
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00}, // 89:;
+    {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x41,0x22,0x14,0x08,0x00}, {0x02,0x01,0x51,0x09,0x06}, // <=>?
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22}, // @ABC
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x01,0x01}, {0x3E,0x41,0x41,0x51,0x32}, // DEFG
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, // HIJK
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x04,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E}, // LMNO
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31}, // PQRS
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F}, // TUVW
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x00,0x7F,0x41,0x41}, // XYZ[
+    {0x02,0x04,0x08,0x10,0x20}, {0x41,0x41,0x7F,0x00,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40}  // \]^_
+};
+
+
+static const string hud_vs =
+"#version 330 core                                                  \n"
+"uniform vec2 viewport;                                             \n"
+"in vec2 in_Position;                                               \n"
+"in vec2 in_TexCoord;                                               \n"
+"in vec4 in_Color;                                                  \n"
+"out vec2 pass_TexCoord;                                            \n"
+"out vec4 pass_Color;                                               \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    vec2 p = in_Position / viewport * 2.0 - 1.0;                   \n"
+"    gl_Position = vec4(p.x, -p.y, 0.0, 1.0);                       \n"
+"    pass_TexCoord = in_TexCoord;                                   \n"
+"    pass_Color = in_Color;                                         \n"
+"}                                                                  \n";
+
+static const string hud_fs =
+"#version 330 core                                                  \n"
+"uniform sampler2D atlas;                                           \n"
+"in vec2 pass_TexCoord;                                             \n"
+"in vec4 pass_Color;                                                \n"
+"out vec4 color;                                                    \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    color = vec4(pass_Color.rgb, pass_Color.a * texture(atlas, pass_TexCoord).r); \n"
+"}                                                                  \n";
+
+
+
+/*!
+ Packs a color with components from 0 to 255, the bytes in memory are r, g, b, a
+ */
+static inline GLuint packColor(GLuint r, GLuint g, GLuint b, GLuint a)
+{
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+
+
+/*!
+ Returns the display of this application
+ */
+//static
+GLHud& GLHud::Get(void)
+{
+    static GLHud hud;
+    return hud;
+}
+
+
+GLHud::GLHud()
+{
+    _visible = false;
+    _gpu_zone = "Scene";
+
+    _program_changes = 0;
+    _texture_changes = 0;
+
+    for(int i=0; i<GRAPH_SAMPLES; i++) _samples[i] = 0.0f;
+    _next_sample = 0;
+
+    _sum_ms = 0.0;
+    _sum_gpu_ms = 0.0;
+    _sum_draw_calls = 0;
+    _sum_triangles = 0;
+    _sum_state_changes = 0;
+    _num_sums = 0;
+    _text_width = 0.0f;
+
+    _viewportLocation = -1;
+    _atlasLocation = -1;
+    _positionLocation = -1;
+    _texCoordLocation = -1;
+    _colorLocation = -1;
+}
+
+
+GLHud::~GLHud()
+{
+    // the handles delete the atlas, the program, and the vertex array
+}
+
+
+/*!
+ Deletes the atlas and the program
+ */
+void GLHud::release(void)
+{
+    _atlas.release();
+    _program.release();
+    _vao.release();
+}
+
+
+/*!
+ Creates the glyph atlas and the program
+ */
+bool GLHud::init(void)
+{
+    if(_program.isValid()) return true;
+
+    GL_PROFILE_ZONE("GLHud::init");
+
+    // the atlas, one byte per pixel, the rows from the top
+    const int width = ATLAS_COLUMNS * CELL_WIDTH;
+    const int height = ATLAS_ROWS * CELL_HEIGHT;
+    vector<unsigned char> pixels(width * height, 0);
+
+    for(int c=0; c<CELLS; c++)
+    {
+        int x0 = (c % ATLAS_COLUMNS) * CELL_WIDTH;
+        int y0 = (c / ATLAS_COLUMNS) * CELL_HEIGHT;
+
+        for(int x=0; x<CELL_WIDTH; x++)
+        {
+            for(int y=0; y<CELL_HEIGHT; y++)
+            {
+                bool set = c == CELLS - 1 || (x < 5 && y < 7 && (font_5x7[c][x] >> y) & 1);
+                if(set) pixels[(y0 + y) * width + x0 + x] = 255;
+            }
+        }
+    }
+
+    _atlas.create(GLResource::TEXTURE, "GLHud");
+    glActiveTexture(GL_TEXTURE0 + HUD_UNIT);
+    glBindTexture(GL_TEXTURE_2D, _atlas.id());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glActiveTexture(GL_TEXTURE0);
+    _atlas.setSize(width * height);
+
+    GLuint program = CreateShaderProgram(hud_vs, hud_fs);
+    if(program == 0)
+    {
+        cerr << "[GLHud] - Cannot create the display program." << endl;
+        return false;
+    }
+    _program.adopt(GLResource::PROGRAM, program, "GLHud");
+
+    _viewportLocation = glGetUniformLocation(program, "viewport");
+    _atlasLocation = glGetUniformLocation(program, "atlas");
+    _positionLocation = glGetAttribLocation(program, "in_Position");
+    _texCoordLocation = glGetAttribLocation(program, "in_TexCoord");
+    _colorLocation = glGetAttribLocation(program, "in_Color");
+    glUniform1i(_atlasLocation, HUD_UNIT);
+    glUseProgram(0);
+
+    // the pointers are set in draw(), the offset in the stream buffer changes every frame
+    _vao.create(GLResource::VERTEX_ARRAY, "GLHud");
+    glBindVertexArray(_vao.id());
+    glEnableVertexAttribArray(_positionLocation);
+    glEnableVertexAttribArray(_texCoordLocation);
+    glEnableVertexAttribArray(_colorLocation);
+    glBindVertexArray(0);
+
+    // the panel and the text have about 300 quads, the graph one per sample
+    _text.reserve(6 * 400);
+    _vertices.reserve(6 * (400 + GRAPH_SAMPLES + 1));
+
+    return true;
+}
+
+
+/*!
+ Appends a quad of the atlas cell
+ */
+void GLHud::addQuad(vector<HudVertex>& vertices, float x, float y, float w, float h, int cell, GLuint color)
+{
+    const float du = 1.0f / ATLAS_COLUMNS;
+    const float dv = 1.0f / ATLAS_ROWS;
+
+    float u0 = (cell % ATLAS_COLUMNS) * du;
+    float v0 = (cell / ATLAS_COLUMNS) * dv;
+    float u1 = u0 + du;
+    float v1 = v0 + dv;
+
+    HudVertex a = { x, y, u0, v0, color };
+    HudVertex b = { x + w, y, u1, v0, color };
+    HudVertex c = { x + w, y + h, u1, v1, color };
+    HudVertex d = { x, y + h, u0, v1, color };
+
+    vertices.push_back(a); vertices.push_back(b); vertices.push_back(c);
+    vertices.push_back(a); vertices.push_back(c); vertices.push_back(d);
+}
+
+
+/*!
+ Appends a line of text
+ */
+float GLHud::addText(vector<HudVertex>& vertices, float x, float y, const char* text, GLuint color)
+{
+    float start = x;
+    for(const char* c = text; *c != 0; c++)
+    {
+        int ch = *c;
+        if(ch >= 'a' && ch <= 'z') ch -= 'a' - 'A';
+        if(ch < 32 || ch > 95) ch = '?';
+
+        // spaces need no quad
+        if(ch != ' ') addQuad(vertices, x, y, CELL_WIDTH * SCALE, CELL_HEIGHT * SCALE, ch - 32, color);
+        x += CELL_WIDTH * SCALE;
+    }
+    return x - start;
+}
+
+
+/*!
+ Refreshes the text with the mean values since the last refresh, draw() resets the sums
+ */
+void GLHud::updateText(void)
+{
+    double n = std::max(_num_sums, 1);
+    double ms = _sum_ms / n;
+
+    char lines[6][64];
+    snprintf(lines[0], 64, "FPS %6.1f  %6.2f MS", ms > 0.0 ? 1000.0 / ms : 0.0, ms);
+    snprintf(lines[1], 64, "GPU %-8s %5.2f MS", _gpu_zone, _sum_gpu_ms / n);
+    snprintf(lines[2], 64, "DRAWS %6.0f", _sum_draw_calls / n);
+    snprintf(lines[3], 64, "TRIS  %6.2f M", _sum_triangles / n / 1000000.0);
+    snprintf(lines[4], 64, "STATE CHANGES %5.0f", _sum_state_changes / n);
+
+    GLMemoryTracker& memory = GLMemoryTracker::Get();
+    if(memory.getBudget() > 0)
+    {
+        snprintf(lines[5], 64, "GPU MEM %6.1f / %.0f MB", memory.getTotal() / 1048576.0, memory.getBudget() / 1048576.0);
+    }
+    else
+    {
+        snprintf(lines[5], 64, "GPU MEM %6.1f MB", memory.getTotal() / 1048576.0);
+    }
+
+    // the panel first, it is drawn behind the text and the graph
+    const float line_height = (CELL_HEIGHT + 2) * SCALE;
+
+    _text_width = GRAPH_SAMPLES * BAR_WIDTH;
+    for(int i=0; i<6; i++)
+    {
+        _text_width = std::max(_text_width, strlen(lines[i]) * CELL_WIDTH * SCALE);
+    }
+
+    _text.clear();
+    addQuad(_text, MARGIN, MARGIN, _text_width + MARGIN * 2.0f, 6 * line_height + GRAPH_HEIGHT + MARGIN * 3.0f,
+            CELLS - 1, packColor(0, 0, 0, 160));
+
+    GLuint white = packColor(255, 255, 255, 255);
+    for(int i=0; i<6; i++)
+    {
+        addText(_text, MARGIN * 2.0f, MARGIN * 2.0f + i * line_height, lines[i], white);
+    }
+}
+
+
+/*!
+ Adds the frame time of the last frame to the graph and draws the display
+ */
+void GLHud::draw(void)
+{
+    GL_PROFILE_ZONE("GLHud::draw");
+
+    GLProfiler& profiler = GLProfiler::Get();
+    float ms = (float)profiler.getFrameTime();
+
+    _samples[_next_sample] = ms;
+    _next_sample = (_next_sample + 1) % GRAPH_SAMPLES;
+
+    _sum_ms += ms;
+    _sum_gpu_ms += profiler.getGPUTime(_gpu_zone);
+    _sum_draw_calls += profiler.getDrawCalls();
+    _sum_triangles += profiler.getTriangles();
+    _sum_state_changes += _program_changes + _texture_changes;
+    _num_sums++;
+
+    bool visible = _visible && _program.isValid();
+    if(_sum_ms >= TEXT_INTERVAL_MS || (visible && _text.size() == 0))
+    {
+        if(visible) updateText();
+
+        _sum_ms = 0.0;
+        _sum_gpu_ms = 0.0;
+        _sum_draw_calls = 0;
+        _sum_triangles = 0;
+        _sum_state_changes = 0;
+        _num_sums = 0;
+    }
+    if(!visible) return;
+
+    // the graph, the oldest sample on the left
+    _vertices.assign(_text.begin(), _text.end());
+
+    const float line_height = (CELL_HEIGHT + 2) * SCALE;
+    float x0 = MARGIN * 2.0f;
+    float bottom = MARGIN * 2.0f + 6 * line_height + GRAPH_HEIGHT;
+
+    for(int i=0; i<GRAPH_SAMPLES; i++)
+    {
+        float s = _samples[(_next_sample + i) % GRAPH_SAMPLES];
+        float h = std::min(s / GRAPH_MAX_MS, 1.0f) * GRAPH_HEIGHT;
+        if(h <= 0.0f) continue;
+
+        GLuint color = s < 16.7f ? packColor(64, 220, 64, 255) : (s < 33.3f ? packColor(240, 220, 64, 255) : packColor(240, 64, 64, 255));
+        addQuad(_vertices, x0 + i * BAR_WIDTH, bottom - h, BAR_WIDTH - 0.5f, h, CELLS - 1, color);
+    }
+
+    // the 60 fps line
+    float y60 = bottom - 16.7f / GRAPH_MAX_MS * GRAPH_HEIGHT;
+    addQuad(_vertices, x0, y60, GRAPH_SAMPLES * BAR_WIDTH, 1.0f, CELLS - 1, packColor(255, 255, 255, 128));
+
+    GLintptr offset = 0;
+    GLsizeiptr size = _vertices.size() * sizeof(HudVertex);
+    void* data = GLStreamBuffer::Get().map(size, sizeof(HudVertex), offset);
+    if(data == NULL) return;
+    memcpy(data, &_vertices[0], size);
+    GLStreamBuffer::Get().unmap();
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLint blend_func[4];
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blend_func[0]);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blend_func[1]);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_func[2]);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_func[3]);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(_program.id());
+    glUniform2f(_viewportLocation, (float)viewport[2], (float)viewport[3]);
+
+    glActiveTexture(GL_TEXTURE0 + HUD_UNIT);
+    glBindTexture(GL_TEXTURE_2D, _atlas.id());
+    glActiveTexture(GL_TEXTURE0);
+
+    // the pointers start at the vertices of this frame, any byte offset works
+    glBindVertexArray(_vao.id());
+    glBindBuffer(GL_ARRAY_BUFFER, GLStreamBuffer::Get().getID());
+    glVertexAttribPointer(_positionLocation, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (const GLvoid*)(offset));
+    glVertexAttribPointer(_texCoordLocation, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (const GLvoid*)(offset + 2 * sizeof(float)));
+    glVertexAttribPointer(_colorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (const GLvoid*)(offset + 4 * sizeof(float)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)_vertices.size());
+    GLProfiler::Get().countDraw((int)_vertices.size() / 3);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    if(depth_test) glEnable(GL_DEPTH_TEST);
+    if(!blend) glDisable(GL_BLEND);
+    glBlendFuncSeparate(blend_func[0], blend_func[1], blend_func[2], blend_func[3]);
+}
@@ -0,0 +1,157 @@
+//
+//  GLHud.h
+//  HCI557_Simple_Texture
+//
+//  An on-screen display of the frame time, the draw calls, triangles, state
+//  changes, and the GPU memory. The text and the frame time graph are drawn
+//  with one draw call from a small glyph atlas.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// locals
+#include "GLResource.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The glyph atlas is a 5x7 pixel font for the characters 32 to 95, created when init() is
+ called, plus one white cell for the panel and the graph bars. Lowercase letters are drawn
+ as uppercase letters.
+
+ draw() reads the counters of the last complete frame from GLProfiler and GLMemoryTracker,
+ the state changes come from setStateChanges(). The text is refreshed four times a second
+ with the mean values since the last refresh, the graph shows the frame times of the last
+ GRAPH_SAMPLES frames; a bar is green below 16.7 ms, yellow below 33.3 ms, red above.
+ The quads are written into GLStreamBuffer::Get() and drawn with one glDrawArrays() call.
+
+ The frame times are collected also while the display is hidden.
+ */
+class GLHud
+{
+public:
+
+    /*!
+     Returns the display of this application
+     */
+    static GLHud& Get(void);
+
+
+    /*!
+     Creates the glyph atlas and the program
+     @return true if the display can be drawn
+     */
+    bool init(void);
+
+
+    /*!
+     Shows or hides the display, hidden by default
+     */
+    inline void setVisible(bool visible){_visible = visible;}
+    inline bool isVisible(void){return _visible;}
+    inline void toggle(void){_visible = !_visible;}
+
+
+    /*!
+     Set the program and texture changes of the frame, e.g. from GLRenderQueue
+     */
+    inline void setStateChanges(int program_changes, int texture_changes){_program_changes = program_changes; _texture_changes = texture_changes;}
+
+
+    /*!
+     Set the GPU zone of GLProfiler whose time is shown, "Scene" by default
+     @param name - a static string
+     */
+    inline void setGPUZone(const char* name){_gpu_zone = name;}
+
+
+    /*!
+     Adds the frame time of the last frame to the graph and draws the display
+     into the top left corner of the viewport. Call it once per frame after the scene.
+     */
+    void draw(void);
+
+
+    /*!
+     Deletes the atlas and the program. Call this before the context is destroyed.
+     */
+    void release(void);
+
+
+    // the number of frames in the graph
+    static const int GRAPH_SAMPLES = 120;
+
+
+private:
+
+    GLHud();
+    ~GLHud();
+
+
+    typedef struct _HudVertex
+    {
+        float   x, y;   // pixels from the top left corner
+        float   u, v;
+        GLuint  color;  // RGBA, 8 bits each
+    }HudVertex;
+
+
+    /*!
+     Refreshes the text with the mean values since the last refresh
+     */
+    void updateText(void);
+
+
+    /*!
+     Appends a quad of the atlas cell, the white cell is CELLS - 1
+     */
+    void addQuad(vector<HudVertex>& vertices, float x, float y, float w, float h, int cell, GLuint color);
+
+
+    /*!
+     Appends a line of text, returns its width in pixels
+     */
+    float addText(vector<HudVertex>& vertices, float x, float y, const char* text, GLuint color);
+
+
+    bool                    _visible;
+    const char*             _gpu_zone;
+
+    int                     _program_changes;
+    int                     _texture_changes;
+
+    // the frame times of the graph, a ring
+    float                   _samples[GRAPH_SAMPLES];
+    int                     _next_sample;
+
+    // the sums since the last text refresh
+    double                  _sum_ms;
+    double                  _sum_gpu_ms;
+    long long               _sum_draw_calls;
+    long long               _sum_triangles;
+    long long               _sum_state_changes;
+    int                     _num_sums;
+
+    vector<HudVertex>       _text;      // the panel and the text, rebuilt by updateText()
+    float                   _text_width;
+    vector<HudVertex>       _vertices;  // the text and the graph of this frame
+
+    GLResource              _atlas;
+    GLResource              _program;
+    GLResource              _vao;
+    int                     _viewportLocation;
+    int                     _atlasLocation;
+    int                     _positionLocation;
+    int                     _texCoordLocation;
+    int                     _colorLocation;
+};
@@ -0,0 +1,405 @@
+//
+//  GLInstancedMesh.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLInstancedMesh.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+#include <math.h>
+
+
+
+GLInstancedMesh::GLInstancedMesh(const vector<Vertex>& points, const vector<Vertex>& normals, const vector<GLuint>& indices, int capacity):
+    _vertex_points(points), _normal_vectors(normals), _indices(indices)
+{
+    _capacity = std::max(capacity, 1);
+    _dirty_first = -1;
+    _dirty_last = -1;
+
+    _num_hidden = 0;
+    _visibility_dirty = false;
+    _compacted = false;
+    _num_drawn = 0;
+
+    _program = 0;
+
+    // the bounds of one instance
+    vector<float> p(_vertex_points.size() * 3);
+    for(int i=0; i<_vertex_points.size(); i++)
+    {
+        p[(i*3)] = _vertex_points[i].x(); p[(i*3)+1] = _vertex_points[i].y(); p[(i*3)+2] = _vertex_points[i].z();
+    }
+    computeBounds(p.size() > 0 ? &p[0] : NULL, (int)_vertex_points.size(), 3);
+    _mesh_min = _bounds_min;
+    _mesh_max = _bounds_max;
+
+    // the bounds of the object cover all instances, there are no instances yet.
+    _has_bounds = false;
+}
+
+
+GLInstancedMesh::~GLInstancedMesh()
+{
+    // the handles delete the vertex array and the buffers
+}
+
+
+
+/*!
+ Init the geometry object
+ */
+void GLInstancedMesh::init(void)
+{
+    initShader();
+    initVBO();
+}
+
+
+/*!
+ Add a new instance
+ @param matrix - the model matrix of the instance
+ @param color - the color, multiplied with the lit material color
+ @return the index of the instance
+ */
+int GLInstancedMesh::addInstance(const glm::mat4& matrix, const glm::vec4& color)
+{
+    Instance instance;
+    instance.matrix = matrix;
+    instance.color = color;
+    _instances.push_back(instance);
+    _hidden.push_back(0);
+
+    int index = (int)_instances.size() - 1;
+    if(_dirty_first == -1 || index < _dirty_first) _dirty_first = index;
+    _dirty_last = std::max(_dirty_last, index);
+
+    extendBounds(matrix);
+
+    return index;
+}
+
+
+/*!
+ Set the model matrix of one instance.
+ The buffer is updated the next time the mesh is drawn.
+ */
+void GLInstancedMesh::setInstanceMatrix(int index, const glm::mat4& matrix)
+{
+    if(index < 0 || index >= _instances.size())
+    {
+        cerr << "[GLInstancedMesh] - Instance " << index << " does not exist." << endl;
+        return;
+    }
+
+    _instances[index].matrix = matrix;
+
+    if(_dirty_first == -1 || index < _dirty_first) _dirty_first = index;
+    _dirty_last = std::max(_dirty_last, index);
+
+    extendBounds(matrix);
+}
+
+
+/*!
+ Set the color of one instance.
+ */
+void GLInstancedMesh::setInstanceColor(int index, const glm::vec4& color)
+{
+    if(index < 0 || index >= _instances.size())
+    {
+        cerr << "[GLInstancedMesh] - Instance " << index << " does not exist." << endl;
+        return;
+    }
+
+    _instances[index].color = color;
+
+    if(_dirty_first == -1 || index < _dirty_first) _dirty_first = index;
+    _dirty_last = std::max(_dirty_last, index);
+}
+
+
+/*!
+ Show or hide one instance.
+ */
+void GLInstancedMesh::setInstanceVisible(int index, bool visible)
+{
+    if(index < 0 || index >= _instances.size())
+    {
+        cerr << "[GLInstancedMesh] - Instance " << index << " does not exist." << endl;
+        return;
+    }
+
+    char hidden = visible ? 0 : 1;
+    if(_hidden[index] == hidden) return;
+
+    _hidden[index] = hidden;
+    _num_hidden += visible ? -1 : 1;
+    _visibility_dirty = true;
+}
+
+
+/*!
+ Returns the world space bounding box of one instance
+ */
+void GLInstancedMesh::getInstanceBounds(int index, glm::vec3& bmin, glm::vec3& bmax)
+{
+    glm::mat4 m = _modelMatrix * _instances[index].matrix;
+
+    // center and half extent, the new half extent is |M| * extent
+    glm::vec3 c = glm::vec3(m * glm::vec4((_mesh_min + _mesh_max) * 0.5f, 1.0f));
+    glm::vec3 e = (_mesh_max - _mesh_min) * 0.5f;
+    glm::vec3 we;
+    for(int i=0; i<3; i++)
+    {
+        we[i] = fabs(m[0][i]) * e.x + fabs(m[1][i]) * e.y + fabs(m[2][i]) * e.z;
+    }
+
+    bmin = c - we;
+    bmax = c + we;
+}
+
+
+/*!
+ Grows the bounds so that they include the geometry moved by matrix.
+ The bounds never shrink, a moved instance keeps its old box in the union.
+ This keeps the update O(1) per instance and is conservative for culling,
+ resetBounds() starts a new union.
+ */
+void GLInstancedMesh::extendBounds(const glm::mat4& matrix)
+{
+    addBounds(matrix, _mesh_min, _mesh_max);
+}
+
+
+/*!
+ Copies the changed instances into the instance buffer.
+ The buffer is re-allocated with twice the size if it is too small.
+ */
+void GLInstancedMesh::updateInstanceBuffer(void)
+{
+    if(_instances.size() > _capacity)
+    {
+        while(_capacity < _instances.size()) _capacity *= 2;
+
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo[3].id());
+        glBufferData(GL_ARRAY_BUFFER, _capacity * sizeof(Instance), NULL, GL_DYNAMIC_DRAW);
+        _vbo[3].setSize(_capacity * sizeof(Instance));
+
+        // everything must be copied into the new buffer
+        _dirty_first = 0;
+        _dirty_last = (int)_instances.size() - 1;
+        _visibility_dirty = true;
+    }
+
+    // some instances are hidden, the visible ones are packed to the front of the buffer
+    if(_num_hidden > 0)
+    {
+        if(!_visibility_dirty && _dirty_first == -1) return;
+
+        // the scratch buffer keeps its memory, it grows only with the number of instances
+        _visible.clear();
+        _visible.reserve(_instances.size());
+        for(int i=0; i<_instances.size(); i++)
+        {
+            if(!_hidden[i]) _visible.push_back(_instances[i]);
+        }
+
+        _num_drawn = (int)_visible.size();
+        if(_num_drawn > 0)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, _vbo[3].id());
+            glBufferSubData(GL_ARRAY_BUFFER, 0, _num_drawn * sizeof(Instance), &_visible[0]);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        _compacted = true;
+        _visibility_dirty = false;
+        _dirty_first = -1;
+        _dirty_last = -1;
+        return;
+    }
+
+    // all instances are visible again, the packed buffer must be replaced
+    if(_compacted)
+    {
+        _dirty_first = 0;
+        _dirty_last = (int)_instances.size() - 1;
+        _compacted = false;
+    }
+    _visibility_dirty = false;
+    _num_drawn = (int)_instances.size();
+
+    if(_dirty_first == -1) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[3].id());
+    glBufferSubData(GL_ARRAY_BUFFER, _dirty_first * sizeof(Instance),
+                    (_dirty_last - _dirty_first + 1) * sizeof(Instance), &_instances[_dirty_first]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _dirty_first = -1;
+    _dirty_last = -1;
+}
+
+
+/*!
+ Draw all instances with one draw call
+ */
+bool GLInstancedMesh::drawGeometry(void)
+{
+    GL_PROFILE_ZONE("GLInstancedMesh::drawGeometry");
+    if(_instances.size() == 0) return true;
+
+    updateInstanceBuffer();
+    if(_num_drawn == 0) return true;
+
+    glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
+
+    // Bind the buffer and switch it to an active buffer
+    glBindVertexArray(_vao.id());
+
+    // Draw all instances
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)_indices.size(), GL_UNSIGNED_INT, 0, (GLsizei)_num_drawn);
+    GLProfiler::Get().countDraw((int)_indices.size() / 3, _num_drawn);
+
+    // Unbind our Vertex Array Object
+    glBindVertexArray(0);
+
+    return true;
+}
+
+
+
+/*!
+ Draws the instances of the last draw() with the bound program
+ */
+bool GLInstancedMesh::drawVertexArray(void)
+{
+    if(!_vao.isValid() || _num_drawn == 0) return false;
+
+    glBindVertexArray(_vao.id());
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)_indices.size(), GL_UNSIGNED_INT, 0, (GLsizei)_num_drawn);
+    glBindVertexArray(0);
+    return true;
+}
+
+
+
+/*
+ Inits the shader program for this object
+ */
+void GLInstancedMesh::initShader(void)
+{
+    if(!_apperance.exists())return;
+
+    // This loads the shader program from a file
+    _program = _apperance.getProgram();
+
+    glUseProgram(_program);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Define the model view matrix.
+    _modelMatrix = glm::mat4(1.0f);
+    addModelViewMatrixToProgram(_program);
+
+    glUseProgram(0);
+}
+
+
+/*!
+ Create the vertex buffer object for this element
+ */
+void GLInstancedMesh::initVBO(void)
+{
+    GL_PROFILE_ZONE("GLInstancedMesh::initVBO");
+    int num_vertices = (int)_vertex_points.size();
+
+    // create memory for the vertices, etc.
+    vector<float> vertices(num_vertices * 3);
+    vector<float> normals(num_vertices * 3);
+
+    // copy the data to the vectors
+    for(int i=0; i<num_vertices ; i++)
+    {
+        Vertex v = _vertex_points[i];
+        vertices[(i*3)] = v.x(); vertices[(i*3)+1] = v.y(); vertices[(i*3)+2] = v.z();
+
+        Vertex n = _normal_vectors[i];
+        normals[(i*3)] = n.x(); normals[(i*3)+1] = n.y(); normals[(i*3)+2] = n.z();
+    }
+
+    _vao.create(GLResource::VERTEX_ARRAY, "GLInstancedMesh"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
+
+    _vbo[0].create(GLResource::BUFFER, "GLInstancedMesh"); // Generate our Vertex Buffer Objects
+    _vbo[1].create(GLResource::BUFFER, "GLInstancedMesh");
+    _vbo[2].create(GLResource::BUFFER, "GLInstancedMesh");
+    _vbo[3].create(GLResource::BUFFER, "GLInstancedMesh");
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // vertices
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id());
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), &vertices[0], GL_STATIC_DRAW);
+    _vbo[0].setSize(vertices.size() * sizeof(GLfloat));
+
+    int locPos = glGetAttribLocation(_program, "in_Position");
+    glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(locPos);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //Normals
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id());
+    glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(GLfloat), &normals[0], GL_STATIC_DRAW);
+    _vbo[1].setSize(normals.size() * sizeof(GLfloat));
+
+    int locNorm = glGetAttribLocation(_program, "in_Normal");
+    glEnableVertexAttribArray(locNorm);
+    glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Indices, the binding is stored in the vertex array object
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo[2].id());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(GLuint), &_indices[0], GL_STATIC_DRAW);
+    _vbo[2].setSize(_indices.size() * sizeof(GLuint));
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Instances, one mat4 (four vec4 attributes) and one vec4 per instance
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[3].id());
+    glBufferData(GL_ARRAY_BUFFER, _capacity * sizeof(Instance), NULL, GL_DYNAMIC_DRAW);
+    _vbo[3].setSize(_capacity * sizeof(Instance));
+
+    int locMatrix = glGetAttribLocation(_program, "in_InstanceMatrix");
+    int locColor = glGetAttribLocation(_program, "in_InstanceColor");
+
+    if(locMatrix == -1 || locColor == -1)
+    {
+        cerr << "[GLInstancedMesh] - The shader program " << _program << " has no in_InstanceMatrix or in_InstanceColor attribute." << endl;
+    }
+    else
+    {
+        for(int i=0; i<4; i++)
+        {
+            glEnableVertexAttribArray(locMatrix + i);
+            glVertexAttribPointer((GLuint)(locMatrix + i), 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                  (const GLvoid*)(i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(locMatrix + i, 1);
+        }
+
+        glEnableVertexAttribArray(locColor);
+        glVertexAttribPointer((GLuint)locColor, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              (const GLvoid*)(sizeof(glm::mat4)));
+        glVertexAttribDivisor(locColor, 1);
+    }
+
+    glBindVertexArray(0); // Disable our Vertex Array Object
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // all instances that were added before init must be copied
+    if(_instances.size() > 0)
+    {
+        _dirty_first = 0;
+        _dirty_last = (int)_instances.size() - 1;
+    }
+}
@@ -0,0 +1,210 @@
+//
+//  GLInstancedMesh.h
+//  HCI557_Simple_Texture
+//
+//  One geometry drawn many times with a single instanced draw call.
+//  Every instance has its own model matrix and color.
+//
+#pragma once
+
+
+// stl include
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+
+// locals
+#include "GLObject.h"
+#include "Shaders.h"
+
+#include "HCI557Datatypes.h"
+
+
+
+
+/*!
+ The mesh keeps one vertex, normal and index buffer and a second buffer with
+ one model matrix and one color per instance. The shader program needs the
+ per-instance attributes
+    in mat4 in_InstanceMatrix;
+    in vec4 in_InstanceColor;
+ see ../data/shaders/instanced_lights.vs.
+ The model matrix of the object itself (setMatrix) moves all instances.
+ */
+class GLInstancedMesh : public GLObject
+{
+public:
+
+    /*!
+     Create the mesh from indexed triangles
+     @param points - the vertices
+     @param normals - one normal vector per vertex
+     @param indices - three indices per triangle
+     @param capacity - the number of instances the buffer is allocated for. It grows if necessary.
+     */
+    GLInstancedMesh(const vector<Vertex>& points, const vector<Vertex>& normals, const vector<GLuint>& indices, int capacity = 64);
+    ~GLInstancedMesh();
+
+
+    /*!
+     Init the geometry object
+     */
+    void init(void);
+
+
+    /*!
+     Draw all instances with one draw call
+     See GLObject::drawGeometry()
+     */
+    virtual bool drawGeometry(void);
+
+
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
+
+
+    /*!
+     Draws the instances of the last draw() with the bound program
+     */
+    virtual bool drawVertexArray(void);
+
+
+    /*!
+     Add a new instance
+     @param matrix - the model matrix of the instance
+     @param color - the color, multiplied with the lit material color
+     @return the index of the instance
+     */
+    int addInstance(const glm::mat4& matrix, const glm::vec4& color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+
+
+    /*!
+     Set the model matrix of one instance.
+     The buffer is updated the next time the mesh is drawn.
+     */
+    void setInstanceMatrix(int index, const glm::mat4& matrix);
+
+
+    /*!
+     Set the color of one instance.
+     */
+    void setInstanceColor(int index, const glm::vec4& color);
+
+
+    /*!
+     Returns the model matrix of one instance
+     */
+    inline const glm::mat4& getInstanceMatrix(int index){return _instances[index].matrix;}
+
+
+    /*!
+     Show or hide one instance, e.g. if it is occluded. Hidden instances are
+     not copied into the part of the buffer that is drawn.
+     */
+    void setInstanceVisible(int index, bool visible);
+    inline bool isInstanceVisible(int index){return _hidden[index] == 0;}
+
+
+    /*!
+     Returns the world space bounding box of one instance
+     */
+    void getInstanceBounds(int index, glm::vec3& bmin, glm::vec3& bmax);
+
+
+    /*!
+     Returns the number of instances
+     */
+    inline int size(void){return (int)_instances.size();}
+
+
+    /*!
+     The bounds of the mesh only grow when instances move. To shrink them, e.g. after
+     instances moved far away, reset them and extend them with the instances that count.
+     Without bounds the mesh is never culled.
+     */
+    inline void resetBounds(void){_has_bounds = false;}
+
+
+    /*!
+     Grows the bounds so that they include the geometry moved by matrix
+     */
+    void extendBounds(const glm::mat4& matrix);
+
+
+protected:
+
+    /*!
+     Create the vertex buffer object for this element
+     */
+    virtual void initVBO(void);
+
+
+    /*
+     Inits the shader program for this object
+     */
+    virtual void initShader(void);
+
+
+    /*!
+     Copies the changed instances into the instance buffer
+     */
+    void updateInstanceBuffer(void);
+
+
+    // The data of one instance, this is the layout of the instance buffer
+    typedef struct _Instance
+    {
+        glm::mat4   matrix;
+        glm::vec4   color;
+    }Instance;
+
+
+    // the geometry
+    vector<Vertex>          _vertex_points;
+    vector<Vertex>          _normal_vectors;
+    vector<GLuint>          _indices;
+
+    // the bounds of one instance
+    glm::vec3               _mesh_min;
+    glm::vec3               _mesh_max;
+
+    // the instances and the range which must be copied to the buffer
+    vector<Instance>        _instances;
+    int                     _dirty_first;
+    int                     _dirty_last;
+
+    // the number of instances the buffer can hold
+    int                     _capacity;
+
+    // 1 for hidden instances. If instances are hidden, the buffer holds only the visible ones.
+    vector<char>            _hidden;
+    int                     _num_hidden;
+    bool                    _visibility_dirty;
+    bool                    _compacted;
+
+    // the visible instances packed for the buffer, reused by every update
+    vector<Instance>        _visible;
+
+    // the number of instances in the buffer
+    int                     _num_drawn;
+
+    // the program
+    GLuint                  _program;
+
+    GLResource              _vao; // Our Vertex Array Object
+    GLResource              _vbo[4]; // vertices, normals, indices, instances
+
+};
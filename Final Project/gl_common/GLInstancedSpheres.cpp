@@ -0,0 +1,41 @@
+//
+//  GLInstancedSpheres.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLInstancedSpheres.h"
+
+#include <glm/gtx/transform.hpp>
+
+
+
+GLInstancedSpheres::GLInstancedSpheres(int rows, int segments, int capacity):
+    GLInstancedMesh(GLSphereMesh::Get(rows, segments).points, GLSphereMesh::Get(rows, segments).points,
+                    GLSphereMesh::Get(rows, segments).indices, capacity)
+{
+    // the points of the unit sphere are the normal vectors
+}
+
+
+GLInstancedSpheres::~GLInstancedSpheres()
+{
+
+}
+
+
+/*!
+ Add a new sphere
+ */
+int GLInstancedSpheres::addSphere(const glm::vec3& center, float radius, const glm::vec4& color)
+{
+    return addInstance(glm::translate(center) * glm::scale(glm::vec3(radius)), color);
+}
+
+
+/*!
+ Move or scale one sphere
+ */
+void GLInstancedSpheres::setSphere(int index, const glm::vec3& center, float radius)
+{
+    setInstanceMatrix(index, glm::translate(center) * glm::scale(glm::vec3(radius)));
+}
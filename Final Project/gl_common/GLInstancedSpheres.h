@@ -0,0 +1,69 @@
+//
+//  GLInstancedSpheres.h
+//  HCI557_Simple_Texture
+//
+//  Many spheres with one mesh and one instanced draw call, e.g. particles
+//  or the atoms of a molecule.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLInstancedMesh.h"
+#include "GLSphereMesh.h"
+
+
+using namespace std;
+
+
+
+/*!
+ A GLInstancedMesh of the shared unit sphere of GLSphereMesh. Every sphere has a center,
+ a radius and a color; the instance matrix is the translation to the center times the
+ scale by the radius. The color is multiplied with the lit material color, so it is the
+ material of the sphere. The appearance needs a program for GLInstancedMesh, e.g.
+ ../data/shaders/instanced_lights.vs.
+ */
+class GLInstancedSpheres : public GLInstancedMesh
+{
+public:
+
+    /*!
+     @param rows - the bands from pole to pole
+     @param segments - the slices around the poles
+     @param capacity - the number of spheres the buffer is allocated for. It grows if necessary.
+     */
+    GLInstancedSpheres(int rows = 10, int segments = 20, int capacity = 1024);
+    ~GLInstancedSpheres();
+
+
+    /*!
+     Add a new sphere
+     @return the index of the sphere
+     */
+    int addSphere(const glm::vec3& center, float radius, const glm::vec4& color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+
+
+    /*!
+     Move or scale one sphere, the buffer is updated the next time the spheres are drawn
+     */
+    void setSphere(int index, const glm::vec3& center, float radius);
+
+
+    /*!
+     Returns the number of triangles of one sphere
+     */
+    inline int numTriangles(void){return (int)_indices.size() / 3;}
+};
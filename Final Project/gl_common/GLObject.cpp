@@ -9,6 +9,8 @@
 #include <glm/glm.hpp>
 #include "GLObject.h"
 
+#include <algorithm>
+
 
 glm::mat4 g_projectionMatrix; // Store the projection matrix
 glm::mat4 g_viewMatrix; // Store the view matrix
@@ -75,8 +77,21 @@ void SetViewAsMatrix(glm::mat4 viewmatrix)
 }
 
 
+/*!
+ Returns the projection matrix multiplied with the current (rotated) view matrix.
+ */
+glm::mat4 GetViewProjectionMatrix(void)
+{
+    return g_projectionMatrix * g_rotated_view;
+}
+
+
 GLObject::GLObject()
 {
+    _viewMatrixLocation = -1;
+    _projectionMatrixLocation = -1;
+    _inverseViewMatrixLocation = -1;
+    _modelMatrixLocation = -1;
 
     g_projectionMatrix = glm::perspective(1.0f, (float)800 / (float)600, 0.1f, 10000.f);
     g_viewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.5f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
@@ -85,6 +100,11 @@ GLObject::GLObject()
     g_trackball =  glm::mat4();
     g_rotated_view = glm::mat4();
     
+    _has_bounds = false;
+    _bounds_min = glm::vec3(0.0f, 0.0f, 0.0f);
+    _bounds_max = glm::vec3(0.0f, 0.0f, 0.0f);
+    _bounds_center = glm::vec3(0.0f, 0.0f, 0.0f);
+    _bounds_radius = 0.0f;
 }
 
 
@@ -145,13 +165,161 @@ int GLObject::getProgram(void)
 
 
 /*!
- Set a model matrix to move the object around
+ Returns true if the material of this object is transparent
+ */
+bool GLObject::isTransparent(void)
+{
+    if(_apperance.exists())
+    {
+        return _apperance.isTransparent();
+    }
+    else
+        return false;
+}
+
+
+/*!
+ Returns the first texture of the appearance of this object, or 0
+ */
+GLuint GLObject::getTexture(void)
+{
+    if(_apperance.exists())
+    {
+        return _apperance.getTextureID();
+    }
+    else
+        return 0;
+}
+
+
+/*!
+ Binds the textures of the appearance of this object
+ @return true if the appearance has textures
+ */
+bool GLObject::bindTextures(void)
+{
+    if(_apperance.exists())
+    {
+        return _apperance.bindTextures() > 0;
+    }
+    else
+        return false;
+}
+
+
+/*!
+ Draw the objects with the program of the appearance
+ */
+void GLObject::draw(void)
+{
+    // Enable the shader program
+    glUseProgram(getProgram());
+    
+    // this changes the camera location
+    setViewUniforms();
+    
+    drawGeometry();
+    
+    // Unbind the shader program
+    glUseProgram(0);
+}
+
+
+/*!
+ Sets the view matrices of the program that is in use
+ */
+void GLObject::setViewUniforms(void)
+{
+    glm::mat4 rotated_view =  rotatedViewMatrix();
+    glUniformMatrix4fv(_viewMatrixLocation, 1, GL_FALSE, &rotated_view[0][0]); // send the view matrix to our shader
+    glUniformMatrix4fv(_inverseViewMatrixLocation, 1, GL_FALSE, &invRotatedViewMatrix()[0][0]);
+}
+
+
+/*!
+ Set a model matrix to move the object around.
+ The matrix is sent to the shader program when the object is drawn,
+ so this function does not depend on the currently bound program.
  @param matrix - the model matrix for this object.
  */
-void GLObject::setMatrix(glm::mat4& matrix)
+void GLObject::setMatrix(const glm::mat4& matrix)
 {
     _modelMatrix = matrix;
-    glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]);
+}
+
+
+/*!
+ Computes the local bounding box and bounding sphere from a vertex array.
+ The sphere is centered at the center of the box.
+ @param points - pointer to the first x-coordinate
+ @param num_points - the number of vertices
+ @param stride - the number of floats between two vertices, e.g. 5 for x,y,z,u,v
+ */
+void GLObject::computeBounds(const float* points, int num_points, int stride)
+{
+    if(points == NULL || num_points <= 0)
+    {
+        _has_bounds = false;
+        return;
+    }
+    
+    glm::vec3 bmin(points[0], points[1], points[2]);
+    glm::vec3 bmax = bmin;
+    
+    for(int i=1; i<num_points; i++)
+    {
+        const float* p = &points[i * stride];
+        bmin = glm::min(bmin, glm::vec3(p[0], p[1], p[2]));
+        bmax = glm::max(bmax, glm::vec3(p[0], p[1], p[2]));
+    }
+    
+    glm::vec3 center = (bmin + bmax) * 0.5f;
+    
+    // the largest squared distance to the center
+    float r2 = 0.0f;
+    for(int i=0; i<num_points; i++)
+    {
+        const float* p = &points[i * stride];
+        glm::vec3 d = glm::vec3(p[0], p[1], p[2]) - center;
+        r2 = std::max(r2, glm::dot(d, d));
+    }
+    
+    _bounds_min = bmin;
+    _bounds_max = bmax;
+    _bounds_center = center;
+    _bounds_radius = sqrt(r2);
+    _has_bounds = true;
+}
+
+
+/*!
+ Grows the bounds so that they include the box [bmin, bmax] moved by matrix.
+ The box is transformed as center and half extent, the new half extent is |M| * extent.
+ */
+void GLObject::addBounds(const glm::mat4& matrix, const glm::vec3& bmin, const glm::vec3& bmax)
+{
+    glm::vec3 c = (bmax + bmin) * 0.5f;
+    glm::vec3 e = (bmax - bmin) * 0.5f;
+    
+    glm::vec4 wc = matrix * glm::vec4(c.x, c.y, c.z, 1.0f);
+    glm::vec3 we(fabs(matrix[0][0]) * e.x + fabs(matrix[1][0]) * e.y + fabs(matrix[2][0]) * e.z,
+                 fabs(matrix[0][1]) * e.x + fabs(matrix[1][1]) * e.y + fabs(matrix[2][1]) * e.z,
+                 fabs(matrix[0][2]) * e.x + fabs(matrix[1][2]) * e.y + fabs(matrix[2][2]) * e.z);
+    
+    glm::vec3 new_min = glm::vec3(wc.x, wc.y, wc.z) - we;
+    glm::vec3 new_max = glm::vec3(wc.x, wc.y, wc.z) + we;
+    
+    if(_has_bounds)
+    {
+        new_min = glm::min(new_min, _bounds_min);
+        new_max = glm::max(new_max, _bounds_max);
+    }
+    
+    _bounds_min = new_min;
+    _bounds_max = new_max;
+    _bounds_center = (new_min + new_max) * 0.5f;
+    _bounds_radius = glm::length(new_max - new_min) * 0.5f;
+    _has_bounds = true;
 }
 
 
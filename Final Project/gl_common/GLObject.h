@@ -24,6 +24,8 @@
 
 // local
 #include "GLAppearance.h"
+#include "HCI557Datatypes.h"
+#include "GLResource.h"
 
 using namespace std;
 
@@ -59,6 +61,12 @@ void SetPerspectiveViewFrustum(float view_angle_y, float ratio, float near, floa
  */
 void SetViewAsMatrix(glm::mat4 viewmatrix);
 
+
+/*!
+ Returns the projection matrix multiplied with the current (rotated) view matrix.
+ */
+glm::mat4 GetViewProjectionMatrix(void);
+
 /*!
  Abstract base class for objects which share a common view.
  This object "common" type acts as a virtual camera and 
@@ -77,9 +85,28 @@ public:
     virtual ~GLObject();
     
     /*!
-     Draw the objects
+     Draw the objects. Uses the program of getProgram(), sets the view matrices
+     with setViewUniforms() and draws with drawGeometry().
+     Objects with their own program override this function.
+     */
+    virtual void draw(void);
+    
+    
+    /*!
+     Sets the view matrices of the program of getProgram(), which must be in use.
+     The uniforms belong to the program, so GLRenderQueue sets them once for
+     all objects that share a program.
      */
-    virtual void draw(void) = 0;
+    void setViewUniforms(void);
+    
+    
+    /*!
+     Sets the model matrix, binds the vertex array and draws. The program of
+     getProgram() must be in use with the view matrices set, and the textures
+     must be bound. Does not change the program or the textures.
+     @return false if the object does not support this; draw() is used instead.
+     */
+    virtual bool drawGeometry(void){return false;}
     
     
     /*!
@@ -97,10 +124,17 @@ public:
     
     
     /*!
-     Set a model matrix to move the object around
+     Set a model matrix to move the object around.
+     The matrix is sent to the shader program when the object is drawn.
      @param matrix - the model matrix for this object.
      */
-    void setMatrix(glm::mat4& matrix);
+    void setMatrix(const glm::mat4& matrix);
+    
+    
+    /*!
+     Returns the model matrix of this object
+     */
+    inline const glm::mat4& getMatrix(void){return _modelMatrix;}
     
     
     /*!
@@ -111,6 +145,68 @@ public:
     int getProgram(void);
     
     
+    /*!
+     Returns the vertex array object of this object, or 0 if it is not known.
+     Used to sort draw calls by state.
+     */
+    virtual GLuint getVertexArray(void){return 0;}
+    
+    
+    /*!
+     Returns true if the material of this object is transparent
+     */
+    bool isTransparent(void);
+    
+    
+    /*!
+     Returns the first texture of the appearance of this object, or 0
+     */
+    GLuint getTexture(void);
+    
+    
+    /*!
+     Binds the textures of the appearance of this object
+     @return true if the appearance has textures
+     */
+    bool bindTextures(void);
+    
+    
+    /*!
+     Returns the geometry of this object as indexed triangles in model coordinates,
+     e.g., to merge it into a GLStaticBatch.
+     @return false if the object does not support this.
+     */
+    virtual bool getTriangles(vector<Vertex>& /*points*/, vector<Vertex>& /*normals*/, vector<GLuint>& /*indices*/){return false;}
+    
+    
+    /*!
+     Binds the vertex array and draws the triangles with the program that is in use,
+     without uniforms or textures, e.g., for the geometry shader of GLDebugOverlay.
+     The attribute locations are the ones of getProgram().
+     @return false if the object does not support this.
+     */
+    virtual bool drawVertexArray(void){return false;}
+    
+    
+    /*!
+     Returns true if the object computed its local bounds during init.
+     Objects without bounds are never culled.
+     */
+    inline bool hasBounds(void){return _has_bounds;}
+    
+    /*!
+     Returns the axis aligned bounding box in local (model) coordinates
+     */
+    inline const glm::vec3& getBoundsMin(void){return _bounds_min;}
+    inline const glm::vec3& getBoundsMax(void){return _bounds_max;}
+    
+    /*!
+     Returns the bounding sphere in local (model) coordinates
+     */
+    inline const glm::vec3& getBoundingSphereCenter(void){return _bounds_center;}
+    inline float getBoundingSphereRadius(void){return _bounds_radius;}
+    
+    
 protected:
     
 
@@ -124,6 +220,21 @@ protected:
      */
     virtual void initShader(void) = 0;
     
+    
+    /*!
+     Computes the local bounding box and bounding sphere from a vertex array.
+     @param points - pointer to the first x-coordinate
+     @param num_points - the number of vertices
+     @param stride - the number of floats between two vertices, e.g. 5 for x,y,z,u,v
+     */
+    void computeBounds(const float* points, int num_points, int stride);
+    
+    
+    /*!
+     Grows the bounds so that they include the box [bmin, bmax] moved by matrix.
+     */
+    void addBounds(const glm::mat4& matrix, const glm::vec3& bmin, const glm::vec3& bmax);
+    
 
     // Model view projection paramaters
     glm::mat4 projectionMatrix(void);
@@ -151,6 +262,14 @@ protected:
     // An apperance object
     GLAppearance            _apperance;
     
+    
+    // The local bounding box and bounding sphere
+    bool                    _has_bounds;
+    glm::vec3               _bounds_min;
+    glm::vec3               _bounds_max;
+    glm::vec3               _bounds_center;
+    float                   _bounds_radius;
+    
 };
 
 
@@ -1,6 +1,7 @@
 
 
 #include "GLObjectObj.h"
+#include "GLProfiler.h"
 
 #include <algorithm>
 
@@ -8,7 +9,6 @@
 GLObjectObj::GLObjectObj(string filename):
 _file_and_path(filename)
 {
-    
     _file_ok = false;
     _file_ok =load_obj(filename.c_str(), _vertices, _normals, _elements);
    
@@ -16,13 +16,14 @@ _file_and_path(filename)
 
 GLObjectObj::GLObjectObj()
 {
+    _file_ok = false;
 
 }
 
 
 GLObjectObj::~GLObjectObj()
 {
-
+    // the handles delete the vertex array and the buffers
 }
 
 
@@ -118,6 +119,7 @@ bool GLObjectObj::extractNextFace3(string& in, string& out, int& pointIdx, int&
 
 bool GLObjectObj::load_obj(const char* filename, vector<glm::vec3> &vertices, vector<glm::vec3> &normals, vector<GLuint> &elements)
 {
+    GL_PROFILE_ZONE("GLObjectObj::load_obj");
     ifstream in(filename, ios::in);
     if (!in)
     {
@@ -300,17 +302,58 @@ bool GLObjectObj::load_obj(const char* filename, vector<glm::vec3> &vertices, ve
 }
 
 
+/*!
+ Returns the geometry of this object as indexed triangles in model coordinates.
+ The vertices are stored as a triangle list, so the indices just count up.
+ */
+bool GLObjectObj::getTriangles(vector<Vertex>& points, vector<Vertex>& normals, vector<GLuint>& indices)
+{
+    if(!_file_ok) return false;
+    
+    points.clear();
+    normals.clear();
+    indices.clear();
+    
+    for(int i=0; i<_vertices.size(); i++)
+    {
+        Vertex v(_vertices[i].x, _vertices[i].y, _vertices[i].z);
+        points.push_back(v);
+        
+        if(i < _normals.size())
+            normals.push_back(Vertex(_normals[i].x, _normals[i].y, _normals[i].z));
+        else
+            normals.push_back(Vertex(0.0, 1.0, 0.0));
+        
+        indices.push_back(i);
+    }
+    
+    return true;
+}
+
+
+/*!
+ Draws the triangles of the vertex array with the bound program
+ */
+bool GLObjectObj::drawVertexArray(void)
+{
+    glBindVertexArray(_vao.id());
+    glDrawArrays(GL_TRIANGLES, 0, _num_vertices);
+    glBindVertexArray(0);
+    return true;
+}
+
+
 /*!
  Create the vertex buffer object for this element
  */
 void GLObjectObj::initVBO(void)
 {
+    GL_PROFILE_ZONE("GLObjectObj::initVBO");
     _num_vertices = _vertices.size();
     
     // create memory for the vertices, etc.
     float* vertices = new float[_num_vertices * 3];
     float* normals = new float[_normals.size() * 3];
-    int* indices = new int[_elements.size()];
     
     // Copy all vertices
     for(int i=0; i<_vertices.size() ; i++)
@@ -321,6 +364,9 @@ void GLObjectObj::initVBO(void)
         }
     }
     
+    // the local bounds for view-frustum culling
+    computeBounds(vertices, _num_vertices, 3);
+    
     // copy all normals
     for(int i=0; i<_normals.size() ; i++)
     {
@@ -333,15 +379,16 @@ void GLObjectObj::initVBO(void)
     
     
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
+    _vao.create(GLResource::VERTEX_ARRAY, _file_and_path); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
     
-    glGenBuffers(2, _vboID); // Generate our Vertex Buffer Object
+    _vbo[0].create(GLResource::BUFFER, _file_and_path); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, _file_and_path);
     
     // vertices
-     int locPos = glGetAttribLocation(_program, "in_Position");
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    int locPos = glGetAttribLocation(_program, "in_Position");
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 * sizeof(GLfloat), vertices, GL_DYNAMIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
     
     glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
@@ -350,18 +397,25 @@ void GLObjectObj::initVBO(void)
     
      // normals
     int locNorm = glGetAttribLocation(_program, "in_Normal");
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _normals.size() * 3 * sizeof(GLfloat), &normals[0], GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
     
     glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(locNorm); //
     
     // Index buffer array.
-   // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vboID[2]);
+   // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo[2].id());
    // glBufferData(GL_ELEMENT_ARRAY_BUFFER, _elements.size() * sizeof(unsigned int), &_elements[0], GL_STATIC_DRAW);
 
     
     glBindVertexArray(0); // Disable our Vertex Buffer Object
+    
+    _vbo[0].setSize(_num_vertices * 3 * sizeof(GLfloat));
+    _vbo[1].setSize(_normals.size() * 3 * sizeof(GLfloat));
+    
+    // the data is on the GPU now
+    delete[] vertices;
+    delete[] normals;
 
 }
 
@@ -405,34 +459,28 @@ void GLObjectObj::initShader(void)
 /*!
  Draw the objects
  */
-void GLObjectObj::draw(void)
+bool GLObjectObj::drawGeometry(void)
 {
+    GL_PROFILE_ZONE("GLObjectObj::drawGeometry");
     
-    glUseProgram(_program);
-
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
-    
+    glBindVertexArray(_vao.id());
     
-    // this changes the camera location
-    glm::mat4 rotated_view =  rotatedViewMatrix();
-    glUniformMatrix4fv(_viewMatrixLocation, 1, GL_FALSE, &rotated_view[0][0]); // send the view matrix to our shader
-    glUniformMatrix4fv(_inverseViewMatrixLocation, 1, GL_FALSE, &invRotatedViewMatrix()[0][0]);
     glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
 
-    
    // glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
     
     // Draw the triangles
     glDrawArrays(GL_TRIANGLES, 0, _num_vertices);
+    GLProfiler::Get().countDraw(_num_vertices / 3);
     
    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _elementbuffer);
     //glDrawElements( GL_TRIANGLES, _elements.size(), GL_UNSIGNED_INT,(void*)0 );
     
-    
     // Unbind our Vertex Array Object
     glBindVertexArray(0);
     
+    return true;
 }
 
 
@@ -449,18 +497,11 @@ int GLObjectObj::size(void)
 /*!
 To update the vertices.
 This function takes a vector of vertices and replaces the current vector.
+The vertices are copied into the buffer of initVBO(), which keeps its size.
 */
 void GLObjectObj::updateVertices(float* vertices)
 {
-
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
-    
-    // vertices
-    int locPos = glGetAttribLocation(_program, "in_Position");
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
-    glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 * sizeof(GLfloat), vertices, GL_DYNAMIC_DRAW);
-    
-    glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
-    glEnableVertexAttribArray(locPos); //
-
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, _num_vertices * 3 * sizeof(GLfloat), vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -31,9 +31,28 @@ public:
     
     
     /*!
-     Draw the objects
+     Draw the objects with the bound program and textures
+     See GLObject::drawGeometry()
      */
-    void draw(void);
+    virtual bool drawGeometry(void);
+
+    
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
+    
+    
+    /*!
+     Returns the geometry of this object as indexed triangles in model coordinates
+     */
+    virtual bool getTriangles(vector<Vertex>& points, vector<Vertex>& normals, vector<GLuint>& indices);
+    
+    
+    /*!
+     Draws the triangles of the vertex array with the bound program
+     */
+    virtual bool drawVertexArray(void);
     
     
     /*!
@@ -56,6 +75,7 @@ public:
     /*!
     To update the vertices. 
     This function takes a vector of vertices and replaces the current vector.
+    Three floats per vertex, the number of vertices does not change.
     */
     void updateVertices(float* vertices);
     
@@ -108,9 +128,9 @@ private:
     
     int                     _num_vertices;
     
-    unsigned int            _vaoID[1]; // Our Vertex Array Object
+    GLResource              _vao; // Our Vertex Array Object
     
-    unsigned int            _vboID[3]; // Our Vertex Buffer Object
+    GLResource              _vbo[3]; // Our Vertex Buffer Object
     
     GLuint                  _elementbuffer;
 };
\ No newline at end of file
@@ -0,0 +1,450 @@
+//
+//  GLOcclusionCuller.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLOcclusionCuller.h"
+#include "GLProfiler.h"
+#include "GLThreadPool.h"
+
+#include <algorithm>
+#include <math.h>
+
+#ifdef GL_CULL_SSE
+#include <xmmintrin.h>
+#endif
+
+
+// triangles with a vertex closer than this w are not rasterized
+#define OCCLUSION_MIN_W 0.0001f
+
+// std::max takes the tile size by reference, it needs a definition
+const int GLOcclusionCuller::TILE_SIZE;
+
+
+
+GLOcclusionCuller::GLOcclusionCuller(int width, int height, int num_threads)
+{
+    // full tiles, and full SSE registers in every row
+    _width = std::max((width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE, TILE_SIZE);
+    _height = std::max((height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE, TILE_SIZE);
+    _tiles_x = _width / TILE_SIZE;
+    _tiles_y = _height / TILE_SIZE;
+
+    _depth.resize(_width * _height, 1.0f);
+    _tile_max.resize(_tiles_x * _tiles_y, 1.0f);
+
+    if(num_threads <= 0)
+    {
+        num_threads = GLThreadPool::Get().numThreads();
+    }
+    _num_threads = std::min(std::max(num_threads, 1), _tiles_y);
+
+    _num_tested = 0;
+    _num_occluded = 0;
+}
+
+
+GLOcclusionCuller::~GLOcclusionCuller()
+{
+
+}
+
+
+/*!
+ Add an occluder mesh.
+ */
+int GLOcclusionCuller::addOccluder(vector<Vertex>& points, vector<GLuint>& indices, const glm::mat4& matrix)
+{
+    Occluder occluder;
+    for(int i=0; i<points.size(); i++)
+    {
+        occluder.points.push_back(glm::vec3(points[i].x(), points[i].y(), points[i].z()));
+    }
+    occluder.indices = indices;
+    occluder.matrix = matrix;
+    occluder.object = NULL;
+    occluder.enabled = true;
+
+    _occluders.push_back(occluder);
+    return (int)_occluders.size() - 1;
+}
+
+
+/*!
+ Add an object as occluder.
+ */
+int GLOcclusionCuller::addOccluder(GLObject* object)
+{
+    vector<Vertex> points;
+    vector<Vertex> normals;
+    vector<GLuint> indices;
+
+    if(object != NULL && object->isTransparent())
+    {
+        cerr << "[GLOcclusionCuller] - The object is transparent and cannot be an occluder." << endl;
+        return -1;
+    }
+
+    if(object == NULL || !object->getTriangles(points, normals, indices))
+    {
+        cerr << "[GLOcclusionCuller] - The object does not provide triangles and cannot be an occluder." << endl;
+        return -1;
+    }
+
+    int index = addOccluder(points, indices, object->getMatrix());
+    _occluders[index].object = object;
+    return index;
+}
+
+
+/*!
+ Add a box as occluder
+ */
+int GLOcclusionCuller::addBoxOccluder(const glm::vec3& bmin, const glm::vec3& bmax, const glm::mat4& matrix)
+{
+    // the corner i has the max coordinate along the axes of the bits of i
+    static const GLuint box_indices[36] = {
+        0, 2, 1,  1, 2, 3,      // z min
+        4, 5, 6,  5, 7, 6,      // z max
+        0, 1, 4,  1, 5, 4,      // y min
+        2, 6, 3,  3, 6, 7,      // y max
+        0, 4, 2,  2, 4, 6,      // x min
+        1, 3, 5,  3, 7, 5 };    // x max
+
+    Occluder occluder;
+    for(int i=0; i<8; i++)
+    {
+        occluder.points.push_back(glm::vec3((i & 1) ? bmax.x : bmin.x, (i & 2) ? bmax.y : bmin.y, (i & 4) ? bmax.z : bmin.z));
+    }
+    occluder.indices.assign(box_indices, box_indices + 36);
+    occluder.matrix = matrix;
+    occluder.object = NULL;
+    occluder.enabled = true;
+
+    _occluders.push_back(occluder);
+    return (int)_occluders.size() - 1;
+}
+
+
+/*!
+ Set the model matrix of an occluder
+ */
+void GLOcclusionCuller::setOccluderMatrix(int index, const glm::mat4& matrix)
+{
+    if(index < 0 || index >= _occluders.size()) return;
+    _occluders[index].matrix = matrix;
+}
+
+
+/*!
+ Enable or disable an occluder
+ */
+void GLOcclusionCuller::setOccluderEnabled(int index, bool enabled)
+{
+    if(index < 0 || index >= _occluders.size()) return;
+    _occluders[index].enabled = enabled;
+}
+
+
+/*!
+ Clears the depth buffer and rasterizes all occluders
+ */
+void GLOcclusionCuller::render(const glm::mat4& view_projection)
+{
+    GL_PROFILE_ZONE("GLOcclusionCuller::render");
+
+    _view_projection = view_projection;
+    _num_tested = 0;
+    _num_occluded = 0;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Transform all triangles into screen space
+    _triangles.clear();
+
+    vector<glm::vec4> clip;
+    for(int i=0; i<_occluders.size(); i++)
+    {
+        Occluder& occluder = _occluders[i];
+        if(!occluder.enabled) continue;
+
+        if(occluder.object != NULL) occluder.matrix = occluder.object->getMatrix();
+        glm::mat4 mvp = view_projection * occluder.matrix;
+
+        clip.resize(occluder.points.size());
+        for(int j=0; j<occluder.points.size(); j++)
+        {
+            clip[j] = mvp * glm::vec4(occluder.points[j], 1.0f);
+        }
+
+        for(int j=0; j+2<occluder.indices.size(); j+=3)
+        {
+            ScreenTriangle tri;
+            bool valid = true;
+            float ymin = 1e30f, ymax = -1e30f;
+
+            for(int k=0; k<3; k++)
+            {
+                const glm::vec4& c = clip[occluder.indices[j+k]];
+
+                // skipping a triangle only removes occlusion, it never hides an object by mistake
+                if(c.w < OCCLUSION_MIN_W) { valid = false; break; }
+
+                float inv_w = 1.0f / c.w;
+                tri.x[k] = (c.x * inv_w * 0.5f + 0.5f) * _width;
+                tri.y[k] = (c.y * inv_w * 0.5f + 0.5f) * _height;
+                tri.z[k] = c.z * inv_w * 0.5f + 0.5f;
+
+                ymin = std::min(ymin, tri.y[k]);
+                ymax = std::max(ymax, tri.y[k]);
+            }
+            if(!valid) continue;
+
+            tri.ymin = std::max((int)floor(ymin), 0);
+            tri.ymax = std::min((int)ceil(ymax), _height - 1);
+            if(tri.ymin > tri.ymax) continue;
+
+            _triangles.push_back(tri);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Rasterize, one band of tile rows per thread
+    int tiles_per_band = (_tiles_y + _num_threads - 1) / _num_threads;
+    int band_height = tiles_per_band * TILE_SIZE;
+
+    // threads do not pay off for a few triangles
+    if(_num_threads == 1 || _triangles.size() < 64)
+    {
+        rasterizeBand(0, _height);
+        return;
+    }
+
+    // the bands run on the threads of the pool
+    int num_bands = (_height + band_height - 1) / band_height;
+    GLThreadPool::Get().parallelFor(num_bands, 1, [this, band_height](int start, int end, int)
+    {
+        for(int i=start; i<end; i++)
+        {
+            rasterizeBand(i * band_height, std::min((i + 1) * band_height, _height));
+        }
+    });
+}
+
+
+/*!
+ Rasterizes all triangles into the rows [y0, y1) and updates the tiles of these rows.
+ */
+void GLOcclusionCuller::rasterizeBand(int y0, int y1)
+{
+    std::fill(_depth.begin() + y0 * _width, _depth.begin() + y1 * _width, 1.0f);
+
+    for(int i=0; i<_triangles.size(); i++)
+    {
+        const ScreenTriangle& tri = _triangles[i];
+        if(tri.ymax < y0 || tri.ymin >= y1) continue;
+
+        rasterizeTriangle(tri, y0, y1);
+    }
+
+    // the farthest depth of every tile
+    for(int ty = y0 / TILE_SIZE; ty < y1 / TILE_SIZE; ty++)
+    {
+        for(int tx = 0; tx < _tiles_x; tx++)
+        {
+            float max_depth = 0.0f;
+            for(int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; y++)
+            {
+                const float* row = &_depth[y * _width + tx * TILE_SIZE];
+                for(int x = 0; x < TILE_SIZE; x++) max_depth = std::max(max_depth, row[x]);
+            }
+            _tile_max[ty * _tiles_x + tx] = max_depth;
+        }
+    }
+}
+
+
+/*!
+ Rasterizes one triangle into the rows [y0, y1).
+ A pixel is covered if its center is inside the triangle. It gets the farthest depth
+ of the triangle plane inside the pixel, so a sloped triangle never hides a box that
+ is in front of it somewhere in the pixel.
+ */
+void GLOcclusionCuller::rasterizeTriangle(const ScreenTriangle& t, int y0, int y1)
+{
+    float x0 = t.x[0], ya = t.y[0], z0 = t.z[0];
+    float x1 = t.x[1], yb = t.y[1], z1 = t.z[1];
+    float x2 = t.x[2], yc = t.y[2], z2 = t.z[2];
+
+    // counter clockwise, so that all edge functions are positive inside
+    float area = (x1 - x0) * (yc - ya) - (yb - ya) * (x2 - x0);
+    if(fabs(area) < 1e-8f) return;
+    if(area < 0.0f)
+    {
+        std::swap(x1, x2); std::swap(yb, yc); std::swap(z1, z2);
+        area = -area;
+    }
+
+    // edge functions e(x, y) = a * x + b * y + c
+    float a01 = ya - yb, b01 = x1 - x0, c01 = x0 * yb - x1 * ya;
+    float a12 = yb - yc, b12 = x2 - x1, c12 = x1 * yc - x2 * yb;
+    float a20 = yc - ya, b20 = x0 - x2, c20 = x2 * ya - x0 * yc;
+
+    // the depth is linear in screen space
+    float inv_area = 1.0f / area;
+    float dzdx = (a12 * z0 + a20 * z1 + a01 * z2) * inv_area;
+    float dzdy = (b12 * z0 + b20 * z1 + b01 * z2) * inv_area;
+    float zc = (c12 * z0 + c20 * z1 + c01 * z2) * inv_area;
+
+    // from the center to the farthest corner of the pixel
+    zc += 0.5f * (fabs(dzdx) + fabs(dzdy));
+
+    int xmin = std::max((int)floor(std::min(x0, std::min(x1, x2))), 0);
+    int xmax = std::min((int)ceil(std::max(x0, std::max(x1, x2))), _width - 1);
+    int ymin = std::max(t.ymin, y0);
+    int ymax = std::min(t.ymax, y1 - 1);
+    if(xmin > xmax) return;
+
+    // start at a multiple of four for aligned SSE groups
+    xmin &= ~3;
+
+#ifdef GL_CULL_SSE
+    const __m128 offset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 va01 = _mm_set1_ps(a01), va12 = _mm_set1_ps(a12), va20 = _mm_set1_ps(a20);
+    const __m128 vdzdx = _mm_set1_ps(dzdx);
+#endif
+
+    for(int y = ymin; y <= ymax; y++)
+    {
+        float py = y + 0.5f;
+        float r01 = b01 * py + c01;
+        float r12 = b12 * py + c12;
+        float r20 = b20 * py + c20;
+        float rz = dzdy * py + zc;
+
+        float* row = &_depth[y * _width];
+
+#ifdef GL_CULL_SSE
+        const __m128 vr01 = _mm_set1_ps(r01), vr12 = _mm_set1_ps(r12), vr20 = _mm_set1_ps(r20);
+        const __m128 vrz = _mm_set1_ps(rz);
+
+        for(int x = xmin; x <= xmax; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offset);
+
+            __m128 e01 = _mm_add_ps(_mm_mul_ps(va01, px), vr01);
+            __m128 e12 = _mm_add_ps(_mm_mul_ps(va12, px), vr12);
+            __m128 e20 = _mm_add_ps(_mm_mul_ps(va20, px), vr20);
+
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(e01, zero), _mm_and_ps(_mm_cmpge_ps(e12, zero), _mm_cmpge_ps(e20, zero)));
+            if(_mm_movemask_ps(inside) == 0) continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(vdzdx, px), vrz);
+            __m128 d = _mm_load_ps(row + x);
+            __m128 nd = _mm_min_ps(d, z);
+            _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nd), _mm_andnot_ps(inside, d)));
+        }
+#else
+        for(int x = xmin; x <= xmax; x++)
+        {
+            float px = x + 0.5f;
+            if(a01 * px + r01 < 0.0f || a12 * px + r12 < 0.0f || a20 * px + r20 < 0.0f) continue;
+
+            float z = dzdx * px + rz;
+            if(z < row[x]) row[x] = z;
+        }
+#endif
+    }
+}
+
+
+/*!
+ Tests a world space bounding box against the depth buffer.
+ */
+bool GLOcclusionCuller::isVisible(const glm::vec3& bmin, const glm::vec3& bmax)
+{
+    _num_tested++;
+
+    float sx0 = 1e30f, sy0 = 1e30f, sx1 = -1e30f, sy1 = -1e30f;
+    float zmin = 1.0f;
+
+    for(int i=0; i<8; i++)
+    {
+        glm::vec4 c = _view_projection * glm::vec4((i & 1) ? bmax.x : bmin.x,
+                                                   (i & 2) ? bmax.y : bmin.y,
+                                                   (i & 4) ? bmax.z : bmin.z, 1.0f);
+
+        // the box reaches the camera
+        if(c.w < OCCLUSION_MIN_W) return true;
+
+        float inv_w = 1.0f / c.w;
+        float x = (c.x * inv_w * 0.5f + 0.5f) * _width;
+        float y = (c.y * inv_w * 0.5f + 0.5f) * _height;
+        float z = c.z * inv_w * 0.5f + 0.5f;
+
+        sx0 = std::min(sx0, x); sx1 = std::max(sx1, x);
+        sy0 = std::min(sy0, y); sy1 = std::max(sy1, y);
+        zmin = std::min(zmin, z);
+    }
+
+    // The pixels the projected box touches and one more on each side. An occluder covers a
+    // pixel if it covers the center, so it can miss up to one pixel at its edges.
+    int x0 = std::max((int)floor(sx0) - 1, 0);
+    int x1 = std::min((int)floor(sx1) + 1, _width - 1);
+    int y0 = std::max((int)floor(sy0) - 1, 0);
+    int y1 = std::min((int)floor(sy1) + 1, _height - 1);
+
+    // outside of the screen, this is the job of the frustum culler
+    if(x0 > x1 || y0 > y1) return true;
+
+    for(int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++)
+    {
+        for(int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++)
+        {
+            // the whole tile is in front of the box
+            if(_tile_max[ty * _tiles_x + tx] < zmin) continue;
+
+            int px0 = std::max(x0, tx * TILE_SIZE), px1 = std::min(x1, tx * TILE_SIZE + TILE_SIZE - 1);
+            int py0 = std::max(y0, ty * TILE_SIZE), py1 = std::min(y1, ty * TILE_SIZE + TILE_SIZE - 1);
+
+            for(int y = py0; y <= py1; y++)
+            {
+                const float* row = &_depth[y * _width];
+                for(int x = px0; x <= px1; x++)
+                {
+                    if(row[x] >= zmin) return true;
+                }
+            }
+        }
+    }
+
+    _num_occluded++;
+    return false;
+}
+
+
+/*!
+ Tests all objects that passed the frustum test and hides the occluded ones.
+ */
+int GLOcclusionCuller::cull(GLFrustumCuller& culler)
+{
+    GL_PROFILE_ZONE("GLOcclusionCuller::cull");
+
+    int occluded = 0;
+    glm::vec3 bmin, bmax;
+
+    for(int i=0; i<culler.size(); i++)
+    {
+        if(!culler.isVisible(i)) continue;
+
+        culler.getBounds(i, bmin, bmax);
+        if(!isVisible(bmin, bmax))
+        {
+            culler.hide(i);
+            occluded++;
+        }
+    }
+
+    return occluded;
+}
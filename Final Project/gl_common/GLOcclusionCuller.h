@@ -0,0 +1,207 @@
+//
+//  GLOcclusionCuller.h
+//  HCI557_Simple_Texture
+//
+//  Software occlusion culling. Low-poly occluder meshes are rasterized on the
+//  CPU into a small depth buffer. Bounding boxes are tested against it before
+//  the objects are sent to the GPU. The culler makes no GL calls.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLFrustumCuller.h"
+#include "HCI557Datatypes.h"
+
+using namespace std;
+
+
+
+/*!
+ The depth buffer has a coarse resolution, 256 x 128 by default, and is divided
+ into tiles of 8 x 8 pixels. Every tile keeps the farthest depth of its pixels,
+ so most boxes are rejected or accepted with one compare per tile.
+
+ The screen is split into horizontal bands, one per thread of GLThreadPool. Every
+ band gets all triangles that overlap it, rasterized four pixels at a time with SSE.
+
+ The test is conservative. Occluders only fill the pixels whose centers they cover,
+ with the farthest depth of the triangle inside the pixel. A box is tested against the
+ pixels it touches and a border of one pixel, and is reported as occluded only if all
+ of them are behind an occluder. A box that sticks out of an occluder by less than one
+ pixel is therefore visible. Gaps between occluders that are narrower than one pixel
+ are not seen. Boxes and triangles crossing the near plane are treated as visible and
+ are not rasterized.
+ */
+class GLOcclusionCuller
+{
+public:
+
+    /*!
+     @param width, height - the size of the depth buffer, rounded up to the tile size
+     @param num_threads - the number of bands that are rasterized in parallel,
+                          0 uses all threads of GLThreadPool
+     */
+    GLOcclusionCuller(int width = 256, int height = 128, int num_threads = 0);
+    ~GLOcclusionCuller();
+
+
+    /*!
+     Add an occluder mesh. Use meshes with few triangles which are inside the
+     visible geometry, e.g. the box of a building.
+     @param points - the vertices in model coordinates
+     @param indices - three indices per triangle
+     @param matrix - the model matrix
+     @return the index of the occluder
+     */
+    int addOccluder(vector<Vertex>& points, vector<GLuint>& indices, const glm::mat4& matrix = glm::mat4(1.0f));
+
+
+    /*!
+     Add an object as occluder. The triangles come from GLObject::getTriangles(),
+     the model matrix is read from the object when the occluders are rendered.
+     Transparent objects do not hide what is behind them and are rejected.
+     @return the index of the occluder or -1 if the object has no triangles or is transparent
+     */
+    int addOccluder(GLObject* object);
+
+
+    /*!
+     Add a box as occluder, e.g. a proxy for a detailed mesh. The box must be inside
+     the visible geometry, otherwise it hides objects that can be seen.
+     @param bmin, bmax - the corners of the box in model coordinates
+     @param matrix - the model matrix
+     @return the index of the occluder
+     */
+    int addBoxOccluder(const glm::vec3& bmin, const glm::vec3& bmax, const glm::mat4& matrix = glm::mat4(1.0f));
+
+
+    /*!
+     Set the model matrix of an occluder
+     */
+    void setOccluderMatrix(int index, const glm::mat4& matrix);
+
+
+    /*!
+     Enable or disable an occluder, e.g. if the object is hidden
+     */
+    void setOccluderEnabled(int index, bool enabled);
+
+
+    /*!
+     Clears the depth buffer and rasterizes all occluders
+     @param view_projection - the projection matrix * view matrix
+     */
+    void render(const glm::mat4& view_projection);
+
+
+    /*!
+     Tests a world space bounding box against the depth buffer of the last render() call.
+     @return false if the box is completely occluded
+     */
+    bool isVisible(const glm::vec3& bmin, const glm::vec3& bmax);
+
+
+    /*!
+     Tests all objects that passed the frustum test and hides the occluded ones.
+     @param culler - the frustum culler, after cull()
+     @return the number of occluded objects
+     */
+    int cull(GLFrustumCuller& culler);
+
+
+    /*!
+     Returns the number of boxes that were tested and rejected since the last render() call
+     */
+    inline int numTested(void){return _num_tested;}
+    inline int numOccluded(void){return _num_occluded;}
+
+
+    /*!
+     Returns the number of triangles rasterized by the last render() call
+     */
+    inline int numTriangles(void){return (int)_triangles.size();}
+
+
+    /*!
+     Returns the depth buffer, row by row, bottom row first. 0 is near, 1 is far.
+     */
+    inline const vector<float>& getDepthBuffer(void){return _depth;}
+    inline int getWidth(void){return _width;}
+    inline int getHeight(void){return _height;}
+
+
+    // the size of a tile in pixels
+    static const int TILE_SIZE = 8;
+
+
+private:
+
+    // One occluder mesh
+    typedef struct _Occluder
+    {
+        vector<glm::vec3>   points;
+        vector<GLuint>      indices;
+        glm::mat4           matrix;
+        GLObject*           object;
+        bool                enabled;
+    }Occluder;
+
+
+    // One triangle in screen space
+    typedef struct _ScreenTriangle
+    {
+        float       x[3];
+        float       y[3];
+        float       z[3];
+        int         ymin;
+        int         ymax;
+    }ScreenTriangle;
+
+
+    /*!
+     Rasterizes all triangles into the rows [y0, y1) and updates the tiles of these rows.
+     */
+    void rasterizeBand(int y0, int y1);
+
+
+    /*!
+     Rasterizes one triangle into the rows [y0, y1)
+     */
+    void rasterizeTriangle(const ScreenTriangle& tri, int y0, int y1);
+
+
+    // the occluders
+    vector<Occluder>        _occluders;
+
+    // the triangles of the last render() call
+    vector<ScreenTriangle>  _triangles;
+
+    // the depth buffer and the farthest depth of every tile
+    vector<float>           _depth;
+    vector<float>           _tile_max;
+
+    int                     _width;
+    int                     _height;
+    int                     _tiles_x;
+    int                     _tiles_y;
+
+    int                     _num_threads;
+
+    // the view projection matrix of the last render() call
+    glm::mat4               _view_projection;
+
+    // statistics
+    int                     _num_tested;
+    int                     _num_occluded;
+};
@@ -0,0 +1,277 @@
+//
+//  GLProfiler.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLProfiler.h"
+
+#include <fstream>
+#include <chrono>
+
+
+
+/*!
+ Returns the profiler of this application
+ */
+GLProfiler& GLProfiler::Get(void)
+{
+    static GLProfiler profiler;
+    return profiler;
+}
+
+
+GLProfiler::GLProfiler()
+{
+    _enabled = true;
+    _frame = 0;
+    _gpu_depth = 0;
+    _frame_start = 0.0;
+    _frame_time = 0.0;
+
+    _draw_calls_current = 0;
+    _draw_calls_last = 0;
+    _triangles_current = 0;
+    _triangles_last = 0;
+
+    for(int i=0; i<QUERY_SETS; i++) _queries_used[i] = 0;
+
+    _epoch = 0.0;
+    _epoch = now();
+}
+
+
+GLProfiler::~GLProfiler()
+{
+    // The queries are not deleted, the context is usually gone when
+    // static objects are destroyed.
+}
+
+
+/*!
+ Returns the time since the profiler was created in microseconds
+ */
+double GLProfiler::now(void)
+{
+    using namespace std::chrono;
+    return duration_cast<duration<double, std::micro> >(steady_clock::now().time_since_epoch()).count() - _epoch;
+}
+
+
+/*!
+ Start a new frame. Collects the GPU results of the frame that used the
+ same query set QUERY_SETS frames ago, if they are available.
+ */
+void GLProfiler::beginFrame(void)
+{
+    _frame++;
+
+    double t = now();
+    if(_frame_start > 0.0) _frame_time = (t - _frame_start) / 1000.0;
+    _frame_start = t;
+
+    if(!_enabled) return;
+
+    // read the results of the query set we are about to reuse
+    int set = _frame % QUERY_SETS;
+    _gpu_read.clear();
+
+    for(int i=0; i<_queries_used[set]; i++)
+    {
+        GPUQuery& q = _queries[set][i];
+
+        GLint available = 0;
+        glGetQueryObjectiv(q.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        // never wait for the GPU, a late result is dropped
+        if(!available) continue;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(q.query, GL_QUERY_RESULT, &elapsed);
+
+        Event e;
+        e.name = q.name;
+        e.start = q.cpu_start;
+        e.duration = (double)elapsed / 1000.0;
+        e.track = 1;
+        e.frame = _frame - QUERY_SETS;
+        _events.push_back(e);
+
+        _gpu_read[q.name] += e.duration / 1000.0;
+    }
+    _queries_used[set] = 0;
+
+    // without any result the last times stay, so getGPUTime() does not drop to 0
+    if(_gpu_read.size() > 0) _gpu_last.swap(_gpu_read);
+}
+
+
+/*!
+ Ends the frame and stores the CPU time and the draw calls of the frame.
+ */
+void GLProfiler::endFrame(void)
+{
+    _draw_calls_last = _draw_calls_current;
+    _triangles_last = _triangles_current;
+    _draw_calls_current = 0;
+    _triangles_current = 0;
+
+    if(!_enabled) return;
+
+    _cpu_last.swap(_cpu_current);
+    _cpu_current.clear();
+
+    // drop the older half of the events if the trace gets too long
+    if(_events.size() > MAX_EVENTS)
+    {
+        _events.erase(_events.begin(), _events.begin() + _events.size() / 2);
+    }
+}
+
+
+/*!
+ Begin a CPU zone. Zones can be nested.
+ */
+void GLProfiler::beginCPU(const char* name)
+{
+    if(!_enabled) return;
+
+    Event e;
+    e.name = name;
+    e.start = now();
+    e.duration = 0.0;
+    e.track = 0;
+    e.frame = _frame;
+    _cpu_stack.push_back(e);
+}
+
+
+/*!
+ End the last CPU zone.
+ */
+void GLProfiler::endCPU(void)
+{
+    if(!_enabled || _cpu_stack.size() == 0) return;
+
+    Event e = _cpu_stack.back();
+    _cpu_stack.pop_back();
+
+    e.duration = now() - e.start;
+    _events.push_back(e);
+
+    _cpu_current[e.name] += e.duration / 1000.0;
+}
+
+
+/*!
+ Begin a GPU zone. GL_TIME_ELAPSED queries cannot be nested,
+ a GPU zone inside another GPU zone is ignored.
+ */
+void GLProfiler::beginGPU(const char* name)
+{
+    if(!_enabled) return;
+
+    _gpu_depth++;
+    if(_gpu_depth > 1) return;
+
+    int set = _frame % QUERY_SETS;
+    if(_queries_used[set] == _queries[set].size())
+    {
+        GPUQuery q;
+        glGenQueries(1, &q.query);
+        _queries[set].push_back(q);
+    }
+
+    GPUQuery& q = _queries[set][_queries_used[set]];
+    q.name = name;
+    q.cpu_start = now();
+    _queries_used[set]++;
+
+    glBeginQuery(GL_TIME_ELAPSED, q.query);
+}
+
+
+/*!
+ End the GPU zone.
+ */
+void GLProfiler::endGPU(void)
+{
+    if(!_enabled || _gpu_depth == 0) return;
+
+    _gpu_depth--;
+    if(_gpu_depth > 0) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+
+/*!
+ Returns the accumulated time of a zone in the last complete frame in ms.
+ */
+double GLProfiler::getCPUTime(const string& name)
+{
+    map<string, double>::iterator itr = _cpu_last.find(name);
+    if(itr == _cpu_last.end()) return 0.0;
+    return itr->second;
+}
+
+
+double GLProfiler::getGPUTime(const string& name)
+{
+    map<string, double>::iterator itr = _gpu_last.find(name);
+    if(itr == _gpu_last.end()) return 0.0;
+    return itr->second;
+}
+
+
+/*!
+ Writes all recorded zones into a Chrome trace_event JSON file.
+ CPU zones are on thread 0, GPU zones on thread 1. A GPU zone starts at the
+ CPU time when it was issued, its length is the measured GPU time.
+ @param path_and_file - the output file
+ @return true if the file was written
+ */
+bool GLProfiler::exportChromeTrace(string path_and_file)
+{
+    ofstream out(path_and_file.c_str());
+    if(!out.is_open())
+    {
+        cerr << "[GLProfiler] - Cannot open " << path_and_file << " to write the trace." << endl;
+        return false;
+    }
+
+    out << "{\"traceEvents\":[" << endl;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}}," << endl;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+    out.setf(ios::fixed);
+    out.precision(3);
+
+    for(int i=0; i<_events.size(); i++)
+    {
+        Event& e = _events[i];
+        out << "," << endl;
+        out << "{\"name\":\"" << e.name << "\",\"cat\":\"" << (e.track == 0 ? "cpu" : "gpu")
+            << "\",\"ph\":\"X\",\"ts\":" << e.start << ",\"dur\":" << e.duration
+            << ",\"pid\":0,\"tid\":" << e.track << ",\"args\":{\"frame\":" << e.frame << "}}";
+    }
+
+    out << endl << "],\"displayTimeUnit\":\"ms\"}" << endl;
+    out.close();
+
+    cout << "[GLProfiler] - Wrote " << _events.size() << " events to " << path_and_file << endl;
+
+    return true;
+}
+
+
+/*!
+ Removes all recorded events
+ */
+void GLProfiler::clear(void)
+{
+    _events.clear();
+    _cpu_current.clear();
+    _cpu_last.clear();
+    _gpu_last.clear();
+    _gpu_read.clear();
+}
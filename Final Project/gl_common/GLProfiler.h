@@ -0,0 +1,228 @@
+//
+//  GLProfiler.h
+//  HCI557_Simple_Texture
+//
+//  A frame profiler with CPU zones and GPU zones. GPU zones use GL_TIME_ELAPSED
+//  queries which are read back four frames later, so the profiler never waits
+//  for the GPU. All zones can be exported in the Chrome trace_event format
+//  (open chrome://tracing and load the file).
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+// GLEW include
+#include <GL/glew.h>
+
+using namespace std;
+
+
+
+class GLProfiler
+{
+public:
+
+    /*!
+     Returns the profiler of this application
+     */
+    static GLProfiler& Get(void);
+
+
+    /*!
+     Enable or disable the profiler. A disabled profiler records nothing.
+     */
+    inline void setEnabled(bool enabled){_enabled = enabled;}
+    inline bool isEnabled(void){return _enabled;}
+
+
+    /*!
+     Start a new frame. Collects the GPU results of the frame that used the
+     same query set QUERY_SETS frames ago, if they are available.
+     */
+    void beginFrame(void);
+
+
+    /*!
+     Ends the frame and stores the CPU time and the draw calls of the frame.
+     */
+    void endFrame(void);
+
+
+    /*!
+     Begin and end a CPU zone. Zones can be nested. Use GLProfileZone instead of
+     calling these functions directly.
+     @param name - a static string, the pointer is stored
+     */
+    void beginCPU(const char* name);
+    void endCPU(void);
+
+
+    /*!
+     Begin and end a GPU zone. GL_TIME_ELAPSED queries cannot be nested,
+     a GPU zone inside another GPU zone is ignored.
+     @param name - a static string, the pointer is stored
+     */
+    void beginGPU(const char* name);
+    void endGPU(void);
+
+
+    /*!
+     Counts one draw call. Every draw() calls this, also if the profiler is disabled.
+     @param triangles - the number of triangles of the call, 0 for lines
+     @param instances - the number of instances
+     */
+    inline void countDraw(int triangles, int instances = 1){_draw_calls_current++; _triangles_current += (long long)triangles * instances;}
+
+
+    /*!
+     Returns the number of draw calls and triangles of the last complete frame
+     */
+    inline int getDrawCalls(void){return _draw_calls_last;}
+    inline long long getTriangles(void){return _triangles_last;}
+
+
+    /*!
+     Returns the accumulated time of a zone in the last complete frame in ms.
+     GPU times are QUERY_SETS frames old, they keep their value while no result is available.
+     */
+    double getCPUTime(const string& name);
+    double getGPUTime(const string& name);
+
+
+    /*!
+     Returns the CPU time between the last two beginFrame() calls in ms
+     */
+    inline double getFrameTime(void){return _frame_time;}
+
+
+    /*!
+     Returns the number of the current frame
+     */
+    inline int getFrame(void){return _frame;}
+
+
+    /*!
+     Writes all recorded zones into a Chrome trace_event JSON file.
+     @param path_and_file - the output file
+     @return true if the file was written
+     */
+    bool exportChromeTrace(string path_and_file);
+
+
+    /*!
+     Removes all recorded events
+     */
+    void clear(void);
+
+
+private:
+
+    GLProfiler();
+    ~GLProfiler();
+
+
+    /*!
+     Returns the time since the profiler was created in microseconds
+     */
+    double now(void);
+
+
+    // One recorded zone
+    typedef struct _Event
+    {
+        const char*     name;
+        double          start;  // us
+        double          duration; // us
+        int             track;  // 0 = cpu, 1 = gpu
+        int             frame;
+    }Event;
+
+
+    // One GPU query of a frame
+    typedef struct _GPUQuery
+    {
+        GLuint          query;
+        const char*     name;
+        double          cpu_start; // us, to place the zone in the trace
+    }GPUQuery;
+
+
+    // the number of query sets, the results of frame n are read in frame n + QUERY_SETS.
+    // The GPU often runs one or two frames behind, fewer sets drop many results.
+    static const int QUERY_SETS = 4;
+
+    // the upper limit of stored events, older events are dropped
+    static const int MAX_EVENTS = 200000;
+
+
+    bool                    _enabled;
+    int                     _frame;
+
+    // open CPU zones
+    vector<Event>           _cpu_stack;
+
+    // the query sets, each set is used by every QUERY_SETS frame
+    vector<GPUQuery>        _queries[QUERY_SETS];
+    int                     _queries_used[QUERY_SETS];
+
+    // the number of open GPU zones, only the outer zone has a query
+    int                     _gpu_depth;
+
+    // all recorded events for the export
+    vector<Event>           _events;
+
+    // the per zone times of the current and the last frame in ms
+    map<string, double>     _cpu_current;
+    map<string, double>     _cpu_last;
+    map<string, double>     _gpu_last;
+
+    // the GPU times read in beginFrame(), they replace _gpu_last if there are any
+    map<string, double>     _gpu_read;
+
+    // the draw calls and triangles of the current and the last frame
+    int                     _draw_calls_current;
+    int                     _draw_calls_last;
+    long long               _triangles_current;
+    long long               _triangles_last;
+
+    // the start of the current frame and the last frame time in ms
+    double                  _frame_start;
+    double                  _frame_time;
+
+    // the start time of the profiler
+    double                  _epoch;
+};
+
+
+
+/*!
+ A scoped CPU zone, ends when it goes out of scope.
+ */
+class GLProfileZone
+{
+public:
+    GLProfileZone(const char* name){GLProfiler::Get().beginCPU(name);}
+    ~GLProfileZone(){GLProfiler::Get().endCPU();}
+};
+
+
+/*!
+ A scoped GPU zone, ends when it goes out of scope.
+ */
+class GLProfileGPUZone
+{
+public:
+    GLProfileGPUZone(const char* name){GLProfiler::Get().beginGPU(name);}
+    ~GLProfileGPUZone(){GLProfiler::Get().endGPU();}
+};
+
+
+// Helpers to create a scoped zone with a unique variable name
+#define GL_PROFILE_CONCAT_(a, b) a##b
+#define GL_PROFILE_CONCAT(a, b) GL_PROFILE_CONCAT_(a, b)
+#define GL_PROFILE_ZONE(name) GLProfileZone GL_PROFILE_CONCAT(_profile_zone_, __LINE__)(name)
+#define GL_PROFILE_GPU_ZONE(name) GLProfileGPUZone GL_PROFILE_CONCAT(_profile_gpu_zone_, __LINE__)(name)
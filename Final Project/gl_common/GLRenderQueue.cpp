@@ -0,0 +1,260 @@
+//
+//  GLRenderQueue.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLRenderQueue.h"
+#include "GLThreadPool.h"
+
+#include <string.h>
+
+
+// the objects per chunk of the thread pool
+static const int SUBMIT_CHUNK_SIZE = 128;
+
+
+
+GLRenderQueue::GLRenderQueue()
+{
+    _view_projection = glm::mat4(1.0f);
+    _transparency_pass = NULL;
+    _skybox = NULL;
+    _num_program_changes = 0;
+    _num_texture_changes = 0;
+}
+
+
+GLRenderQueue::~GLRenderQueue()
+{
+
+}
+
+
+/*!
+ Packs a sort key. See the class description for the layout.
+ The depth is stored with the upper 24 bits of its float representation.
+ For positive floats the bit pattern has the same order as the value.
+ */
+uint64_t GLRenderQueue::MakeKey(bool transparent, GLuint program, GLuint texture, GLuint vao, float depth)
+{
+    if(!(depth > 0.0f)) depth = 0.0f;
+
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(float));
+    uint64_t d = (bits >> 7) & 0xFFFFFF;
+
+    uint64_t state = ((uint64_t)(program & 0xFF) << 16) | ((uint64_t)(texture & 0xFF) << 8) | (uint64_t)(vao & 0xFF);
+
+    if(!transparent)
+    {
+        return (state << 39) | (d << 15);
+    }
+    else
+    {
+        // back-to-front, the farthest object gets the smallest key
+        return ((uint64_t)1 << 63) | ((0xFFFFFF - d) << 39) | (state << 15);
+    }
+}
+
+
+/*!
+ Start a new frame. Removes all packets.
+ @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+ */
+void GLRenderQueue::begin(const glm::mat4& view_projection)
+{
+    _view_projection = view_projection;
+    _packets.clear();
+}
+
+
+/*!
+ Fills the packet of an object. The key is computed from the current state of the object.
+ The depth is the w coordinate of the bounding sphere center in clip space,
+ which is the distance to the camera along the view direction.
+ */
+void GLRenderQueue::makePacket(GLObject* object, DrawPacket& packet)
+{
+    glm::vec3 c = object->hasBounds() ? object->getBoundingSphereCenter() : glm::vec3(0.0f, 0.0f, 0.0f);
+    glm::vec4 clip = _view_projection * (object->getMatrix() * glm::vec4(c.x, c.y, c.z, 1.0f));
+
+    packet.object = object;
+    packet.program = object->getProgram();
+    packet.texture = object->getTexture();
+
+    if(object->isTransparent() && _transparency_pass != NULL)
+    {
+        // order-independent, group by state behind all opaque objects
+        packet.key = MakeKey(false, packet.program, packet.texture, object->getVertexArray(), clip.w) | ((uint64_t)1 << 63);
+    }
+    else
+    {
+        packet.key = MakeKey(object->isTransparent(), packet.program, packet.texture, object->getVertexArray(), clip.w);
+    }
+}
+
+
+/*!
+ Add an object to the queue.
+ @param object - the object to draw
+ */
+void GLRenderQueue::submit(GLObject* object)
+{
+    if(object == NULL) return;
+
+    DrawPacket packet;
+    makePacket(object, packet);
+    _packets.push_back(packet);
+}
+
+
+/*!
+ Add all objects that passed the last cull() call of the culler.
+ Only packets with equal keys can change their order with the thread timing.
+ */
+void GLRenderQueue::submit(GLFrustumCuller& culler)
+{
+    GLThreadPool& pool = GLThreadPool::Get();
+
+    _thread_packets.resize(pool.numThreads());
+    for(int i=0; i<_thread_packets.size(); i++) _thread_packets[i].clear();
+
+    pool.parallelFor(culler.size(), SUBMIT_CHUNK_SIZE, [this, &culler](int start, int end, int thread_index)
+    {
+        vector<DrawPacket>& packets = _thread_packets[thread_index];
+        for(int i=start; i<end; i++)
+        {
+            if(!culler.isVisible(i)) continue;
+
+            DrawPacket packet;
+            makePacket(culler.getObject(i), packet);
+            packets.push_back(packet);
+        }
+    });
+
+    for(int i=0; i<_thread_packets.size(); i++)
+    {
+        _packets.insert(_packets.end(), _thread_packets[i].begin(), _thread_packets[i].end());
+    }
+}
+
+
+/*!
+ Sort the packets by key with a radix sort, 8 bits per pass, starting with the lowest byte.
+ Passes in which all keys have the same byte are skipped, e.g., the unused lower bits.
+ */
+void GLRenderQueue::sort(void)
+{
+    int n = (int)_packets.size();
+    if(n < 2) return;
+
+    _sort_buffer.resize(n);
+
+    DrawPacket* src = &_packets[0];
+    DrawPacket* dst = &_sort_buffer[0];
+
+    for(int shift=0; shift<64; shift+=8)
+    {
+        int count[256];
+        memset(count, 0, sizeof(count));
+
+        for(int i=0; i<n; i++)
+        {
+            count[(src[i].key >> shift) & 0xFF]++;
+        }
+
+        // all keys share this byte
+        if(count[(src[0].key >> shift) & 0xFF] == n) continue;
+
+        int offset = 0;
+        for(int i=0; i<256; i++)
+        {
+            int c = count[i];
+            count[i] = offset;
+            offset += c;
+        }
+
+        for(int i=0; i<n; i++)
+        {
+            dst[count[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+
+        DrawPacket* tmp = src; src = dst; dst = tmp;
+    }
+
+    // the result ended in the sort buffer
+    if(src != &_packets[0])
+    {
+        _packets.swap(_sort_buffer);
+    }
+}
+
+
+/*!
+ Draw all packets in sorted order. With a transparency pass, the transparent packets
+ are drawn into the pass, which is composited over the current framebuffer at the end.
+ The sky is drawn after the last opaque packet.
+ The program and the textures are only bound when they change between two packets,
+ the objects draw with GLObject::drawGeometry(). Objects with their own program
+ draw with GLObject::draw(), which leaves no program in use.
+ */
+void GLRenderQueue::execute(void)
+{
+    _num_program_changes = 0;
+    _num_texture_changes = 0;
+
+    // the program in use and the first texture that is bound, 0 if unknown
+    GLuint program = 0;
+    GLuint texture = 0;
+    bool transparent = false;
+    bool sky = _skybox == NULL;
+
+    for(int i=0; i<_packets.size(); i++)
+    {
+        DrawPacket& packet = _packets[i];
+
+        // the sky fills the pixels the opaque objects left free, the transparent objects blend over it
+        if(!sky && (packet.key >> 63) != 0)
+        {
+            _skybox->draw(_view_projection);
+            sky = true;
+            program = 0;
+        }
+
+        if(!transparent && _transparency_pass != NULL && (packet.key >> 63) != 0)
+        {
+            GLint fbo = 0;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+            _transparency_pass->begin((GLuint)fbo);
+            transparent = true;
+        }
+
+        // binding also marks the textures as used; evicted textures have the id 0 and are loaded again
+        if(packet.texture != texture || packet.texture == 0)
+        {
+            if(packet.object->bindTextures()) _num_texture_changes++;
+            texture = packet.texture;
+        }
+
+        if(packet.program != 0 && packet.program != program)
+        {
+            glUseProgram(packet.program);
+            _num_program_changes++;
+            program = packet.program;
+
+            // all objects of the group share the uniforms of the program
+            packet.object->setViewUniforms();
+        }
+
+        if(packet.program == 0 || !packet.object->drawGeometry())
+        {
+            packet.object->draw();
+            program = 0;
+        }
+    }
+
+    glUseProgram(0);
+
+    if(!sky) _skybox->draw(_view_projection);
+    if(transparent) _transparency_pass->end();
+}
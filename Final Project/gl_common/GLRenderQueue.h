@@ -0,0 +1,166 @@
+//
+//  GLRenderQueue.h
+//  HCI557_Simple_Texture
+//
+//  Collects the objects of one frame as draw packets with a 64 bit sort key
+//  and draws them sorted by state and depth.
+//
+#pragma once
+
+// stl include
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLTransparencyPass.h"
+#include "GLSkybox.h"
+#include "GLFrustumCuller.h"
+
+using namespace std;
+
+
+
+/*!
+ The sort key of a packet, from the highest to the lowest bit:
+
+ opaque:       | 0 | program 8 | texture 8 | vao 8 | depth 24      | 15 unused |
+ transparent:  | 1 | inverted depth 24     | program 8 | texture 8 | vao 8 | 15 unused |
+
+ Opaque objects come first, grouped by program, texture and vertex array and
+ front-to-back inside a group. Transparent objects follow back-to-front.
+ The ids are truncated to 8 bits. Two ids that share the lower 8 bits are sorted
+ into the same group, which only costs a state change, never a wrong image.
+
+ With a GLTransparencyPass the order of transparent objects does not matter.
+ They use the opaque layout with the top bit set, so they are grouped by state
+ like opaque objects and are drawn into the pass after all opaque objects.
+ */
+class GLRenderQueue
+{
+public:
+
+    GLRenderQueue();
+    ~GLRenderQueue();
+
+
+    /*!
+     Start a new frame. Removes all packets.
+     @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+     */
+    void begin(const glm::mat4& view_projection);
+
+
+    /*!
+     Add an object to the queue. The key is computed from the current state of the object.
+     @param object - the object to draw
+     */
+    void submit(GLObject* object);
+
+
+    /*!
+     Add all objects that passed the last cull() call of the culler. The keys are
+     computed on the threads of GLThreadPool into per-thread packet lists, which
+     are appended in thread order. Makes no GL calls.
+     @param culler - the frustum culler, after cull()
+     */
+    void submit(GLFrustumCuller& culler);
+
+
+    /*!
+     Sort the packets by key with a radix sort
+     */
+    void sort(void);
+
+
+    /*!
+     Draw all packets in sorted order
+     */
+    void execute(void);
+
+
+    /*!
+     Draw transparent objects with weighted blended order-independent transparency.
+     @param pass - the initialized pass or NULL to sort transparent objects back-to-front
+     */
+    inline void setTransparencyPass(GLTransparencyPass* pass){_transparency_pass = pass;}
+
+
+    /*!
+     Draw a sky after the opaque and before the transparent objects, only on the free pixels.
+     @param skybox - the initialized sky or NULL
+     */
+    inline void setSkybox(GLSkybox* skybox){_skybox = skybox;}
+
+
+    /*!
+     Returns the number of packets
+     */
+    inline int size(void){return (int)_packets.size();}
+
+
+    /*!
+     Returns the number of glUseProgram() and GLObject::bindTextures() calls of the
+     last execute() call, objects with their own program are not counted
+     */
+    inline int numProgramChanges(void){return _num_program_changes;}
+    inline int numTextureChanges(void){return _num_texture_changes;}
+
+
+    /*!
+     Packs a sort key. See the class description for the layout.
+     @param transparent - true if the object is blended
+     @param program, texture, vao - the OpenGL ids
+     @param depth - the distance from the camera, negative values are clamped to 0
+     */
+    static uint64_t MakeKey(bool transparent, GLuint program, GLuint texture, GLuint vao, float depth);
+
+
+private:
+
+    // One draw packet
+    typedef struct _DrawPacket
+    {
+        uint64_t        key;
+        GLObject*       object;
+        GLuint          program;
+        GLuint          texture;
+    }DrawPacket;
+
+
+    /*!
+     Fills the packet of an object. Only reads the object, safe on the worker threads.
+     */
+    void makePacket(GLObject* object, DrawPacket& packet);
+
+
+    // the packets of the current frame and a buffer for the radix sort
+    vector<DrawPacket>      _packets;
+    vector<DrawPacket>      _sort_buffer;
+
+    // the packets of every worker thread, see submit(GLFrustumCuller&)
+    vector< vector<DrawPacket> > _thread_packets;
+
+    // the matrix to compute the depth
+    glm::mat4               _view_projection;
+
+    // the pass for transparent objects, not owned
+    GLTransparencyPass*     _transparency_pass;
+
+    // the sky behind the opaque objects, not owned
+    GLSkybox*               _skybox;
+
+    // statistics of the last execute() call
+    int                     _num_program_changes;
+    int                     _num_texture_changes;
+};
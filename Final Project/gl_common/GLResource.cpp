@@ -0,0 +1,364 @@
+//
+//  GLResource.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLResource.h"
+
+#include <algorithm>
+
+
+
+GLResource::GLResource()
+{
+    _id = 0;
+    _type = BUFFER;
+    _size = 0;
+}
+
+
+GLResource::~GLResource()
+{
+    release();
+}
+
+
+GLResource::GLResource(GLResource&& other)
+{
+    _id = other._id;
+    _type = other._type;
+    _tag = other._tag;
+    _size = other._size;
+
+    other._id = 0;
+    other._size = 0;
+}
+
+
+GLResource& GLResource::operator=(GLResource&& other)
+{
+    if(this == &other) return *this;
+
+    release();
+
+    _id = other._id;
+    _type = other._type;
+    _tag = other._tag;
+    _size = other._size;
+
+    other._id = 0;
+    other._size = 0;
+
+    return *this;
+}
+
+
+/*!
+ Creates a new object, the old object is deleted
+ */
+GLuint GLResource::create(Type type, const string& tag)
+{
+    GLuint id = 0;
+
+    switch(type)
+    {
+        case BUFFER: glGenBuffers(1, &id); break;
+        case TEXTURE: glGenTextures(1, &id); break;
+        case VERTEX_ARRAY: glGenVertexArrays(1, &id); break;
+        case PROGRAM: id = glCreateProgram(); break;
+        case FRAMEBUFFER: glGenFramebuffers(1, &id); break;
+        case RENDERBUFFER: glGenRenderbuffers(1, &id); break;
+        case QUERY: glGenQueries(1, &id); break;
+        default: break;
+    }
+
+    adopt(type, id, tag);
+    return _id;
+}
+
+
+/*!
+ Takes the ownership of an existing object
+ */
+void GLResource::adopt(Type type, GLuint id, const string& tag)
+{
+    release();
+
+    if(id == 0) return;
+
+    _id = id;
+    _type = type;
+    _tag = tag;
+    _size = 0;
+
+    GLMemoryTracker::Get().add(_type, _tag, 0);
+}
+
+
+/*!
+ Set the number of bytes of the storage of the object
+ */
+void GLResource::setSize(size_t bytes)
+{
+    if(_id == 0) return;
+
+    GLMemoryTracker& tracker = GLMemoryTracker::Get();
+    tracker.remove(_type, _tag, _size);
+    tracker.add(_type, _tag, bytes);
+    _size = bytes;
+}
+
+
+/*!
+ Deletes the object
+ */
+void GLResource::release(void)
+{
+    if(_id == 0) return;
+
+    switch(_type)
+    {
+        case BUFFER: glDeleteBuffers(1, &_id); break;
+        case TEXTURE: glDeleteTextures(1, &_id); break;
+        case VERTEX_ARRAY: glDeleteVertexArrays(1, &_id); break;
+        case PROGRAM: glDeleteProgram(_id); break;
+        case FRAMEBUFFER: glDeleteFramebuffers(1, &_id); break;
+        case RENDERBUFFER: glDeleteRenderbuffers(1, &_id); break;
+        case QUERY: glDeleteQueries(1, &_id); break;
+        default: break;
+    }
+
+    GLMemoryTracker::Get().remove(_type, _tag, _size);
+
+    _id = 0;
+    _size = 0;
+}
+
+
+/*!
+ Returns the name of a type for the memory report
+ */
+const char* GLResource::TypeName(Type type)
+{
+    switch(type)
+    {
+        case BUFFER: return "buffers";
+        case TEXTURE: return "textures";
+        case VERTEX_ARRAY: return "vertex arrays";
+        case PROGRAM: return "programs";
+        case FRAMEBUFFER: return "framebuffers";
+        case RENDERBUFFER: return "renderbuffers";
+        case QUERY: return "queries";
+        default: return "unknown";
+    }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GLEvictable
+
+GLEvictable::GLEvictable()
+{
+    _last_used = 0;
+    GLMemoryTracker::Get().addEvictable(this);
+}
+
+
+GLEvictable::~GLEvictable()
+{
+    GLMemoryTracker::Get().removeEvictable(this);
+}
+
+
+/*!
+ Marks the object as used in this frame
+ */
+void GLEvictable::touch(void)
+{
+    GLMemoryTracker& tracker = GLMemoryTracker::Get();
+    std::lock_guard<std::recursive_mutex> lock(tracker._mutex);
+    _last_used = tracker._frame;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GLMemoryTracker
+
+/*!
+ Returns the tracker of this application
+ */
+GLMemoryTracker& GLMemoryTracker::Get(void)
+{
+    // never deleted on purpose, resources in static objects can be released after the
+    // static objects of this file are destroyed
+    static GLMemoryTracker* tracker = new GLMemoryTracker();
+    return *tracker;
+}
+
+
+GLMemoryTracker::GLMemoryTracker()
+{
+    for(int i=0; i<GLResource::NUM_TYPES; i++)
+    {
+        _bytes[i] = 0;
+        _count[i] = 0;
+    }
+
+    _budget = 0;
+    _frame = 0;
+    _num_evictions = 0;
+}
+
+
+/*!
+ Add a resource with its bytes
+ */
+void GLMemoryTracker::add(GLResource::Type type, const string& tag, size_t bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    _bytes[type] += bytes;
+    _count[type]++;
+    _tag_bytes[tag] += bytes;
+}
+
+
+/*!
+ Remove a resource with its bytes
+ */
+void GLMemoryTracker::remove(GLResource::Type type, const string& tag, size_t bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    _bytes[type] -= std::min(bytes, _bytes[type]);
+    _count[type]--;
+
+    map<string, size_t>::iterator itr = _tag_bytes.find(tag);
+    if(itr != _tag_bytes.end())
+    {
+        itr->second -= std::min(bytes, itr->second);
+    }
+}
+
+
+size_t GLMemoryTracker::getBytes(GLResource::Type type)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _bytes[type];
+}
+
+
+size_t GLMemoryTracker::getTagBytes(const string& tag)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    map<string, size_t>::iterator itr = _tag_bytes.find(tag);
+    if(itr == _tag_bytes.end()) return 0;
+    return itr->second;
+}
+
+
+size_t GLMemoryTracker::getTotal(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    size_t total = 0;
+    for(int i=0; i<GLResource::NUM_TYPES; i++) total += _bytes[i];
+    return total;
+}
+
+
+int GLMemoryTracker::getCount(GLResource::Type type)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _count[type];
+}
+
+
+/*!
+ Set the memory budget in bytes, 0 disables the eviction
+ */
+void GLMemoryTracker::setBudget(size_t bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    _budget = bytes;
+}
+
+
+/*!
+ Ends the frame and evicts resources if the total exceeds the budget
+ */
+void GLMemoryTracker::endFrame(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    if(_budget > 0 && getTotal() > _budget) evict();
+
+    _frame++;
+}
+
+
+/*!
+ Evicts the least recently used objects until the total is below the budget
+ */
+void GLMemoryTracker::evict(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    vector<GLEvictable*> candidates;
+    for(int i=0; i<_evictables.size(); i++)
+    {
+        GLEvictable* object = _evictables[i];
+        if(object->_last_used < _frame && object->residentBytes() > 0) candidates.push_back(object);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](GLEvictable* a, GLEvictable* b)
+    {
+        return a->_last_used < b->_last_used;
+    });
+
+    for(int i=0; i<candidates.size() && getTotal() > _budget; i++)
+    {
+        candidates[i]->evict();
+        _num_evictions++;
+    }
+}
+
+
+void GLMemoryTracker::addEvictable(GLEvictable* object)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    object->_last_used = _frame;
+    _evictables.push_back(object);
+}
+
+
+void GLMemoryTracker::removeEvictable(GLEvictable* object)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    vector<GLEvictable*>::iterator itr = std::find(_evictables.begin(), _evictables.end(), object);
+    if(itr != _evictables.end()) _evictables.erase(itr);
+}
+
+
+/*!
+ Writes the bytes per type and per tag
+ */
+void GLMemoryTracker::report(ostream& out)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    out << "[GLMemoryTracker] - " << getTotal() / 1024 << " KB";
+    if(_budget > 0) out << " of " << _budget / 1024 << " KB budget";
+    out << ", " << _num_evictions << " evictions" << endl;
+
+    for(int i=0; i<GLResource::NUM_TYPES; i++)
+    {
+        out << "    " << GLResource::TypeName((GLResource::Type)i) << ": " << _count[i] << " objects, " << _bytes[i] / 1024 << " KB" << endl;
+    }
+
+    for(map<string, size_t>::iterator itr = _tag_bytes.begin(); itr != _tag_bytes.end(); itr++)
+    {
+        if(itr->second == 0) continue;
+        out << "    " << itr->first << ": " << itr->second / 1024 << " KB" << endl;
+    }
+}
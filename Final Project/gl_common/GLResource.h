@@ -0,0 +1,258 @@
+//
+//  GLResource.h
+//  HCI557_Simple_Texture
+//
+//  Ownership and accounting of OpenGL objects. A GLResource deletes its object
+//  when it goes out of scope and reports the size of the object to the
+//  GLMemoryTracker, which keeps the bytes per type and tag and evicts the least
+//  recently used resources when the application exceeds its memory budget.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+// GLEW include
+#include <GL/glew.h>
+
+
+using namespace std;
+
+
+
+/*!
+ Owns one buffer, texture, vertex array, program, framebuffer, renderbuffer or query and
+ deletes it in the destructor. The handle can be moved but not copied, so every object has exactly
+ one owner.
+
+ The size is not known to OpenGL, the owner sets it with setSize() after glBufferData,
+ glTexImage2D or glRenderbufferStorage. Size and tag are reported to GLMemoryTracker::Get().
+ A resource counts towards the budget but is only evicted if its owner is a GLEvictable,
+ render targets and stream buffers cannot be restored and are never evicted.
+ */
+class GLResource
+{
+public:
+
+    typedef enum _Type
+    {
+        BUFFER = 0,
+        TEXTURE,
+        VERTEX_ARRAY,
+        PROGRAM,
+        FRAMEBUFFER,
+        RENDERBUFFER,
+        QUERY,
+        NUM_TYPES
+    }Type;
+
+
+    GLResource();
+    ~GLResource();
+
+    GLResource(GLResource&& other);
+    GLResource& operator=(GLResource&& other);
+
+    GLResource(const GLResource&) = delete;
+    GLResource& operator=(const GLResource&) = delete;
+
+
+    /*!
+     Creates a new object, the old object is deleted
+     @param type - the type of the object
+     @param tag - a name for the memory report, e.g. the file of a texture
+     @return the id of the object
+     */
+    GLuint create(Type type, const string& tag);
+
+
+    /*!
+     Takes the ownership of an existing object, e.g. a program from LoadAndCreateShaderProgram()
+     */
+    void adopt(Type type, GLuint id, const string& tag);
+
+
+    /*!
+     Set the number of bytes of the storage of the object
+     */
+    void setSize(size_t bytes);
+
+
+    /*!
+     Deletes the object
+     */
+    void release(void);
+
+
+    inline GLuint id(void) const {return _id;}
+    inline size_t size(void) const {return _size;}
+    inline Type type(void) const {return _type;}
+    inline const string& tag(void) const {return _tag;}
+    inline bool isValid(void) const {return _id != 0;}
+
+
+    /*!
+     Returns the name of a type for the memory report
+     */
+    static const char* TypeName(Type type);
+
+
+private:
+
+    GLuint      _id;
+    Type        _type;
+    string      _tag;
+    size_t      _size;
+};
+
+
+
+
+/*!
+ An object that can give up its GPU memory when the budget is exceeded and
+ restore it the next time it is used, e.g. a texture that reloads its file.
+ */
+class GLEvictable
+{
+public:
+
+    GLEvictable();
+    virtual ~GLEvictable();
+
+
+    /*!
+     Returns the number of bytes the object holds on the GPU, 0 if it is evicted
+     */
+    virtual size_t residentBytes(void) = 0;
+
+
+    /*!
+     Releases the GPU memory of the object
+     */
+    virtual void evict(void) = 0;
+
+
+protected:
+
+    /*!
+     Marks the object as used in this frame. Call this when the object is bound.
+     */
+    void touch(void);
+
+
+private:
+
+    friend class GLMemoryTracker;
+
+    // the frame of the last touch() call
+    unsigned int    _last_used;
+};
+
+
+
+
+/*!
+ Counts the bytes of all GLResource objects per type and per tag.
+
+ With a budget, endFrame() evicts the least recently used GLEvictable objects until
+ the total is below the budget. Objects that were used in the current frame are
+ never evicted, so the budget can be exceeded if the frame needs more memory.
+
+ All methods can be called from any thread. The tracker is never destroyed, so
+ resources in static objects can still report to it at exit.
+ */
+class GLMemoryTracker
+{
+public:
+
+    /*!
+     Returns the tracker of this application
+     */
+    static GLMemoryTracker& Get(void);
+
+
+    /*!
+     Add or remove a resource with its bytes, called by GLResource
+     */
+    void add(GLResource::Type type, const string& tag, size_t bytes);
+    void remove(GLResource::Type type, const string& tag, size_t bytes);
+
+
+    /*!
+     Returns the bytes of one type, of one tag, or of all resources
+     */
+    size_t getBytes(GLResource::Type type);
+    size_t getTagBytes(const string& tag);
+    size_t getTotal(void);
+
+
+    /*!
+     Returns the number of objects of one type
+     */
+    int getCount(GLResource::Type type);
+
+
+    /*!
+     Set the memory budget in bytes, 0 disables the eviction
+     */
+    void setBudget(size_t bytes);
+    inline size_t getBudget(void){return _budget;}
+
+
+    /*!
+     Ends the frame and evicts resources if the total exceeds the budget.
+     Call this once per frame after all draws.
+     */
+    void endFrame(void);
+
+
+    /*!
+     Returns the number of evictions since the start
+     */
+    inline int numEvictions(void){return _num_evictions;}
+
+
+    /*!
+     Writes the bytes per type and per tag
+     */
+    void report(ostream& out);
+
+
+private:
+
+    friend class GLEvictable;
+
+    GLMemoryTracker();
+
+
+    /*!
+     Register an evictable object, called by GLEvictable
+     */
+    void addEvictable(GLEvictable* object);
+    void removeEvictable(GLEvictable* object);
+
+
+    /*!
+     Evicts the least recently used objects until the total is below the budget
+     */
+    void evict(void);
+
+
+    size_t                  _bytes[GLResource::NUM_TYPES];
+    int                     _count[GLResource::NUM_TYPES];
+    map<string, size_t>     _tag_bytes;
+
+    vector<GLEvictable*>    _evictables;
+
+    size_t                  _budget;
+    unsigned int            _frame;
+    int                     _num_evictions;
+
+    // guards all members, resources are created and deleted by the loader thread too.
+    // recursive since evict() deletes resources, which calls remove()
+    std::recursive_mutex    _mutex;
+};
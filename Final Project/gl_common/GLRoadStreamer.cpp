@@ -0,0 +1,246 @@
+//
+//  GLRoadStreamer.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLRoadStreamer.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+
+
+// free obstacles wait here, far below the road
+static const float PARK_DEPTH = -1000.0f;
+
+
+
+GLRoadStreamer::GLRoadStreamer(const glm::vec3& start, const glm::vec3& direction, float tile_length)
+{
+    _start = start;
+    _direction = glm::normalize(direction);
+    _side = glm::normalize(glm::cross(_direction, glm::vec3(0.0f, 1.0f, 0.0f)));
+    _tile_length = tile_length;
+
+    _lanes.push_back(-20.0f);
+    _lanes.push_back(-10.0f);
+    _lanes.push_back(0.0f);
+    _lanes.push_back(10.0f);
+    _lanes.push_back(20.0f);
+    _obstacles_per_tile = 2;
+
+    _rear = 0;
+    _front_distance = 0.0f;
+    _random = 1;
+    _num_recycled = 0;
+    _bounds_dirty = true;
+}
+
+
+GLRoadStreamer::~GLRoadStreamer()
+{
+    // the tiles and nodes belong to the application
+}
+
+
+/*!
+ Add a road tile. The object must not be a part of the scene graph.
+ */
+int GLRoadStreamer::addTile(GLObject* tile)
+{
+    Tile t;
+    t.object = tile;
+    t.base = tile->getMatrix();
+    t.distance = 0.0f;
+
+    _tiles.push_back(t);
+    return (int)_tiles.size() - 1;
+}
+
+
+/*!
+ Add an obstacle to the pool
+ */
+int GLRoadStreamer::addObstacle(GLSceneNode* node)
+{
+    Obstacle o;
+    o.node = node;
+    o.base = node->getMatrix();
+    o.distance = 0.0f;
+    o.active = false;
+
+    _obstacles.push_back(o);
+    return (int)_obstacles.size() - 1;
+}
+
+
+/*!
+ Set the lanes as distances from the center line
+ */
+void GLRoadStreamer::setLanes(const vector<float>& lanes)
+{
+    if(lanes.size() == 0 || lanes.size() > 32)
+    {
+        cerr << "[GLRoadStreamer] - Use 1 to 32 lanes." << endl;
+        return;
+    }
+    _lanes = lanes;
+}
+
+
+/*!
+ Places the tiles and fills all tiles ahead of the start with obstacles
+ */
+void GLRoadStreamer::init(unsigned int seed)
+{
+    if(_tiles.size() < 3)
+    {
+        cerr << "[GLRoadStreamer] - The road needs 3 tiles or more, it has " << _tiles.size() << "." << endl;
+    }
+
+    // xorshift does not work with 0
+    _random = seed == 0 ? 1 : seed;
+    _num_recycled = 0;
+    _bounds_dirty = true;
+
+    // all obstacles go into the pool, the list never grows beyond this
+    _free.clear();
+    _free.reserve(_obstacles.size());
+    for(int i=(int)_obstacles.size() - 1; i>=0; i--)
+    {
+        Obstacle& o = _obstacles[i];
+        o.active = false;
+        o.node->setMatrix(glm::translate(glm::vec3(0.0f, PARK_DEPTH, 0.0f)) * o.base);
+        _free.push_back(i);
+    }
+
+    // one tile behind the start, the car starts on tile 1
+    _rear = 0;
+    for(int i=0; i<(int)_tiles.size(); i++)
+    {
+        placeTile(_tiles[i], (i - 1) * _tile_length);
+    }
+    _front_distance = ((int)_tiles.size() - 2) * _tile_length;
+
+    // the tile of the car stays free
+    for(int i=2; i<(int)_tiles.size(); i++)
+    {
+        spawnObstacles(_tiles[i].distance);
+    }
+}
+
+
+/*!
+ Recycles the tiles and obstacles behind the car
+ */
+bool GLRoadStreamer::update(const glm::vec3& position)
+{
+    GL_PROFILE_ZONE("GLRoadStreamer::update");
+
+    if(_tiles.size() == 0) return false;
+
+    float distance = getDistance(position);
+    bool moved = false;
+
+    // obstacles behind the car go back into the pool first, the new tile can use them
+    for(int i=0; i<(int)_obstacles.size(); i++)
+    {
+        Obstacle& o = _obstacles[i];
+        if(!o.active || o.distance > distance - _tile_length) continue;
+
+        o.active = false;
+        o.node->setMatrix(glm::translate(glm::vec3(0.0f, PARK_DEPTH, 0.0f)) * o.base);
+        _free.push_back(i);
+        moved = true;
+    }
+
+    // the far edge of the rear tile is more than one tile behind the car
+    while(_tiles[_rear].distance + _tile_length * 0.5f < distance - _tile_length)
+    {
+        _front_distance += _tile_length;
+        placeTile(_tiles[_rear], _front_distance);
+        spawnObstacles(_front_distance);
+
+        _rear = (_rear + 1) % (int)_tiles.size();
+        _num_recycled++;
+        moved = true;
+    }
+
+    if(moved) _bounds_dirty = true;
+    return moved;
+}
+
+
+/*!
+ Rebuilds the bounds of the instanced meshes of the obstacles from the active obstacles.
+ Parked obstacles lie far below the road and recycled ones far ahead, the union of all
+ instances would never leave the view.
+ */
+void GLRoadStreamer::updateBounds(void)
+{
+    if(!_bounds_dirty) return;
+    _bounds_dirty = false;
+
+    for(int i=0; i<(int)_obstacles.size(); i++)
+    {
+        GLInstancedMesh* mesh = _obstacles[i].node->getInstancedMesh();
+        if(mesh != NULL) mesh->resetBounds();
+    }
+
+    for(int i=0; i<(int)_obstacles.size(); i++)
+    {
+        GLSceneNode* node = _obstacles[i].node;
+        if(_obstacles[i].active && node->getInstancedMesh() != NULL)
+        {
+            node->getInstancedMesh()->extendBounds(node->getWorldMatrix());
+        }
+    }
+}
+
+
+/*!
+ Moves a tile to a distance along the road
+ */
+void GLRoadStreamer::placeTile(Tile& tile, float distance)
+{
+    tile.distance = distance;
+    tile.object->setMatrix(glm::translate(_start + _direction * distance) * tile.base);
+}
+
+
+/*!
+ Places obstacles from the pool on the tile with the center at distance
+ */
+void GLRoadStreamer::spawnObstacles(float distance)
+{
+    int count = std::min(_obstacles_per_tile, (int)_lanes.size());
+    unsigned int used = 0; // one bit per lane, one obstacle per lane and tile
+
+    for(int i=0; i<count && _free.size() > 0; i++)
+    {
+        int lane = (int)(random() * _lanes.size());
+        while(used & (1u << lane)) lane = (lane + 1) % (int)_lanes.size();
+        used |= 1u << lane;
+
+        // not too close to the tile edges, the next tile has its own obstacles
+        float d = distance + (random() - 0.5f) * _tile_length * 0.8f;
+
+        Obstacle& o = _obstacles[_free.back()];
+        _free.pop_back();
+
+        o.active = true;
+        o.distance = d;
+        o.node->setMatrix(glm::translate(_start + _direction * d + _side * _lanes[lane]) * o.base);
+    }
+}
+
+
+/*!
+ Returns a random number in [0, 1), xorshift
+ */
+float GLRoadStreamer::random(void)
+{
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return (_random >> 8) / 16777216.0f;
+}
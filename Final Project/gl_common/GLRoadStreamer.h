@@ -0,0 +1,193 @@
+//
+//  GLRoadStreamer.h
+//  HCI557_Simple_Texture
+//
+//  An endless road from a fixed set of road tiles and obstacles. Tiles behind
+//  the car are moved to the front of the road and obstacles behind the car
+//  are placed on the new tile, so the memory does not grow with the distance.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLSceneGraph.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The road starts at a point and runs along a direction. The tiles form a ring: tile
+ i of the ring lies (i - 1) tile lengths ahead of the start, so one tile is behind
+ the start. update() moves the last tile to the front once it lies more than one
+ tile length behind the car.
+
+ Obstacles are scene nodes, e.g. nodes attached to the instances of a GLInstancedMesh.
+ A new tile gets obstacles from the pool of free obstacles on random lanes. Obstacles
+ more than one tile length behind the car go back into the pool. A free obstacle is
+ parked below the road and isObstacleActive() returns false, the application hides it.
+
+ The current matrices of tiles and nodes when they are added are their placement at the
+ start, e.g. the rotation of a GLPlane3D. update() places them with a translation in front.
+ No memory is allocated after init().
+
+ If the obstacle nodes are attached to the instances of a GLInstancedMesh, updateBounds()
+ keeps the bounds of the mesh around the active obstacles.
+ */
+class GLRoadStreamer
+{
+public:
+
+    /*!
+     @param start - the center of the tile the car starts on
+     @param direction - the direction of the road
+     @param tile_length - the length of one tile along the direction
+     */
+    GLRoadStreamer(const glm::vec3& start, const glm::vec3& direction, float tile_length);
+    ~GLRoadStreamer();
+
+
+    /*!
+     Add a road tile. The object must not be a part of the scene graph.
+     @return the index of the tile
+     */
+    int addTile(GLObject* tile);
+
+
+    /*!
+     Add an obstacle to the pool
+     @return the index of the obstacle
+     */
+    int addObstacle(GLSceneNode* node);
+
+
+    /*!
+     Set the lanes as distances from the center line, right of the direction is positive.
+     Default: -20, -10, 0, 10, 20
+     */
+    void setLanes(const vector<float>& lanes);
+
+
+    /*!
+     Set the number of obstacles a new tile gets, default 2
+     */
+    inline void setObstaclesPerTile(int count){_obstacles_per_tile = count;}
+
+
+    /*!
+     Places the tiles and fills all tiles ahead of the start with obstacles
+     @param seed - the seed of the obstacle placement
+     */
+    void init(unsigned int seed = 1);
+
+
+    /*!
+     Recycles the tiles and obstacles behind the car. Call this once per frame.
+     @param position - the position of the car
+     @return true if a tile or an obstacle moved
+     */
+    bool update(const glm::vec3& position);
+
+
+    /*!
+     Rebuilds the bounds of the instanced meshes of the obstacles from the active obstacles,
+     if an obstacle moved since the last call. Call this after GLSceneGraph::update(), it
+     reads the world matrices of the nodes.
+     */
+    void updateBounds(void);
+
+
+    /*!
+     Returns the distance of a point along the road from the start
+     */
+    inline float getDistance(const glm::vec3& position){return glm::dot(position - _start, _direction);}
+
+
+    /*!
+     Returns true if the obstacle is placed on the road
+     */
+    inline bool isObstacleActive(int index){return _obstacles[index].active;}
+
+
+    inline int numTiles(void){return (int)_tiles.size();}
+    inline int numObstacles(void){return (int)_obstacles.size();}
+    inline int numActiveObstacles(void){return (int)_obstacles.size() - (int)_free.size();}
+
+
+    /*!
+     Returns the number of tiles that moved to the front since init()
+     */
+    inline int numRecycled(void){return _num_recycled;}
+
+
+private:
+
+    typedef struct _Tile
+    {
+        GLObject*       object;
+        glm::mat4       base;
+        float           distance; // of the center along the road
+    }Tile;
+
+
+    typedef struct _Obstacle
+    {
+        GLSceneNode*    node;
+        glm::mat4       base;
+        float           distance;
+        bool            active;
+    }Obstacle;
+
+
+    /*!
+     Moves a tile to a distance along the road
+     */
+    void placeTile(Tile& tile, float distance);
+
+
+    /*!
+     Places obstacles from the pool on the tile with the center at distance
+     */
+    void spawnObstacles(float distance);
+
+
+    /*!
+     Returns a random number in [0, 1)
+     */
+    float random(void);
+
+
+    glm::vec3               _start;
+    glm::vec3               _direction;
+    glm::vec3               _side;
+    float                   _tile_length;
+
+    vector<float>           _lanes;
+    int                     _obstacles_per_tile;
+
+    // the ring of tiles, _rear is the tile furthest behind
+    vector<Tile>            _tiles;
+    int                     _rear;
+    float                   _front_distance;
+
+    vector<Obstacle>        _obstacles;
+    vector<int>             _free;
+
+    // an obstacle moved, the bounds of the meshes are out of date
+    bool                    _bounds_dirty;
+
+    unsigned int            _random;
+    int                     _num_recycled;
+};
@@ -0,0 +1,241 @@
+//
+//  GLSceneGraph.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLSceneGraph.h"
+
+#include <algorithm>
+
+
+
+GLSceneNode::GLSceneNode(GLSceneGraph* graph, GLSceneNode* parent):
+    _graph(graph), _parent(parent)
+{
+    _depth = 0;
+    if(_parent != NULL)
+    {
+        _depth = _parent->_depth + 1;
+        _parent->_children.push_back(this);
+    }
+
+    _local = glm::mat4(1.0f);
+    _world = glm::mat4(1.0f);
+
+    _dirty = true;
+    _changed_frame = -1;
+    _index = -1;
+    _object = NULL;
+    _instanced_mesh = NULL;
+    _instance = -1;
+}
+
+
+GLSceneNode::~GLSceneNode()
+{
+
+}
+
+
+/*!
+ Set the local matrix of this node, relative to its parent.
+ This marks the node and its subtree dirty.
+ @param matrix - the local transformation
+ */
+void GLSceneNode::setMatrix(const glm::mat4& matrix)
+{
+    _local = matrix;
+
+    if(!_dirty)
+    {
+        _dirty = true;
+        _graph->markDirty(this);
+    }
+}
+
+
+/*!
+ Attach an object to this node. The world matrix of the node is
+ written into the object every time it changes.
+ @param object - the object to move with this node, or NULL
+ */
+void GLSceneNode::attach(GLObject* object)
+{
+    _object = object;
+
+    // the object needs the current world matrix
+    if(!_dirty)
+    {
+        _dirty = true;
+        _graph->markDirty(this);
+    }
+}
+
+
+/*!
+ Attach one instance of an instanced mesh to this node. The world matrix
+ of the node becomes the matrix of the instance.
+ @param mesh - the instanced mesh
+ @param instance - the index of the instance, see GLInstancedMesh::addInstance
+ */
+void GLSceneNode::attach(GLInstancedMesh* mesh, int instance)
+{
+    _instanced_mesh = mesh;
+    _instance = instance;
+
+    if(!_dirty)
+    {
+        _dirty = true;
+        _graph->markDirty(this);
+    }
+}
+
+
+/*!
+ Returns true if the world matrix changed during the last update
+ */
+bool GLSceneNode::changed(void)
+{
+    return _changed_frame == _graph->_frame;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GLSceneGraph
+
+
+GLSceneGraph::GLSceneGraph()
+{
+    _frame = 0;
+    _num_updated = 0;
+
+    _root = new GLSceneNode(this, NULL);
+    _root->_index = 0;
+    _order.push_back(_root);
+
+    _order_dirty = false;
+    _first_dirty = 0;
+}
+
+
+GLSceneGraph::~GLSceneGraph()
+{
+    for(int i=0; i<_order.size(); i++)
+    {
+        delete _order[i];
+    }
+    _order.clear();
+}
+
+
+/*!
+ Create a new node.
+ @param parent - the parent node. NULL adds the node to the root node.
+ @param object - an object that moves with this node, or NULL
+ @return the new node. The graph owns the node.
+ */
+GLSceneNode* GLSceneGraph::createNode(GLSceneNode* parent, GLObject* object)
+{
+    if(parent == NULL) parent = _root;
+
+    if(parent->_graph != this)
+    {
+        cerr << "[GLSceneGraph] - The parent node belongs to a different scene graph." << endl;
+        return NULL;
+    }
+
+    GLSceneNode* node = new GLSceneNode(this, parent);
+    node->_object = object;
+
+    // new nodes are dirty; the array is sorted again at the next update
+    _order.push_back(node);
+    _order_dirty = true;
+
+    return node;
+}
+
+
+/*!
+ Marks a node dirty. Called by GLSceneNode::setMatrix
+ */
+void GLSceneGraph::markDirty(GLSceneNode* node)
+{
+    // the array is sorted at the next update anyway, which resets _first_dirty
+    if(_order_dirty) return;
+
+    if(_first_dirty == -1 || node->_index < _first_dirty)
+    {
+        _first_dirty = node->_index;
+    }
+}
+
+
+static bool CompareNodeDepth(GLSceneNode* a, GLSceneNode* b)
+{
+    return a->depth() < b->depth();
+}
+
+
+/*!
+ Sorts the flat update array by depth. Called after new nodes were added.
+ */
+void GLSceneGraph::sortByDepth(void)
+{
+    // stable, so siblings keep the order in which they were created
+    std::stable_sort(_order.begin(), _order.end(), CompareNodeDepth);
+
+    for(int i=0; i<_order.size(); i++)
+    {
+        _order[i]->_index = i;
+    }
+
+    _order_dirty = false;
+    _first_dirty = 0;
+}
+
+
+/*!
+ Recompute the world matrices of all dirty nodes and their subtrees
+ and write them into the attached objects.
+ */
+void GLSceneGraph::update(void)
+{
+    _frame++;
+    _num_updated = 0;
+
+    if(_order_dirty) sortByDepth();
+
+    // nothing moved since the last frame
+    if(_first_dirty == -1) return;
+
+    // Nodes in front of the first dirty node cannot be affected,
+    // their ancestors have a smaller depth and were not changed either.
+    for(int i=_first_dirty; i<_order.size(); i++)
+    {
+        GLSceneNode* node = _order[i];
+
+        bool parent_changed = (node->_parent != NULL && node->_parent->_changed_frame == _frame);
+        if(!node->_dirty && !parent_changed) continue;
+
+        if(node->_parent != NULL)
+            node->_world = node->_parent->_world * node->_local;
+        else
+            node->_world = node->_local;
+
+        node->_dirty = false;
+        node->_changed_frame = _frame;
+        _num_updated++;
+
+        if(node->_object != NULL)
+        {
+            node->_object->setMatrix(node->_world);
+        }
+
+        if(node->_instanced_mesh != NULL)
+        {
+            node->_instanced_mesh->setInstanceMatrix(node->_instance, node->_world);
+        }
+    }
+
+    _first_dirty = -1;
+}
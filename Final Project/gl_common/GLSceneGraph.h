@@ -0,0 +1,218 @@
+//
+//  GLSceneGraph.h
+//  HCI557_Simple_Texture
+//
+//  A small transformation hierarchy. Each node keeps a local matrix,
+//  a cached world matrix, and optionally the GLObject it moves.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLInstancedMesh.h"
+
+using namespace std;
+
+
+class GLSceneGraph;
+
+
+/*!
+ One node of the scene graph.
+ Nodes are created and owned by a GLSceneGraph. The world matrix of a node is
+ parent world matrix * local matrix and is only recomputed when the node
+ or one of its ancestors was marked dirty.
+ */
+class GLSceneNode
+{
+    // The graph creates the nodes and updates the cached matrices
+    friend class GLSceneGraph;
+
+public:
+
+    /*!
+     Set the local matrix of this node, relative to its parent.
+     This marks the node and its subtree dirty.
+     @param matrix - the local transformation
+     */
+    void setMatrix(const glm::mat4& matrix);
+
+    /*!
+     Returns the local matrix of this node
+     */
+    inline const glm::mat4& getMatrix(void){return _local;}
+
+    /*!
+     Returns the cached world matrix. The value is valid after GLSceneGraph::update()
+     */
+    inline const glm::mat4& getWorldMatrix(void){return _world;}
+
+    /*!
+     Attach an object to this node. The world matrix of the node is
+     written into the object every time it changes.
+     @param object - the object to move with this node, or NULL
+     */
+    void attach(GLObject* object);
+
+    /*!
+     Attach one instance of an instanced mesh to this node. The world matrix
+     of the node becomes the matrix of the instance.
+     @param mesh - the instanced mesh
+     @param instance - the index of the instance, see GLInstancedMesh::addInstance
+     */
+    void attach(GLInstancedMesh* mesh, int instance);
+
+    /*!
+     Returns the instanced mesh of the attached instance or NULL
+     */
+    inline GLInstancedMesh* getInstancedMesh(void){return _instanced_mesh;}
+
+    /*!
+     Returns the parent node or NULL if this is the root node
+     */
+    inline GLSceneNode* getParent(void){return _parent;}
+
+    /*!
+     Returns the number of ancestors of this node. The root has depth 0.
+     */
+    inline int depth(void){return _depth;}
+
+    /*!
+     Returns true if the world matrix changed during the last update
+     */
+    bool changed(void);
+
+private:
+
+    GLSceneNode(GLSceneGraph* graph, GLSceneNode* parent);
+    ~GLSceneNode();
+
+
+    // the graph that owns this node
+    GLSceneGraph*           _graph;
+
+    // the hierarchy
+    GLSceneNode*            _parent;
+    vector<GLSceneNode*>    _children;
+    int                     _depth;
+
+    // the local matrix and the cached world matrix
+    glm::mat4               _local;
+    glm::mat4               _world;
+
+    // true if the local matrix was changed since the last update
+    bool                    _dirty;
+
+    // the update in which the world matrix was recomputed the last time
+    int                     _changed_frame;
+
+    // the position of this node in the flat update array
+    int                     _index;
+
+    // the object that follows this node
+    GLObject*               _object;
+
+    // or the instance that follows this node
+    GLInstancedMesh*        _instanced_mesh;
+    int                     _instance;
+};
+
+
+
+/*!
+ The scene graph.
+ It keeps all nodes in a flat array that is sorted by depth, so parents are
+ always processed before their children. update() starts at the first dirty
+ node and recomputes only the world matrices of dirty subtrees.
+ A frame without any changed node costs nothing.
+ */
+class GLSceneGraph
+{
+    // nodes report when they become dirty
+    friend class GLSceneNode;
+
+public:
+
+    GLSceneGraph();
+    ~GLSceneGraph();
+
+
+    /*!
+     Returns the root node. The root node has an identity matrix by default.
+     */
+    inline GLSceneNode* getRoot(void){return _root;}
+
+
+    /*!
+     Create a new node.
+     @param parent - the parent node. NULL adds the node to the root node.
+     @param object - an object that moves with this node, or NULL
+     @return the new node. The graph owns the node.
+     */
+    GLSceneNode* createNode(GLSceneNode* parent = NULL, GLObject* object = NULL);
+
+
+    /*!
+     Recompute the world matrices of all dirty nodes and their subtrees
+     and write them into the attached objects.
+     Call this once per frame before the objects are drawn.
+     */
+    void update(void);
+
+
+    /*!
+     Returns the number of nodes including the root
+     */
+    inline int size(void){return (int)_order.size();}
+
+
+    /*!
+     Returns the number of world matrices recomputed during the last update.
+     */
+    inline int numUpdated(void){return _num_updated;}
+
+
+private:
+
+    /*!
+     Marks a node dirty. Called by GLSceneNode::setMatrix
+     */
+    void markDirty(GLSceneNode* node);
+
+    /*!
+     Sorts the flat update array by depth. Called after new nodes were added.
+     */
+    void sortByDepth(void);
+
+
+    // the root node
+    GLSceneNode*            _root;
+
+    // all nodes, sorted by depth. The graph owns the nodes.
+    vector<GLSceneNode*>    _order;
+
+    // true if new nodes were added and the array must be sorted
+    bool                    _order_dirty;
+
+    // the smallest index of a dirty node in _order, -1 if no node is dirty
+    int                     _first_dirty;
+
+    // the number of world matrices recomputed during the last update
+    int                     _num_updated;
+
+    // counts the calls of update()
+    int                     _frame;
+};
@@ -0,0 +1,492 @@
+//
+//  GLShadowMap.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLShadowMap.h"
+#include "Shaders.h"
+#include "GLProfiler.h"
+
+#include <math.h>
+
+
+// Depth only, the fragment shader writes nothing
+static const string depth_vs =
+"#version 330 core                                                  \n"
+"uniform mat4 lightMatrix;                                          \n"
+"uniform mat4 modelMatrix;                                          \n"
+"in vec3 in_Position;                                               \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    gl_Position = lightMatrix * modelMatrix * vec4(in_Position, 1.0); \n"
+"}                                                                  \n";
+
+static const string depth_fs =
+"#version 330 core                                                  \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"}                                                                  \n";
+
+
+// Maps the clip space [-1, 1] to the texture space [0, 1]
+static const glm::mat4 bias_matrix(0.5f, 0.0f, 0.0f, 0.0f,
+                                   0.0f, 0.5f, 0.0f, 0.0f,
+                                   0.0f, 0.0f, 0.5f, 0.0f,
+                                   0.5f, 0.5f, 0.5f, 1.0f);
+
+
+/*!
+ Returns true if the two matrices differ
+ */
+static bool MatrixChanged(const glm::mat4& a, const glm::mat4& b)
+{
+    for(int i=0; i<4; i++)
+        for(int j=0; j<4; j++)
+            if(a[i][j] != b[i][j]) return true;
+    return false;
+}
+
+
+
+GLShadowMap::GLShadowMap(int static_size, int dynamic_size)
+{
+    ShadowLayer* layers[2] = { &_static_layer, &_dynamic_layer };
+    for(int i=0; i<2; i++)
+    {
+        layers[i]->matrix = glm::mat4(1.0f);
+    }
+    _static_layer.size = static_size;
+    _dynamic_layer.size = dynamic_size;
+
+    _light_matrix = glm::mat4(1.0f);
+    _near = 1.0f;
+    _far = 1000.0f;
+
+    _buffers_dirty = true;
+
+    _lightMatrixLocation = -1;
+    _modelMatrixLocation = -1;
+
+    _static_dirty = true;
+    _static_updated = false;
+    _dynamic_visible = false;
+    _num_static_updates = 0;
+}
+
+
+GLShadowMap::~GLShadowMap()
+{
+}
+
+
+/*!
+ Create the depth maps and the depth program
+ */
+bool GLShadowMap::init(void)
+{
+    if(!createLayer(_static_layer, _static_layer.size)) return false;
+    if(!createLayer(_dynamic_layer, _dynamic_layer.size)) return false;
+
+    GLuint program = CreateShaderProgram(depth_vs, depth_fs);
+    if(program == 0)
+    {
+        cerr << "[GLShadowMap] - Cannot create the depth program." << endl;
+        return false;
+    }
+    _program.adopt(GLResource::PROGRAM, program, "GLShadowMap");
+
+    _lightMatrixLocation = glGetUniformLocation(program, "lightMatrix");
+    _modelMatrixLocation = glGetUniformLocation(program, "modelMatrix");
+
+    return true;
+}
+
+
+/*!
+ Create the depth texture and the framebuffer of a layer. The texture compares
+ the depth in hardware, linear filtering gives 2 x 2 percentage-closer filtering.
+ */
+bool GLShadowMap::createLayer(ShadowLayer& layer, int size)
+{
+    layer.size = size;
+
+    layer.texture.create(GLResource::TEXTURE, "GLShadowMap");
+    glBindTexture(GL_TEXTURE_2D, layer.texture.id());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    layer.texture.setSize((size_t)size * size * 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    // everything outside of the map is lit
+    static const GLfloat border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint last_fbo = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &last_fbo);
+
+    layer.fbo.create(GLResource::FRAMEBUFFER, "GLShadowMap");
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo.id());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, layer.texture.id(), 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, last_fbo);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        cerr << "[GLShadowMap] - The depth framebuffer is not complete, status " << status << "." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+ Sets a new light matrix, invalidates the static layer if it changed
+ */
+void GLShadowMap::setLightMatrix(const glm::mat4& matrix)
+{
+    if(!MatrixChanged(matrix, _light_matrix)) return;
+
+    _light_matrix = matrix;
+    _static_layer.matrix = matrix;
+    _static_dirty = true;
+}
+
+
+/*!
+ Set the light. The frustum opens with twice the cone angle.
+ */
+void GLShadowMap::setSpotLight(const GLSpotLightSource& light)
+{
+    glm::vec3 eye(light._lightPos.x, light._lightPos.y, light._lightPos.z);
+    glm::vec3 dir = glm::normalize(light._cone_direction);
+    glm::vec3 up = fabs(dir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    float angle = glm::min(2.0f * light._cone_angle, 170.0f);
+
+    glm::mat4 view = glm::lookAt(eye, eye + dir, up);
+    glm::mat4 projection = glm::perspective(glm::radians(angle), 1.0f, _near, _far);
+
+    setLightMatrix(projection * view);
+}
+
+
+/*!
+ Set a directional light with an orthographic frustum around the sphere
+ */
+void GLShadowMap::setDirectionalLight(const GLDirectLightSource& light, const glm::vec3& center, float radius)
+{
+    glm::vec3 dir = glm::normalize(glm::vec3(light._lightPos.x, light._lightPos.y, light._lightPos.z));
+    glm::vec3 up = fabs(dir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    glm::mat4 view = glm::lookAt(center + dir * radius, center, up);
+    glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+
+    setLightMatrix(projection * view);
+}
+
+
+/*!
+ Set the near and far distance of the spotlight frustum. Call setSpotLight() afterwards.
+ */
+void GLShadowMap::setRange(float near_distance, float far_distance)
+{
+    _near = near_distance;
+    _far = far_distance;
+}
+
+
+/*!
+ Add an object as shadow caster
+ */
+int GLShadowMap::addCaster(GLObject* object, bool is_static)
+{
+    vector<Vertex> points;
+    vector<Vertex> normals;
+    vector<GLuint> indices;
+
+    if(object == NULL || !object->getTriangles(points, normals, indices) || indices.size() == 0)
+    {
+        cerr << "[GLShadowMap] - The object does not provide triangles and cannot cast shadows." << endl;
+        return -1;
+    }
+
+    int index = addCaster(points, indices, object->getMatrix(), is_static);
+    _casters[index].object = object;
+
+    return index;
+}
+
+
+/*!
+ Add a mesh as shadow caster
+ */
+int GLShadowMap::addCaster(vector<Vertex>& points, vector<GLuint>& indices, const glm::mat4& matrix, bool is_static)
+{
+    Caster caster;
+    caster.base_vertex = (GLint)(_points.size() / 3);
+    caster.first_index = (GLuint)_indices.size();
+    caster.count = (GLsizei)indices.size();
+    caster.matrix = matrix;
+    caster.object = NULL;
+    caster.is_static = is_static;
+    caster.enabled = true;
+
+    caster.bmin = caster.bmax = glm::vec3(points[0].x(), points[0].y(), points[0].z());
+    for(int i=0; i<points.size(); i++)
+    {
+        glm::vec3 p(points[i].x(), points[i].y(), points[i].z());
+        caster.bmin = glm::min(caster.bmin, p);
+        caster.bmax = glm::max(caster.bmax, p);
+
+        _points.push_back(p.x);
+        _points.push_back(p.y);
+        _points.push_back(p.z);
+    }
+    _indices.insert(_indices.end(), indices.begin(), indices.end());
+
+    _casters.push_back(caster);
+    _buffers_dirty = true;
+    if(is_static) _static_dirty = true;
+
+    return (int)_casters.size() - 1;
+}
+
+
+/*!
+ Set the model matrix of a caster
+ */
+void GLShadowMap::setCasterMatrix(int index, const glm::mat4& matrix)
+{
+    Caster& caster = _casters[index];
+    if(!MatrixChanged(matrix, caster.matrix)) return;
+
+    caster.matrix = matrix;
+    if(caster.is_static && caster.enabled) _static_dirty = true;
+}
+
+
+/*!
+ Enable or disable a caster
+ */
+void GLShadowMap::setCasterEnabled(int index, bool enabled)
+{
+    Caster& caster = _casters[index];
+    if(caster.enabled == enabled) return;
+
+    caster.enabled = enabled;
+    if(caster.is_static) _static_dirty = true;
+}
+
+
+/*!
+ Copies the caster meshes into the vertex buffer
+ */
+void GLShadowMap::createBuffers(void)
+{
+    if(!_vao.isValid())
+    {
+        _vao.create(GLResource::VERTEX_ARRAY, "GLShadowMap");
+        _vbo[0].create(GLResource::BUFFER, "GLShadowMap");
+        _vbo[1].create(GLResource::BUFFER, "GLShadowMap");
+    }
+
+    glBindVertexArray(_vao.id());
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id());
+    glBufferData(GL_ARRAY_BUFFER, _points.size() * sizeof(float), _points.size() > 0 ? &_points[0] : NULL, GL_STATIC_DRAW);
+    _vbo[0].setSize(_points.size() * sizeof(float));
+
+    int pos_location = glGetAttribLocation(_program.id(), "in_Position");
+    glVertexAttribPointer((GLuint)pos_location, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(pos_location);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo[1].id());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(GLuint), _indices.size() > 0 ? &_indices[0] : NULL, GL_STATIC_DRAW);
+    _vbo[1].setSize(_indices.size() * sizeof(GLuint));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    _buffers_dirty = false;
+}
+
+
+/*!
+ Fits the dynamic layer to the bounds of the dynamic casters. The corners of all
+ boxes are projected into the light space, the crop matrix scales their 2D bounds
+ to the whole layer. The depth is not changed, so both layers can be compared.
+ */
+bool GLShadowMap::fitDynamicLayer(void)
+{
+    glm::vec2 lmin(1.0f, 1.0f);
+    glm::vec2 lmax(-1.0f, -1.0f);
+    bool found = false;
+
+    for(int i=0; i<_casters.size(); i++)
+    {
+        Caster& caster = _casters[i];
+        if(caster.is_static || !caster.enabled) continue;
+
+        glm::mat4 m = _light_matrix * caster.matrix;
+        for(int j=0; j<8; j++)
+        {
+            glm::vec4 corner((j & 1) ? caster.bmax.x : caster.bmin.x,
+                             (j & 2) ? caster.bmax.y : caster.bmin.y,
+                             (j & 4) ? caster.bmax.z : caster.bmin.z, 1.0f);
+            glm::vec4 p = m * corner;
+
+            // behind the light, use the whole frustum
+            if(p.w <= 0.0f)
+            {
+                lmin = glm::vec2(-1.0f, -1.0f);
+                lmax = glm::vec2(1.0f, 1.0f);
+                found = true;
+                continue;
+            }
+
+            glm::vec2 ndc(p.x / p.w, p.y / p.w);
+            lmin = glm::min(lmin, ndc);
+            lmax = glm::max(lmax, ndc);
+            found = true;
+        }
+    }
+
+    // the part inside the light frustum
+    lmin = glm::max(lmin, glm::vec2(-1.0f, -1.0f));
+    lmax = glm::min(lmax, glm::vec2(1.0f, 1.0f));
+    if(!found || lmin.x >= lmax.x || lmin.y >= lmax.y) return false;
+
+    glm::vec2 scale(2.0f / (lmax.x - lmin.x), 2.0f / (lmax.y - lmin.y));
+
+    glm::mat4 crop(1.0f);
+    crop[0][0] = scale.x;
+    crop[1][1] = scale.y;
+    crop[3][0] = -0.5f * (lmax.x + lmin.x) * scale.x;
+    crop[3][1] = -0.5f * (lmax.y + lmin.y) * scale.y;
+
+    _dynamic_layer.matrix = crop * _light_matrix;
+
+    return true;
+}
+
+
+/*!
+ Draws the static or dynamic casters into a layer
+ */
+void GLShadowMap::renderLayer(ShadowLayer& layer, bool is_static)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo.id());
+    glViewport(0, 0, layer.size, layer.size);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glUniformMatrix4fv(_lightMatrixLocation, 1, GL_FALSE, &layer.matrix[0][0]);
+
+    for(int i=0; i<_casters.size(); i++)
+    {
+        Caster& caster = _casters[i];
+        if(caster.is_static != is_static || !caster.enabled) continue;
+
+        glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &caster.matrix[0][0]);
+        glDrawElementsBaseVertex(GL_TRIANGLES, caster.count, GL_UNSIGNED_INT,
+                                 (const GLvoid*)(caster.first_index * sizeof(GLuint)), caster.base_vertex);
+
+        GLProfiler::Get().countDraw(caster.count / 3);
+    }
+}
+
+
+/*!
+ Renders the static layer if it is invalid and the dynamic layer
+ */
+void GLShadowMap::render(void)
+{
+    GL_PROFILE_ZONE("GLShadowMap::render");
+
+    _static_updated = false;
+    if(!_program.isValid()) return;
+
+    // casters added as objects can move with their objects
+    for(int i=0; i<_casters.size(); i++)
+    {
+        Caster& caster = _casters[i];
+        if(caster.object == NULL) continue;
+
+        if(caster.is_static) setCasterMatrix(i, caster.object->getMatrix());
+        else caster.matrix = caster.object->getMatrix();
+    }
+
+    _dynamic_visible = fitDynamicLayer();
+    if(!_static_dirty && !_dynamic_visible) return;
+
+    if(_buffers_dirty) createBuffers();
+
+    GLint last_fbo = 0;
+    GLint viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_fbo);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUseProgram(_program.id());
+    glBindVertexArray(_vao.id());
+
+    // against self-shadowing
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    if(_static_dirty)
+    {
+        renderLayer(_static_layer, true);
+        _static_dirty = false;
+        _static_updated = true;
+        _num_static_updates++;
+    }
+
+    if(_dynamic_visible)
+    {
+        renderLayer(_dynamic_layer, false);
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, last_fbo);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+
+/*!
+ Set the shadow uniforms of a receiver program and bind the depth maps
+ */
+void GLShadowMap::apply(GLuint program)
+{
+    glUseProgram(program);
+
+    glm::mat4 static_matrix = bias_matrix * _static_layer.matrix;
+    glm::mat4 dynamic_matrix = bias_matrix * _dynamic_layer.matrix;
+
+    glUniformMatrix4fv(glGetUniformLocation(program, "shadowMatrixStatic"), 1, GL_FALSE, &static_matrix[0][0]);
+    glUniformMatrix4fv(glGetUniformLocation(program, "shadowMatrixDynamic"), 1, GL_FALSE, &dynamic_matrix[0][0]);
+    glUniform1i(glGetUniformLocation(program, "shadowMapStatic"), STATIC_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "shadowMapDynamic"), DYNAMIC_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "shadowEnabled"), _program.isValid() ? 1 : 0);
+    glUniform1i(glGetUniformLocation(program, "shadowDynamicEnabled"), _dynamic_visible ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE0 + STATIC_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, _static_layer.texture.id());
+    glActiveTexture(GL_TEXTURE0 + DYNAMIC_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, _dynamic_layer.texture.id());
+    glActiveTexture(GL_TEXTURE0);
+
+    glUseProgram(0);
+}
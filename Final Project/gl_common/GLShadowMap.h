@@ -0,0 +1,254 @@
+//
+//  GLShadowMap.h
+//  HCI557_Simple_Texture
+//
+//  Shadow mapping for a spot or a directional light with two layers. Static
+//  casters are rendered into a cached depth map only when the light or a static
+//  caster moves. Dynamic casters are rendered every frame into a small second
+//  depth map that is fitted to their bounds.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+#include "GLAppearance.h"
+#include "HCI557Datatypes.h"
+#include "GLResource.h"
+
+using namespace std;
+
+
+
+/*!
+ The static layer covers the whole light frustum. Its cost does not depend on the
+ frame rate, only on how often the light or the static casters move.
+
+ The dynamic layer uses the same light matrix with a crop matrix, so it covers only
+ the bounds of the dynamic casters and has a high resolution with few pixels.
+ Both layers store the same depth values. A receiver is lit if it is lit in both layers.
+
+ Receiver shaders need the world space position of the fragment and the uniforms
+    uniform mat4 shadowMatrixStatic;            // light space, scaled to [0, 1]
+    uniform mat4 shadowMatrixDynamic;
+    uniform sampler2DShadow shadowMapStatic;
+    uniform sampler2DShadow shadowMapDynamic;
+    uniform int shadowEnabled;
+    uniform int shadowDynamicEnabled;
+ see ../data/shaders/multi_texture.fs. The shadow maps use the texture units
+ STATIC_TEXTURE_UNIT and DYNAMIC_TEXTURE_UNIT.
+ */
+class GLShadowMap
+{
+public:
+
+    /*!
+     @param static_size - the size of the cached static depth map in pixels
+     @param dynamic_size - the size of the per-frame dynamic depth map in pixels
+     */
+    GLShadowMap(int static_size = 2048, int dynamic_size = 512);
+    ~GLShadowMap();
+
+
+    /*!
+     Create the depth maps and the depth program
+     @return true if the shadow map can be used
+     */
+    bool init(void);
+
+
+    /*!
+     Set the light. The static layer is rendered again if the light changed.
+     @param light - a spotlight, the frustum follows the cone
+     */
+    void setSpotLight(const GLSpotLightSource& light);
+
+
+    /*!
+     Set a directional light. The static layer is rendered again if the light changed.
+     @param light - the light, _lightPos is the direction towards the light
+     @param center, radius - the bounding sphere of the shadowed area
+     */
+    void setDirectionalLight(const GLDirectLightSource& light, const glm::vec3& center, float radius);
+
+
+    /*!
+     Set the near and far distance of the spotlight frustum
+     */
+    void setRange(float near_distance, float far_distance);
+
+
+    /*!
+     Add an object as shadow caster. The triangles come from GLObject::getTriangles(),
+     the model matrix is read from the object when the layer is rendered.
+     @param object - the object
+     @param is_static - true if the object does not move
+     @return the index of the caster or -1 if the object has no triangles
+     */
+    int addCaster(GLObject* object, bool is_static);
+
+
+    /*!
+     Add a mesh as shadow caster, e.g. one instance of a GLInstancedMesh
+     @param points - the vertices in model coordinates
+     @param indices - three indices per triangle
+     @param matrix - the model matrix
+     @param is_static - true if the mesh does not move
+     @return the index of the caster
+     */
+    int addCaster(vector<Vertex>& points, vector<GLuint>& indices, const glm::mat4& matrix, bool is_static);
+
+
+    /*!
+     Set the model matrix of a caster that was added as mesh.
+     The static layer is rendered again if a static caster moved.
+     */
+    void setCasterMatrix(int index, const glm::mat4& matrix);
+
+
+    /*!
+     Enable or disable a caster
+     */
+    void setCasterEnabled(int index, bool enabled);
+
+
+    /*!
+     Renders the static layer again with the next render() call
+     */
+    inline void invalidate(void){_static_dirty = true;}
+
+
+    /*!
+     Renders the static layer if it is invalid and the dynamic layer.
+     Call this before the receivers are drawn. Restores the framebuffer and the viewport.
+     */
+    void render(void);
+
+
+    /*!
+     Set the shadow uniforms of a receiver program and bind the depth maps
+     @param program - the receiver program
+     */
+    void apply(GLuint program);
+
+
+    /*!
+     Returns the number of times the static layer was rendered
+     */
+    inline int numStaticUpdates(void){return _num_static_updates;}
+
+
+    /*!
+     Returns true if the static layer was rendered by the last render() call
+     */
+    inline bool staticUpdated(void){return _static_updated;}
+
+
+    /*!
+     Returns true if init() succeeded
+     */
+    inline bool isValid(void){return _program.isValid();}
+
+
+    // the texture units of the depth maps, above the units of GLMultiTexture
+    static const int STATIC_TEXTURE_UNIT = 4;
+    static const int DYNAMIC_TEXTURE_UNIT = 5;
+
+
+private:
+
+    // One depth map, the texture cannot be reloaded and is never evicted
+    typedef struct _ShadowLayer
+    {
+        GLResource  fbo;
+        GLResource  texture;
+        int         size;
+        glm::mat4   matrix;     // light projection * light view, with the crop matrix
+    }ShadowLayer;
+
+
+    // One caster mesh inside the vertex buffer
+    typedef struct _Caster
+    {
+        GLint       base_vertex;
+        GLuint      first_index;
+        GLsizei     count;
+        glm::vec3   bmin;       // model space bounds
+        glm::vec3   bmax;
+        glm::mat4   matrix;
+        GLObject*   object;
+        bool        is_static;
+        bool        enabled;
+    }Caster;
+
+
+    /*!
+     Create the depth texture and the framebuffer of a layer
+     */
+    bool createLayer(ShadowLayer& layer, int size);
+
+
+    /*!
+     Copies the caster meshes into the vertex buffer
+     */
+    void createBuffers(void);
+
+
+    /*!
+     Sets a new light matrix, invalidates the static layer if it changed
+     */
+    void setLightMatrix(const glm::mat4& matrix);
+
+
+    /*!
+     Fits the dynamic layer to the bounds of the dynamic casters
+     @return false if no dynamic caster is inside the light frustum
+     */
+    bool fitDynamicLayer(void);
+
+
+    /*!
+     Draws the static or dynamic casters into a layer
+     */
+    void renderLayer(ShadowLayer& layer, bool is_static);
+
+
+    ShadowLayer         _static_layer;
+    ShadowLayer         _dynamic_layer;
+
+    // the light matrix without the crop matrix
+    glm::mat4           _light_matrix;
+    float               _near;
+    float               _far;
+
+    // the casters and their geometry, positions only
+    vector<Caster>      _casters;
+    vector<float>       _points;
+    vector<GLuint>      _indices;
+    bool                _buffers_dirty;
+
+    GLResource          _vao;
+    GLResource          _vbo[2];
+
+    // the depth program
+    GLResource          _program;
+    int                 _lightMatrixLocation;
+    int                 _modelMatrixLocation;
+
+    bool                _static_dirty;
+    bool                _static_updated;
+    bool                _dynamic_visible;
+    int                 _num_static_updates;
+};
@@ -0,0 +1,39 @@
+//
+//  GLSimd.h
+//  HCI557_Simple_Texture
+//
+//  Selects the AVX2 / FMA kernels of GLTransformSystem and GLFrustumCuller.
+//  GCC and Clang build the kernels for AVX2 and FMA without -mavx2 -mfma, the
+//  kernels run only if the CPU supports both. Other compilers build them only
+//  if the target has AVX2, e.g. MSVC with /arch:AVX2.
+//
+#pragma once
+
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+    // the whole build targets AVX2
+    #define GL_SIMD_AVX
+    #define GL_SIMD_AVX_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // only the kernels target AVX2, they are selected at run time
+    #define GL_SIMD_AVX
+    #define GL_SIMD_AVX_TARGET __attribute__((target("avx2,fma")))
+    #define GL_SIMD_AVX_DISPATCH
+#endif
+
+
+
+/*!
+ Returns true if the AVX2 / FMA kernels can run on this CPU
+ */
+inline bool GLSimdHasAVX(void)
+{
+#if defined(GL_SIMD_AVX_DISPATCH)
+    static const bool has_avx = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"));
+    return has_avx;
+#elif defined(GL_SIMD_AVX)
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,292 @@
+//
+//  GLSkybox.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLSkybox.h"
+#include "Shaders.h"
+#include "Texture.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+
+// the texture unit of the cubemap, units 0 - 2 belong to the object textures
+static const int SKY_UNIT = 3;
+
+
+// A full-screen triangle on the far plane. The view direction of a corner is the
+// difference of its far and near point in world space. Perspective projections keep
+// the w of both points independent of x and y, so the direction is linear on screen.
+static const string sky_vs =
+"#version 330 core                                                  \n"
+"uniform mat4 inv_view_projection;                                  \n"
+"out vec3 pass_Direction;                                           \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2)) * 2.0 - 1.0; \n"
+"    vec4 near_point = inv_view_projection * vec4(p, -1.0, 1.0);    \n"
+"    vec4 far_point = inv_view_projection * vec4(p, 1.0, 1.0);      \n"
+"    pass_Direction = far_point.xyz / far_point.w - near_point.xyz / near_point.w; \n"
+"    gl_Position = vec4(p, 1.0, 1.0);                               \n"
+"}                                                                  \n";
+
+static const string sky_fs =
+"#version 330 core                                                  \n"
+"uniform samplerCube sky;                                           \n"
+"in vec3 pass_Direction;                                            \n"
+"out vec4 color;                                                    \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    color = vec4(texture(sky, pass_Direction).rgb, 1.0);           \n"
+"}                                                                  \n";
+
+
+
+GLSkybox::GLSkybox()
+{
+    _program = 0;
+    _cubemapLocation = -1;
+    _invViewProjectionLocation = -1;
+}
+
+
+GLSkybox::~GLSkybox()
+{
+    // the handles delete the vertex array and the cubemap
+    if(_program != 0) glDeleteProgram(_program);
+}
+
+
+/*!
+ Creates the cubemap from one image
+ */
+bool GLSkybox::init(string image, int face_size)
+{
+    unsigned int channels;
+    unsigned int width;
+    unsigned int height;
+
+    unsigned char* data = loadBitmapFile(image, channels, width, height);
+    if(data == NULL || (channels != 3 && channels != 4))
+    {
+        cerr << "[GLSkybox] - Cannot read the sky image " << image << "." << endl;
+        if(data != NULL) free(data);
+        return false;
+    }
+
+    int size = face_size > 0 ? face_size : (int)height;
+
+    // the mean colors of the upper and the lower eighth of the image, the rows of a bmp start at the bottom
+    int band = std::max(1, (int)height / 8);
+    float top[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float bottom[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for(int y=0; y<band; y++)
+    {
+        const unsigned char* low = data + y * width * channels;
+        const unsigned char* high = data + (height - 1 - y) * width * channels;
+        for(unsigned int x=0; x<width * channels; x++)
+        {
+            bottom[x % channels] += low[x];
+            top[x % channels] += high[x];
+        }
+    }
+    for(unsigned int c=0; c<channels; c++)
+    {
+        top[c] /= band * width;
+        bottom[c] /= band * width;
+    }
+
+    vector<unsigned char> faces[6];
+    for(int f=0; f<6; f++) faces[f].resize(size * size * channels);
+
+    // the sides, the rows of a cubemap face start at the top
+    for(int y=0; y<size; y++)
+    {
+        int src_y = height - 1 - (y * height) / size;
+
+        // the sides fade to the top and bottom color near the edges
+        float fade_top = std::max(0.0f, 1.0f - (float)y / (size / 8.0f));
+        float fade_bottom = std::max(0.0f, 1.0f - (float)(size - 1 - y) / (size / 8.0f));
+
+        for(int x=0; x<size; x++)
+        {
+            int src_x = (x * width) / size;
+            const unsigned char* src = data + (src_y * width + src_x) * channels;
+            const unsigned char* mirrored = data + (src_y * width + width - 1 - src_x) * channels;
+
+            for(unsigned int c=0; c<channels; c++)
+            {
+                float a = src[c] + (top[c] - src[c]) * fade_top + (bottom[c] - src[c]) * fade_bottom;
+                float b = mirrored[c] + (top[c] - mirrored[c]) * fade_top + (bottom[c] - mirrored[c]) * fade_bottom;
+
+                int i = (y * size + x) * channels + c;
+                faces[0][i] = (unsigned char)b; // +x
+                faces[1][i] = (unsigned char)b; // -x
+                faces[4][i] = (unsigned char)a; // +z
+                faces[5][i] = (unsigned char)a; // -z
+            }
+        }
+    }
+
+    // top and bottom
+    for(int i=0; i<size * size; i++)
+    {
+        for(unsigned int c=0; c<channels; c++)
+        {
+            faces[2][i * channels + c] = (unsigned char)top[c];
+            faces[3][i * channels + c] = (unsigned char)bottom[c];
+        }
+    }
+    free(data);
+
+    if(!initProgram()) return false;
+    uploadFaces(faces, size, channels);
+
+    return true;
+}
+
+
+/*!
+ Creates the cubemap from six square images of the same size
+ */
+bool GLSkybox::init(const string faces[6])
+{
+    vector<unsigned char> data[6];
+    int size = 0;
+    int num_channels = 0;
+
+    for(int f=0; f<6; f++)
+    {
+        unsigned int channels;
+        unsigned int width;
+        unsigned int height;
+
+        unsigned char* image = loadBitmapFile(faces[f], channels, width, height);
+        if(image == NULL)
+        {
+            cerr << "[GLSkybox] - Cannot read the sky image " << faces[f] << "." << endl;
+            return false;
+        }
+
+        if(width != height || (f > 0 && ((int)width != size || (int)channels != num_channels)) || (channels != 3 && channels != 4))
+        {
+            cerr << "[GLSkybox] - The sky image " << faces[f] << " is not square or differs from the other faces." << endl;
+            free(image);
+            return false;
+        }
+        size = width;
+        num_channels = channels;
+
+        // the rows of a bmp start at the bottom, of a cubemap face at the top
+        int row = width * channels;
+        data[f].resize(row * height);
+        for(unsigned int y=0; y<height; y++)
+        {
+            memcpy(&data[f][y * row], image + (height - 1 - y) * row, row);
+        }
+        free(image);
+    }
+
+    if(!initProgram()) return false;
+    uploadFaces(data, size, num_channels);
+
+    return true;
+}
+
+
+/*!
+ Creates the program and the empty vertex array of the triangle
+ */
+bool GLSkybox::initProgram(void)
+{
+    if(_program != 0) return true;
+
+    _program = CreateShaderProgram(sky_vs, sky_fs);
+    if(_program == 0)
+    {
+        cerr << "[GLSkybox] - Cannot create the sky program." << endl;
+        return false;
+    }
+
+    glUseProgram(_program);
+    _cubemapLocation = glGetUniformLocation(_program, "sky");
+    _invViewProjectionLocation = glGetUniformLocation(_program, "inv_view_projection");
+    glUniform1i(_cubemapLocation, SKY_UNIT);
+    glUseProgram(0);
+
+    // core profiles need a bound vertex array for every draw
+    _vao.create(GLResource::VERTEX_ARRAY, "GLSkybox");
+
+    return true;
+}
+
+
+/*!
+ Uploads six faces with the edge length size
+ */
+void GLSkybox::uploadFaces(const vector<unsigned char>* faces, int size, int channels)
+{
+    _cubemap.create(GLResource::TEXTURE, "GLSkybox");
+
+    glActiveTexture(GL_TEXTURE0 + SKY_UNIT);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, _cubemap.id());
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for(int f=0; f<6; f++)
+    {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, channels == 4 ? GL_RGBA : GL_RGB, size, size, 0,
+                     channels == 4 ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, &faces[f][0]);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    _cubemap.setSize(6 * size * size * channels);
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+
+/*!
+ Draws the sky behind everything drawn before
+ */
+void GLSkybox::draw(const glm::mat4& view_projection)
+{
+    GL_PROFILE_ZONE("GLSkybox::draw");
+    if(!isValid()) return;
+
+    GLint depth_func;
+    GLboolean depth_mask;
+    glGetIntegerv(GL_DEPTH_FUNC, &depth_func);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+
+    // the far plane passes where the depth buffer was cleared to 1.0
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+
+    glm::mat4 inv_view_projection = glm::inverse(view_projection);
+
+    glUseProgram(_program);
+    glUniformMatrix4fv(_invViewProjectionLocation, 1, GL_FALSE, &inv_view_projection[0][0]);
+
+    // unit 3 stays bound, no other texture uses it
+    glActiveTexture(GL_TEXTURE0 + SKY_UNIT);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, _cubemap.id());
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(_vao.id());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLProfiler::Get().countDraw(1, 1);
+    glBindVertexArray(0);
+
+    glUseProgram(0);
+
+    glDepthFunc(depth_func);
+    glDepthMask(depth_mask);
+}
@@ -0,0 +1,105 @@
+//
+//  GLSkybox.h
+//  HCI557_Simple_Texture
+//
+//  A cubemap sky, drawn as one fullscreen triangle behind the scene. Only the
+//  pixels no object covers pass the depth test, so every sky pixel costs one
+//  texture fetch and is never drawn over.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLResource.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The triangle lies on the far plane, depth 1.0, and is drawn with GL_LEQUAL and without
+ depth writes after the opaque objects. The vertex shader turns the corners into world
+ space view directions with the inverse view projection matrix, the fragment shader
+ samples the cubemap in this direction. GLRenderQueue draws it between the opaque and the
+ transparent objects, see GLRenderQueue::setSkybox().
+
+ The cubemap is created from six square images, or from one image for the four sides.
+ The cubemap uses texture unit 3, the units of the other textures stay bound.
+ */
+class GLSkybox
+{
+public:
+
+    GLSkybox();
+    ~GLSkybox();
+
+
+    /*!
+     Creates the cubemap from one image. The image is the front and the back side,
+     mirrored it is the left and the right side, so the edges match. The top and the
+     bottom have the mean color of the upper and the lower image rows, the sides
+     fade to these colors.
+     @param image - the bmp file of the sky
+     @param face_size - the edge length of the faces in pixels, 0 uses the image height
+     @return true if the object can be used
+     */
+    bool init(string image, int face_size = 0);
+
+
+    /*!
+     Creates the cubemap from six square images of the same size.
+     @param faces - the bmp files of the faces +x, -x, +y, -y, +z, -z
+     @return true if the object can be used
+     */
+    bool init(const string faces[6]);
+
+
+    /*!
+     Draws the sky behind everything drawn before
+     @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+     */
+    void draw(const glm::mat4& view_projection);
+
+
+    /*!
+     Returns true if the cubemap and the program exist
+     */
+    inline bool isValid(void){return _program != 0 && _cubemap.isValid();}
+
+
+private:
+
+    /*!
+     Creates the program and the empty vertex array of the triangle
+     */
+    bool initProgram(void);
+
+
+    /*!
+     Uploads six faces with the edge length size, 3 or 4 channels in BGR(A) order,
+     the rows of every face from the top to the bottom
+     */
+    void uploadFaces(const vector<unsigned char>* faces, int size, int channels);
+
+
+    GLuint                  _program;
+    GLResource              _vao; // no buffers, the corners come from gl_VertexID
+
+    int                     _cubemapLocation;
+    int                     _invViewProjectionLocation;
+
+    GLResource              _cubemap;
+};
@@ -7,6 +7,8 @@
 //
 
 #include "GLSphere.h"
+#include "GLProfiler.h"
+#include "GLDebugOverlay.h"
 
 
 
@@ -164,14 +166,10 @@ void GLSphere::GLSphere1(float center_x, float center_y, float center_z, float r
 	_segments = segments;
 
 	_render_normal_vectors = false;
-	_program_normals = -1;
 	_program = -1;
 
 	initShader1();
 	initVBO();
-
-	initShaderNormal();
-	initVBONormals();
 }
 
 
@@ -189,14 +187,10 @@ void GLSphere::GLSphere2(float center_x, float center_y, float center_z, float r
 	_segments = segments;
 
 	_render_normal_vectors = false;
-	_program_normals = -1;
 	_program = -1;
 
 	initShader2();
 	initVBO();
-
-	initShaderNormal();
-	initVBONormals();
 }
 
 
@@ -213,14 +207,10 @@ void GLSphere::GLSphere3(float center_x, float center_y, float center_z, float r
 	_segments = segments;
 
 	_render_normal_vectors = false;
-	_program_normals = -1;
 	_program = -1;
 
 	initShader3();
 	initVBO();
-
-	initShaderNormal();
-	initVBONormals();
 }
 
 
@@ -236,14 +226,10 @@ void GLSphere::GLSphere4(float center_x, float center_y, float center_z, float r
 	_segments = segments;
 
 	_render_normal_vectors = false;
-	_program_normals = -1;
 	_program = -1;
 
 	initShader4();
 	initVBO();
-
-	initShaderNormal();
-	initVBONormals();
 }
 
 
@@ -256,10 +242,7 @@ void GLSphere::GLSphere4(float center_x, float center_y, float center_z, float r
 GLSphere::~GLSphere()
 {
     // Program clean up when the window gets closed.
-    glDeleteVertexArrays(1, _vaoID);
-    glDeleteVertexArrays(1, _vaoIDNormals);
     glDeleteProgram(_program);
-    glDeleteProgram(_program_normals);
 }
 
 
@@ -268,6 +251,7 @@ GLSphere::~GLSphere()
  */
 void GLSphere::draw(void)
 {
+    GL_PROFILE_ZONE("GLSphere::draw");
  
     //////////////////////////////////////////////////
     // Renders the sphere
@@ -282,36 +266,28 @@ void GLSphere::draw(void)
     glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
     
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
+    glBindVertexArray(_vao.id());
     
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE ); // allows to see the primitives
     // Draw the triangles
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, _num_vertices);
+    glDrawElements(GL_TRIANGLES, _num_indices, GL_UNSIGNED_INT, 0);
+    GLProfiler::Get().countDraw(_num_indices / 3);
     
     //////////////////////////////////////////////////
     // Renders the normal vectors
     
-    if(_render_normal_vectors)
-    {
-    
-        // Enable the shader program
-        glUseProgram(_program_normals);
-    
-        glUniformMatrix4fv(_viewMatrixLocationN, 1, GL_FALSE, &rotated_view[0][0]); // send the view matrix to our shader
-        glUniformMatrix4fv(_modelMatrixLocationN, 1, GL_FALSE, &_modelMatrix[0][0]); //
-    
-    
-        // Bind the buffer and switch it to an active buffer
-        glBindVertexArray(_vaoIDNormals[0]);
-        glDrawArrays(GL_LINES, 0, _num_vertices_normals);
-    }
-    
     // Unbind our Vertex Array Object
     glBindVertexArray(0);
     
     // Unbind the shader program
     glUseProgram(0);
     
+    // the geometry shader of the overlay draws the lines from the vertex buffer above
+    if(_render_normal_vectors)
+    {
+        GLDebugOverlay::Get().draw(this, GetViewProjectionMatrix(), GLDebugOverlay::NORMALS);
+    }
+    
     
 }
 
@@ -336,19 +312,34 @@ void GLSphere::enableNormalVectorRenderer(bool value )
 }
 
 
+/*!
+ Draws the indexed triangles of the sphere with the bound program
+ */
+bool GLSphere::drawVertexArray(void)
+{
+    glBindVertexArray(_vao.id());
+    glDrawElements(GL_TRIANGLES, _num_indices, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    return true;
+}
+
+
 /*!
  Create the vertex buffer object for this element
  */
 void GLSphere::initVBO(void)
 {
+    GL_PROFILE_ZONE("GLSphere::initVBO");
 
     
     _spherePoints.clear();
     _normalVectors.clear();
+    _indices.clear();
     
-    make_Sphere(_center, _radius, _spherePoints, _normalVectors);
+    make_Sphere(_center, _radius, _spherePoints, _normalVectors, _indices);
     
     _num_vertices = _spherePoints.size();
+    _num_indices = _indices.size();
     
     
     // create memory for the vertices, etc.
@@ -369,18 +360,25 @@ void GLSphere::initVBO(void)
         colors[(i*3)] = 1.0; colors[(i*3)+1] = 1.0; colors[(i*3)+2] = 0.0;
     }
     
+    // the local bounds for view-frustum culling
+    computeBounds(vertices, _num_vertices, 3);
+    
     glUseProgram(_program);
     
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
+    _vao.create(GLResource::VERTEX_ARRAY, "GLSphere"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
     
-    glGenBuffers(3, _vboID); // Generate our Vertex Buffer Object
+    _vbo[0].create(GLResource::BUFFER, "GLSphere"); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, "GLSphere");
+    _vbo[2].create(GLResource::BUFFER, "GLSphere");
+    _vbo[3].create(GLResource::BUFFER, "GLSphere");
     
     // vertices
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 * sizeof(GLfloat), vertices, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[0].setSize(_num_vertices * 3 * sizeof(GLfloat));
     
     int locPos = glGetAttribLocation(_program, "in_Position");
     glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
@@ -388,8 +386,9 @@ void GLSphere::initVBO(void)
     
     
     //Normals
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our second Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our second Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 *  sizeof(GLfloat), normals, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[1].setSize(_num_vertices * 3 *  sizeof(GLfloat));
     
     int locNorm = glGetAttribLocation(_program, "in_Normal");
     glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
@@ -397,84 +396,30 @@ void GLSphere::initVBO(void)
     
     
     //Color
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[2]); // Bind our second Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[2].id()); // Bind our second Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 *  sizeof(GLfloat), colors, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[2].setSize(_num_vertices * 3 *  sizeof(GLfloat));
     
     int logColor = glGetAttribLocation(_program, "in_Color");
     glVertexAttribPointer((GLuint)logColor, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(logColor); //
     
-    glBindVertexArray(0); // Disable our Vertex Buffer Object
-    
-    // delete the memory
-    delete vertices;
-    delete colors;
-    delete normals;
-}
-
-
-/*!
- Init a frame buffer object to draw normal vectors
- */
-void GLSphere::initVBONormals(void)
-{
-    
-    // create the normal vector lines
-    vector<Vertex> normalVectorLines;
-    for(int i=0; i<_spherePoints.size() ; i++)
-    {
-        Vertex v = _spherePoints[i];
-        Vertex n = _normalVectors[i];
-        
-        normalVectorLines.push_back(v);
-        normalVectorLines.push_back(v+n);
-        
-    }
-    
-    float *normal_lines = new float[normalVectorLines.size() * 3];
-    float *colors = new float[normalVectorLines.size() * 3];
-
-    for(int i=0; i<normalVectorLines.size() ; i++)
-    {
-        normal_lines[(i*3)] = normalVectorLines[i].x();
-        normal_lines[(i*3)+1] = normalVectorLines[i].y();
-        normal_lines[(i*3)+2] = normalVectorLines[i].z();
-        
-        colors[(i*3)] = 0.0; colors[(i*3)+1] = 0.0; colors[(i*3)+2] = 1.0;
-    }
-    
-    _num_vertices_normals = normalVectorLines.size();
-    
-    glUseProgram(_program_normals);
-    
-    glGenVertexArrays(1, _vaoIDNormals); // Create our Vertex Array Object
-    glBindVertexArray(_vaoIDNormals[0]); // Bind our Vertex Array Object so we can use it
-    
-    
-    glGenBuffers(2, _vboIDNormals); // Generate our Vertex Buffer Object
-    
-    // vertices
-    glBindBuffer(GL_ARRAY_BUFFER, _vboIDNormals[0]); // Bind our Vertex Buffer Object
-    glBufferData(GL_ARRAY_BUFFER, normalVectorLines.size() * 3 * sizeof(GLfloat), normal_lines, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
-    
-    glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
-    glEnableVertexAttribArray(0); //
-    
-    
-    //Color
-    glBindBuffer(GL_ARRAY_BUFFER, _vboIDNormals[1]); // Bind our second Vertex Buffer Object
-    glBufferData(GL_ARRAY_BUFFER, normalVectorLines.size() * 3 *  sizeof(GLfloat), colors, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
     
-    glVertexAttribPointer((GLuint)glGetAttribLocation(_program, "in_Color"), 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
-    glEnableVertexAttribArray(glGetAttribLocation(_program, "in_Color")); //
+    //Indices
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo[3].id());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _num_indices * sizeof(GLuint), &_indices[0], GL_STATIC_DRAW);
+    _vbo[3].setSize(_num_indices * sizeof(GLuint));
     
     glBindVertexArray(0); // Disable our Vertex Buffer Object
     
-    delete normal_lines;
-    delete colors;
+    // delete the memory
+    delete[] vertices;
+    delete[] colors;
+    delete[] normals;
 }
 
 
+
 /*
  Inits the shader program for this object
  */
@@ -1041,82 +986,27 @@ void GLSphere::initShader4(void)
 
 }
 
-/*!
- Shader for the normal vector renderer
- */
-void GLSphere::initShaderNormal(void)
-{
-    _program_normals = CreateShaderProgram(vs_string_simple_shader_410, fs_string_simple_shader_410);
-    
-    glUseProgram(_program_normals);
-    
-    unsigned int projectionMatrixLocation = glGetUniformLocation(_program_normals, "projectionMatrix"); // Get the location of our projection matrix in the shader
-    _viewMatrixLocationN = glGetUniformLocation(_program_normals, "viewMatrix"); // Get the location of our view matrix in the shader
-    _modelMatrixLocationN = glGetUniformLocation(_program_normals, "modelMatrix"); // Get the location of our model matrix in the shader
-    
-    
-    glUniformMatrix4fv(projectionMatrixLocation, 1, GL_FALSE, &projectionMatrix()[0][0] ); // Send our projection matrix to the shader
-    glUniformMatrix4fv(_viewMatrixLocationN, 1, GL_FALSE, &viewMatrix()[0][0]); // Send our view matrix to the shader
-    glUniformMatrix4fv(_modelMatrixLocationN, 1, GL_FALSE, &_modelMatrix[0][0]); // Send our model matrix to the shader
-    
-    
-    glBindAttribLocation(_program_normals, 0, "in_Position");
-    glBindAttribLocation(_program_normals, 1, "in_Color");
-
-    glUseProgram(0);
-}
 
 
 
-
-void GLSphere::make_Sphere(Vertex center, double r, std::vector<Vertex> &spherePoints, std::vector<Vertex> &normals)
+void GLSphere::make_Sphere(Vertex center, double r, std::vector<Vertex> &spherePoints, std::vector<Vertex> &normals, std::vector<GLuint> &indices)
 {
-    const double PI = 3.141592653589793238462643383279502884197;
+    // a row has 2 * segments slices, two triangles each
+    const GLSphereMesh& mesh = GLSphereMesh::Get(_rows, 2 * _segments);
+    
     spherePoints.clear();
+    normals.clear();
+    spherePoints.reserve(mesh.points.size());
+    normals.reserve(mesh.points.size());
     
-    int current_size = 0;
-    for (double theta = 0.; theta < PI; theta += PI/float(_rows)) // Elevation [0, PI]
+    for(int i=0; i<mesh.points.size(); i++)
     {
-        //double theta = 1.57;
-        double theta2 = theta + PI/float(_rows);
-        int count = 0;
-        int count_row = 0;
-        current_size = spherePoints.size();
-        
-        // Iterate through phi, theta then convert r,theta,phi to  XYZ
-        for (double phi = 0.; phi < 2*PI + PI/float(_segments) ; phi += PI/float(_segments)) // Azimuth [0, 2PI]
-        {
-            
-            Vertex point;
-            point.x() = r * cos(phi) * sin(theta) + center.x();
-            point.y() = r * sin(phi) * sin(theta) + center.y();
-            point.z() = r            * cos(theta) + center.z();
-            spherePoints.push_back(point); count++;
-            
-            
-            Vertex point2;
-            point2.x() = r * cos(phi) * sin(theta2) + center.x();
-            point2.y() = r * sin(phi) * sin(theta2) + center.y();
-            point2.z() = r            * cos(theta2) + center.z();
-            spherePoints.push_back(point2); count++;
-            
-            Vertex normal;
-            normal.x() =  cos(phi) * sin(theta);
-            normal.y() =  sin(phi) * sin(theta);
-            normal.z() =  cos(theta);
-            normals.push_back(normal);
-            
-            Vertex normal2;
-            normal2.x() =  cos(phi) * sin(theta2);
-            normal2.y() =  sin(phi) * sin(theta2);
-            normal2.z() =  cos(theta2);
-            normals.push_back(normal2);
-            
-            
-        }
-        if(count_row == 0) count_row = count;
+        Vertex n = mesh.points[i];
+        normals.push_back(n);
+        spherePoints.push_back(Vertex(r * n.x() + center.x(), r * n.y() + center.y(), r * n.z() + center.z()));
     }
-    return;
+    
+    indices = mesh.indices;
 }
 
 
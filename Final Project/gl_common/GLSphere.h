@@ -28,6 +28,7 @@
 #include "GLObject.h"
 #include "Shaders.h"
 #include "HCI557Datatypes.h"
+#include "GLSphereMesh.h"
 
 using namespace std;
 
@@ -57,6 +58,12 @@ public:
      Draw the objects
      */
     virtual  void draw(void);
+
+    
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
     
     
     /*!
@@ -71,11 +78,17 @@ public:
     inline glm::mat4& getModelMatrix(void){return _modelMatrix;};
     
     /*!
-     Enables or disables the normal vector renderer
+     Enables or disables the normal vector renderer, see GLDebugOverlay
      @param value = true -> enables the renderer, false -> disables the renderer
      */
     void enableNormalVectorRenderer(bool value = true);
     
+    
+    /*!
+     Draws the indexed triangles of the sphere with the bound program
+     */
+    virtual bool drawVertexArray(void);
+    
 protected:
     
     
@@ -92,22 +105,11 @@ protected:
 	virtual void initShader2(void);
 	virtual void initShader3(void);
 	virtual void initShader4(void);
-    /*!
-     Init a frame buffer object to draw normal vectors
-     */
-    void initVBONormals(void);
-
-    
-    /*!
-     Shader for the normal vector renderer
-     */
-    void initShaderNormal(void);
-    
     
     /*
-     Creates a sphere
+     Creates a sphere from the shared mesh of GLSphereMesh, indexed triangles
      */
-    void make_Sphere(Vertex center, double r, std::vector<Vertex> &spherePoints, std::vector<Vertex> &normals);
+    void make_Sphere(Vertex center, double r, std::vector<Vertex> &spherePoints, std::vector<Vertex> &normals, std::vector<GLuint> &indices);
     
 
     
@@ -116,8 +118,8 @@ protected:
 
 
 
-    unsigned int            _vaoID[1]; // Our Vertex Array Object
-    unsigned int            _vboID[3]; // Our Vertex Buffer Object
+    GLResource              _vao; // Our Vertex Array Object
+    GLResource              _vbo[4]; // vertices, normals, colors, indices
     
     
     // The light source
@@ -125,13 +127,6 @@ protected:
 	GLSpotLightSource		_light_source1;
 
     
-    // The program and data to render normal vectors as lines
-    GLuint                  _program_normals;
-    unsigned int            _viewMatrixLocationN;
-    unsigned int            _modelMatrixLocationN;
-    unsigned int            _vaoIDNormals[1];
-    unsigned int            _vboIDNormals[2]; // Our Vertex Buffer Object for normal vectors
-
     
 
     
@@ -141,7 +136,7 @@ protected:
     int                     _rows;
     
     int                     _num_vertices;
-    int                     _num_vertices_normals;
+    int                     _num_indices;
     
     Vertex                  _center;
     float                   _radius;
@@ -150,6 +145,7 @@ protected:
     // variables to generate the sphere
     vector<Vertex>          _spherePoints;
     vector<Vertex>          _normalVectors;
+    vector<GLuint>          _indices;
     
     
     // value to switch the normal renderer on / off
@@ -0,0 +1,94 @@
+//
+//  GLSphereMesh.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLSphereMesh.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <math.h>
+
+
+
+/*!
+ Returns the mesh for this resolution, builds it on the first call
+ */
+//static
+const GLSphereMesh& GLSphereMesh::Get(int rows, int segments)
+{
+    static std::map< std::pair<int, int>, GLSphereMesh* > meshes;
+    static std::mutex mutex;
+
+    rows = std::max(rows, 2);
+    segments = std::max(segments, 3);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    GLSphereMesh*& mesh = meshes[std::make_pair(rows, segments)];
+    if(mesh == NULL) mesh = new GLSphereMesh(rows, segments);
+    return *mesh;
+}
+
+
+GLSphereMesh::GLSphereMesh(int rows, int segments):
+    _rows(rows), _segments(segments)
+{
+    GL_PROFILE_ZONE("GLSphereMesh");
+
+    const double PI = 3.141592653589793238462643383279502884197;
+
+    // one sine and cosine per row and per segment, not per vertex
+    vector<float> sin_theta(rows + 1), cos_theta(rows + 1);
+    for(int r=0; r<=rows; r++)
+    {
+        sin_theta[r] = (float)sin(PI * r / rows);
+        cos_theta[r] = (float)cos(PI * r / rows);
+    }
+    // the poles are exact
+    sin_theta[0] = sin_theta[rows] = 0.0f;
+
+    vector<float> sin_phi(segments + 1), cos_phi(segments + 1);
+    for(int s=0; s<=segments; s++)
+    {
+        sin_phi[s] = (float)sin(2.0 * PI * s / segments);
+        cos_phi[s] = (float)cos(2.0 * PI * s / segments);
+    }
+    // the seam closes without a crack
+    sin_phi[segments] = sin_phi[0];
+    cos_phi[segments] = cos_phi[0];
+
+    const int row = segments + 1;
+    points.reserve((rows + 1) * row);
+    for(int r=0; r<=rows; r++)
+    {
+        for(int s=0; s<=segments; s++)
+        {
+            points.push_back(Vertex(cos_phi[s] * sin_theta[r], sin_phi[s] * sin_theta[r], cos_theta[r]));
+        }
+    }
+
+    // a and b on one row, c and d on the next row towards -z
+    indices.reserve(rows * segments * 6);
+    for(int r=0; r<rows; r++)
+    {
+        for(int s=0; s<segments; s++)
+        {
+            GLuint a = r * row + s;
+            GLuint b = a + 1;
+            GLuint c = a + row;
+            GLuint d = c + 1;
+
+            if(r > 0)
+            {
+                indices.push_back(a); indices.push_back(c); indices.push_back(b);
+            }
+            if(r < rows - 1)
+            {
+                indices.push_back(b); indices.push_back(c); indices.push_back(d);
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  GLSphereMesh.h
+//  HCI557_Simple_Texture
+//
+//  An indexed unit sphere, built once per resolution and shared by all
+//  spheres with this resolution.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// locals
+#include "HCI557Datatypes.h"
+
+
+using namespace std;
+
+
+
+/*!
+ A UV sphere with the radius 1 around the origin, the z axis goes through the poles.
+ rows is the number of bands from pole to pole, segments the number of slices around
+ the z axis. The vertices are on a (rows + 1) x (segments + 1) grid, the seam and the
+ poles are duplicated. A point is also its normal vector. The triangles are counter
+ clockwise seen from outside, the degenerated triangles at the poles are left out.
+
+ Get() builds a mesh from tables of the sines and cosines of the rows and segments
+ and keeps it until the program ends. It is safe to call from several threads.
+ */
+class GLSphereMesh
+{
+public:
+
+    /*!
+     Returns the mesh for this resolution, builds it on the first call
+     @param rows - the bands from pole to pole, at least 2
+     @param segments - the slices around the poles, at least 3
+     */
+    static const GLSphereMesh& Get(int rows, int segments);
+
+
+    inline int rows(void) const {return _rows;}
+    inline int segments(void) const {return _segments;}
+
+
+    // the points on the unit sphere, also the normal vectors
+    vector<Vertex>          points;
+
+    // three indices per triangle
+    vector<GLuint>          indices;
+
+
+private:
+
+    GLSphereMesh(int rows, int segments);
+
+    int                     _rows;
+    int                     _segments;
+};
@@ -0,0 +1,391 @@
+//
+//  GLStaticBatch.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLStaticBatch.h"
+#include "GLProfiler.h"
+
+#include <string.h>
+
+
+
+GLStaticBatch::GLStaticBatch()
+{
+    _matrices_dirty = true;
+    _commands_dirty = false;
+    _multi_draw_indirect = false;
+    _num_triangles = 0;
+    _drawMatrixLocation = -1;
+
+    _program = 0;
+}
+
+
+GLStaticBatch::~GLStaticBatch()
+{
+    // the handles delete the vertex array and the buffers
+}
+
+
+/*!
+ Add the geometry of an object. Call this before init().
+ @param object - the object, it must support getTriangles()
+ @return the index of the draw or -1 if the object cannot be batched
+ */
+int GLStaticBatch::add(GLObject* object)
+{
+    if(_vao.isValid())
+    {
+        cerr << "[GLStaticBatch] - The batch is already initialized. Objects cannot be added." << endl;
+        return -1;
+    }
+
+    vector<Vertex> points;
+    vector<Vertex> normals;
+    vector<GLuint> indices;
+
+    if(object == NULL || !object->getTriangles(points, normals, indices) || indices.size() == 0)
+    {
+        cerr << "[GLStaticBatch] - The object does not provide triangles and cannot be batched." << endl;
+        return -1;
+    }
+
+    DrawElementsIndirectCommand cmd;
+    cmd.count = (GLuint)indices.size();
+    cmd.instanceCount = 1;
+    cmd.firstIndex = (GLuint)_indices.size();
+    cmd.baseVertex = (GLint)(_vertex_data.size() / 8);
+    cmd.baseInstance = (GLuint)_commands.size();
+    _commands.push_back(cmd);
+    _num_triangles += cmd.count / 3;
+
+    // position, normal, texture coordinate
+    glm::vec3 bmin(points[0].x(), points[0].y(), points[0].z());
+    glm::vec3 bmax = bmin;
+    for(int i=0; i<points.size(); i++)
+    {
+        Vertex& p = points[i];
+        Vertex& n = normals[i];
+        _vertex_data.push_back(p.x()); _vertex_data.push_back(p.y()); _vertex_data.push_back(p.z());
+        _vertex_data.push_back(n.x()); _vertex_data.push_back(n.y()); _vertex_data.push_back(n.z());
+        _vertex_data.push_back(p.u()); _vertex_data.push_back(p.v());
+
+        bmin = glm::min(bmin, glm::vec3(p.x(), p.y(), p.z()));
+        bmax = glm::max(bmax, glm::vec3(p.x(), p.y(), p.z()));
+    }
+    _indices.insert(_indices.end(), indices.begin(), indices.end());
+
+    _objects.push_back(object);
+    _matrices.push_back(object->getMatrix());
+    _draw_min.push_back(bmin);
+    _draw_max.push_back(bmax);
+    _matrices_dirty = true;
+
+    addBounds(object->getMatrix(), bmin, bmax);
+
+    return (int)_commands.size() - 1;
+}
+
+
+/*!
+ Init the geometry object
+ */
+void GLStaticBatch::init(void)
+{
+    if(_commands.size() == 0)
+    {
+        cerr << "[GLStaticBatch] - The batch is empty." << endl;
+        return;
+    }
+
+    initShader();
+    initVBO();
+}
+
+
+/*!
+ Copies the model matrices of the source objects and updates the bounds.
+ */
+void GLStaticBatch::update(void)
+{
+    bool changed = false;
+    for(int i=0; i<_objects.size(); i++)
+    {
+        const glm::mat4& m = _objects[i]->getMatrix();
+        if(memcmp(&m[0][0], &_matrices[i][0][0], sizeof(glm::mat4)) != 0)
+        {
+            _matrices[i] = m;
+            changed = true;
+        }
+    }
+
+    if(!changed) return;
+
+    _matrices_dirty = true;
+
+    // the bounds of the batch follow the objects
+    _has_bounds = false;
+    for(int i=0; i<_objects.size(); i++)
+    {
+        addBounds(_matrices[i], _draw_min[i], _draw_max[i]);
+    }
+}
+
+
+/*!
+ Returns the world space bounding box of one draw
+ */
+void GLStaticBatch::getDrawBounds(int index, glm::vec3& bmin, glm::vec3& bmax)
+{
+    glm::mat4 m = _modelMatrix * _matrices[index];
+
+    // center and half extent, the new half extent is |M| * extent
+    glm::vec3 c = glm::vec3(m * glm::vec4((_draw_min[index] + _draw_max[index]) * 0.5f, 1.0f));
+    glm::vec3 e = (_draw_max[index] - _draw_min[index]) * 0.5f;
+    glm::vec3 we;
+    for(int i=0; i<3; i++)
+    {
+        we[i] = fabs(m[0][i]) * e.x + fabs(m[1][i]) * e.y + fabs(m[2][i]) * e.z;
+    }
+
+    bmin = c - we;
+    bmax = c + we;
+}
+
+
+/*!
+ Show or hide one draw. The commands are uploaded again before the next draw.
+ */
+void GLStaticBatch::setDrawVisible(int index, bool visible)
+{
+    if(index < 0 || index >= _commands.size())
+    {
+        cerr << "[GLStaticBatch] - Draw " << index << " does not exist." << endl;
+        return;
+    }
+
+    DrawElementsIndirectCommand& cmd = _commands[index];
+
+    GLuint count = visible ? 1 : 0;
+    if(cmd.instanceCount == count) return;
+
+    cmd.instanceCount = count;
+    _num_triangles += visible ? cmd.count / 3 : -(int)(cmd.count / 3);
+    _commands_dirty = true;
+}
+
+
+/*!
+ Draw all objects with one draw call
+ */
+bool GLStaticBatch::drawGeometry(void)
+{
+    GL_PROFILE_ZONE("GLStaticBatch::drawGeometry");
+    if(!_vao.isValid()) return true;
+
+    // without indirect draws the matrices are read from _matrices
+    if(_matrices_dirty && _multi_draw_indirect)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo[2].id());
+        glBufferSubData(GL_ARRAY_BUFFER, 0, _matrices.size() * sizeof(glm::mat4), &_matrices[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    _matrices_dirty = false;
+
+    glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
+
+    // binds the vertex array and draws
+    drawVertexArray();
+
+    if(_multi_draw_indirect)
+    {
+        GLProfiler::Get().countDraw(_num_triangles);
+    }
+    else
+    {
+        for(int i=0; i<_commands.size(); i++)
+        {
+            if(_commands[i].instanceCount != 0) GLProfiler::Get().countDraw(_commands[i].count / 3);
+        }
+    }
+
+    return true;
+}
+
+
+
+/*!
+ Draws the triangles of the vertex array with the bound program
+ */
+bool GLStaticBatch::drawVertexArray(void)
+{
+    if(!_vao.isValid()) return false;
+
+    glBindVertexArray(_vao.id());
+    if(_multi_draw_indirect)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _vbo[3].id());
+
+        // hidden draws have the instance count 0
+        if(_commands_dirty)
+        {
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, _commands.size() * sizeof(DrawElementsIndirectCommand), &_commands[0]);
+            _commands_dirty = false;
+        }
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, (GLsizei)_commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        // one draw per visible object, the current value of the matrix attribute is the matrix of the draw
+        for(int i=0; i<_commands.size(); i++)
+        {
+            DrawElementsIndirectCommand& cmd = _commands[i];
+            if(cmd.instanceCount == 0) continue;
+
+            if(_drawMatrixLocation != -1)
+            {
+                for(int k=0; k<4; k++) glVertexAttrib4fv(_drawMatrixLocation + k, &_matrices[cmd.baseInstance][k][0]);
+            }
+
+            glDrawElementsBaseVertex(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT,
+                                     (const GLvoid*)(cmd.firstIndex * sizeof(GLuint)), cmd.baseVertex);
+        }
+
+        // other objects with the same shader read the identity matrix
+        if(_drawMatrixLocation != -1)
+        {
+            glVertexAttrib4f(_drawMatrixLocation + 0, 1.0f, 0.0f, 0.0f, 0.0f);
+            glVertexAttrib4f(_drawMatrixLocation + 1, 0.0f, 1.0f, 0.0f, 0.0f);
+            glVertexAttrib4f(_drawMatrixLocation + 2, 0.0f, 0.0f, 1.0f, 0.0f);
+            glVertexAttrib4f(_drawMatrixLocation + 3, 0.0f, 0.0f, 0.0f, 1.0f);
+        }
+    }
+    glBindVertexArray(0);
+
+    return true;
+}
+
+
+
+/*
+ Inits the shader program for this object
+ */
+void GLStaticBatch::initShader(void)
+{
+    if(!_apperance.exists())return;
+
+    // This loads the shader program from a file
+    _program = _apperance.getProgram();
+
+    glUseProgram(_program);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Define the model view matrix. The per-draw matrices are multiplied with this matrix
+    _modelMatrix = glm::mat4(1.0f);
+    addModelViewMatrixToProgram(_program);
+
+    glUseProgram(0);
+}
+
+
+/*!
+ Create the vertex buffer object for this element
+ */
+void GLStaticBatch::initVBO(void)
+{
+    GL_PROFILE_ZONE("GLStaticBatch::initVBO");
+    _multi_draw_indirect = (GLEW_ARB_multi_draw_indirect || GLEW_VERSION_4_3) && (GLEW_ARB_base_instance || GLEW_VERSION_4_2);
+
+    _vao.create(GLResource::VERTEX_ARRAY, "GLStaticBatch"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
+
+    _vbo[0].create(GLResource::BUFFER, "GLStaticBatch"); // Generate our Vertex Buffer Objects
+    _vbo[1].create(GLResource::BUFFER, "GLStaticBatch");
+    _vbo[2].create(GLResource::BUFFER, "GLStaticBatch");
+    _vbo[3].create(GLResource::BUFFER, "GLStaticBatch");
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // vertices, interleaved position (3), normal (3), texture coordinate (2)
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id());
+    glBufferData(GL_ARRAY_BUFFER, _vertex_data.size() * sizeof(GLfloat), &_vertex_data[0], GL_STATIC_DRAW);
+    _vbo[0].setSize(_vertex_data.size() * sizeof(GLfloat));
+
+    int locPos = glGetAttribLocation(_program, "in_Position");
+    glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), 0);
+    glEnableVertexAttribArray(locPos);
+
+    int locNorm = glGetAttribLocation(_program, "in_Normal");
+    glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (const GLvoid*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(locNorm);
+
+    int tex_idx = glGetAttribLocation(_program, "in_TexCoord");
+    if(tex_idx != -1)
+    {
+        glVertexAttribPointer((GLuint)tex_idx, 2, GL_FLOAT, GL_TRUE, 8*sizeof(GLfloat), (const GLvoid*)(6 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(tex_idx);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Indices, the binding is stored in the vertex array object
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo[1].id());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(GLuint), &_indices[0], GL_STATIC_DRAW);
+    _vbo[1].setSize(_indices.size() * sizeof(GLuint));
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // One model matrix per draw. The base instance of each command selects the matrix,
+    // without indirect draws the matrices are set per draw, see drawVertexArray().
+    if(_multi_draw_indirect)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo[2].id());
+        glBufferData(GL_ARRAY_BUFFER, _matrices.size() * sizeof(glm::mat4), &_matrices[0], GL_DYNAMIC_DRAW);
+        _vbo[2].setSize(_matrices.size() * sizeof(glm::mat4));
+    }
+    _matrices_dirty = false;
+
+    _drawMatrixLocation = glGetAttribLocation(_program, "in_DrawMatrix");
+    if(_drawMatrixLocation == -1)
+    {
+        cerr << "[GLStaticBatch] - The shader program " << _program << " has no in_DrawMatrix attribute." << endl;
+    }
+    else if(_multi_draw_indirect)
+    {
+        for(int k=0; k<4; k++)
+        {
+            glEnableVertexAttribArray(_drawMatrixLocation + k);
+            glVertexAttribPointer((GLuint)(_drawMatrixLocation + k), 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (const GLvoid*)(k * sizeof(glm::vec4)));
+            glVertexAttribDivisor(_drawMatrixLocation + k, 1);
+        }
+    }
+
+    glBindVertexArray(0); // Disable our Vertex Array Object
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Objects that use the same shader without the batch read the current
+    // attribute value, which is set to the identity matrix here.
+    if(_drawMatrixLocation != -1)
+    {
+        glVertexAttrib4f(_drawMatrixLocation + 0, 1.0f, 0.0f, 0.0f, 0.0f);
+        glVertexAttrib4f(_drawMatrixLocation + 1, 0.0f, 1.0f, 0.0f, 0.0f);
+        glVertexAttrib4f(_drawMatrixLocation + 2, 0.0f, 0.0f, 1.0f, 0.0f);
+        glVertexAttrib4f(_drawMatrixLocation + 3, 0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // The indirect commands
+    if(_multi_draw_indirect)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _vbo[3].id());
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, _commands.size() * sizeof(DrawElementsIndirectCommand), &_commands[0], GL_STATIC_DRAW);
+        _vbo[3].setSize(_commands.size() * sizeof(DrawElementsIndirectCommand));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // the geometry lives on the GPU now
+    vector<float>().swap(_vertex_data);
+    vector<GLuint>().swap(_indices);
+}
@@ -0,0 +1,189 @@
+//
+//  GLStaticBatch.h
+//  HCI557_Simple_Texture
+//
+//  Merges the geometry of several objects which share one appearance into
+//  one vertex and one index buffer and draws all of them with one
+//  glMultiDrawElementsIndirect call.
+//
+#pragma once
+
+
+// stl include
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+
+// locals
+#include "GLObject.h"
+#include "Shaders.h"
+
+#include "HCI557Datatypes.h"
+
+
+
+
+/*!
+ The batch copies the triangles of every added object (see GLObject::getTriangles)
+ into one buffer and writes one DrawElementsIndirectCommand per object.
+ The base instance of a command is the index of the draw, so the per-draw model
+ matrix is fetched from an instanced attribute:
+    in mat4 in_DrawMatrix;
+ see ../data/shaders/multi_texture_batch.vs.
+
+ The geometry is static, the matrices are not. update() copies the current model
+ matrices of the source objects, so objects moved by the scene graph move in the batch.
+ The source objects must not be drawn themselves.
+
+ Every draw can be culled on its own with setDrawVisible(), a hidden draw keeps its
+ command with the instance count 0.
+
+ Without GL_ARB_multi_draw_indirect the batch issues one glDrawElementsBaseVertex
+ per visible object from the same buffers. The matrix attribute is not an array then,
+ its current value is set to the matrix of the draw.
+ */
+class GLStaticBatch : public GLObject
+{
+public:
+
+    GLStaticBatch();
+    ~GLStaticBatch();
+
+
+    /*!
+     Add the geometry of an object. Call this before init().
+     @param object - the object, it must support getTriangles()
+     @return the index of the draw or -1 if the object cannot be batched
+     */
+    int add(GLObject* object);
+
+
+    /*!
+     Init the geometry object
+     */
+    void init(void);
+
+
+    /*!
+     Copies the model matrices of the source objects and updates the bounds.
+     Call this once per frame after the objects moved.
+     */
+    void update(void);
+
+
+    /*!
+     Draw all objects with one draw call
+     See GLObject::drawGeometry()
+     */
+    virtual bool drawGeometry(void);
+
+
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
+
+
+    /*!
+     Draws the triangles of the vertex array with the bound program,
+     one draw per object or one indirect draw
+     */
+    virtual bool drawVertexArray(void);
+
+
+    /*!
+     Returns the number of draws in this batch
+     */
+    inline int size(void){return (int)_commands.size();}
+
+
+    /*!
+     Returns the world space bounding box of one draw
+     */
+    void getDrawBounds(int index, glm::vec3& bmin, glm::vec3& bmax);
+
+
+    /*!
+     Show or hide one draw, e.g., after a frustum or occlusion test. All draws are visible by default.
+     @param index - the index of the draw, see add()
+     @param visible - false writes the instance count 0 into the command of the draw
+     */
+    void setDrawVisible(int index, bool visible);
+    inline bool isDrawVisible(int index){return _commands[index].instanceCount != 0;}
+
+
+    /*!
+     Returns true if the batch is drawn with glMultiDrawElementsIndirect
+     */
+    inline bool usesMultiDrawIndirect(void){return _multi_draw_indirect;}
+
+
+protected:
+
+    /*!
+     Create the vertex buffer object for this element
+     */
+    virtual void initVBO(void);
+
+
+    /*
+     Inits the shader program for this object
+     */
+    virtual void initShader(void);
+
+
+    // The layout of one indirect draw command, see the OpenGL 4.3 specification
+    typedef struct _DrawElementsIndirectCommand
+    {
+        GLuint  count;
+        GLuint  instanceCount;
+        GLuint  firstIndex;
+        GLint   baseVertex;
+        GLuint  baseInstance;
+    }DrawElementsIndirectCommand;
+
+
+    // the source objects and their matrices
+    vector<GLObject*>       _objects;
+    vector<glm::mat4>       _matrices;
+    bool                    _matrices_dirty;
+
+    // the bounds of every draw in model coordinates
+    vector<glm::vec3>       _draw_min;
+    vector<glm::vec3>       _draw_max;
+
+    // the merged geometry: position, normal, texture coordinate. Released after init.
+    vector<float>           _vertex_data;
+    vector<GLuint>          _indices;
+
+    // one command per object, the instance count is 0 for hidden draws
+    vector<DrawElementsIndirectCommand> _commands;
+    bool                    _commands_dirty;
+
+    // the triangles of the visible draws
+    int                     _num_triangles;
+
+    // true if glMultiDrawElementsIndirect is available
+    bool                    _multi_draw_indirect;
+
+    // the location of in_DrawMatrix
+    int                     _drawMatrixLocation;
+
+    // the program
+    GLuint                  _program;
+
+    GLResource              _vao; // Our Vertex Array Object
+    GLResource              _vbo[4]; // vertices, indices, matrices, commands
+
+};
@@ -0,0 +1,214 @@
+//
+//  GLStreamBuffer.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLStreamBuffer.h"
+#include "GLProfiler.h"
+
+
+
+/*!
+ Returns the stream buffer of this application
+ */
+GLStreamBuffer& GLStreamBuffer::Get(void)
+{
+    static GLStreamBuffer stream;
+    return stream;
+}
+
+
+GLStreamBuffer::GLStreamBuffer(GLsizeiptr frame_size)
+{
+    _frame_size = frame_size;
+    _data = NULL;
+    _persistent = false;
+    _mapped = false;
+    _range = 0;
+    _head = 0;
+    _frame = 0;
+    _warned = false;
+
+    for(int i=0; i<NUM_FRAMES; i++) _fences[i] = NULL;
+}
+
+
+GLStreamBuffer::~GLStreamBuffer()
+{
+    release();
+}
+
+
+/*!
+ Deletes the buffer and the fences
+ */
+void GLStreamBuffer::release(void)
+{
+    if(!_buffer.isValid()) return;
+
+    for(int i=0; i<NUM_FRAMES; i++)
+    {
+        if(_fences[i] != NULL) glDeleteSync(_fences[i]);
+        _fences[i] = NULL;
+    }
+
+    if(_persistent || _mapped)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _buffer.id());
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    _buffer.release();
+    _data = NULL;
+    _persistent = false;
+    _mapped = false;
+}
+
+
+/*!
+ Creates and maps the buffer
+ */
+bool GLStreamBuffer::create(void)
+{
+    GLsizeiptr size = _frame_size * NUM_FRAMES;
+
+    // errors of other code must not fail the test below
+    while(glGetError() != GL_NO_ERROR);
+
+    _buffer.create(GLResource::BUFFER, "GLStreamBuffer");
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer.id());
+
+    if(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+        _data = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+        _persistent = _data != NULL;
+    }
+
+    if(!_persistent)
+    {
+        // no immutable storage, the buffer is mapped per map() call
+        if(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+        {
+            // the failed storage must not fail the test below, the storage of a buffer cannot change
+            while(glGetError() != GL_NO_ERROR);
+            _buffer.create(GLResource::BUFFER, "GLStreamBuffer");
+            glBindBuffer(GL_ARRAY_BUFFER, _buffer.id());
+        }
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+    _buffer.setSize(size);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if(glGetError() != GL_NO_ERROR)
+    {
+        cerr << "[GLStreamBuffer] - Cannot create the stream buffer." << endl;
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+ Returns a pointer to size bytes of the range of the current frame.
+ */
+void* GLStreamBuffer::map(GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset)
+{
+    if(!_buffer.isValid() && !create()) return NULL;
+
+    // the offset in the buffer is aligned, e.g. a multiple of the vertex size for glDrawArrays(first)
+    GLsizeiptr head = alignOffset(_range, _frame_size, _head, alignment) - _range * _frame_size;
+
+    if(head + size > _frame_size)
+    {
+        if(!_warned)
+        {
+            cerr << "[GLStreamBuffer] - The frame range of " << _frame_size << " bytes is full." << endl;
+            _warned = true;
+        }
+        return NULL;
+    }
+
+    _head = head + size;
+    offset = (GLintptr)_range * _frame_size + head;
+
+    if(_persistent)
+    {
+        return _data + offset;
+    }
+
+    // the fence of this range has already been waited for, no implicit sync is needed
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer.id());
+    void* data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _mapped = data != NULL;
+    return data;
+}
+
+
+/*!
+ Ends the writes of the last map() call. A coherent mapping needs nothing.
+ */
+void GLStreamBuffer::unmap(void)
+{
+    if(!_mapped) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer.id());
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _mapped = false;
+}
+
+
+/*!
+ Ends the frame. Places a fence behind the draws of this frame and waits
+ until the GPU is done with the range of the next frame.
+ */
+void GLStreamBuffer::endFrame(void)
+{
+    _frame++;
+    if(!_buffer.isValid()) return;
+
+    GL_PROFILE_ZONE("GLStreamBuffer::endFrame");
+
+    _fences[_range] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    _range = (_range + 1) % NUM_FRAMES;
+    _head = 0;
+
+    GLsync fence = _fences[_range];
+    if(fence == NULL) return;
+
+    GLbitfield flags = 0;
+    for(;;)
+    {
+        GLenum result = glClientWaitSync(fence, flags, 1000000); // 1 ms
+        if(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+
+        // the commands of the fence must reach the GPU
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    }
+
+    glDeleteSync(fence);
+    _fences[_range] = NULL;
+}
+
+
+/*!
+ Returns the first offset at or after the head of a range that is a multiple of the alignment
+ */
+//static
+GLintptr GLStreamBuffer::alignOffset(int range, GLsizeiptr frame_size, GLsizeiptr head, GLsizeiptr alignment)
+{
+    if(alignment < 1) alignment = 1;
+
+    GLintptr offset = (GLintptr)range * frame_size + head;
+    return (offset + alignment - 1) / alignment * alignment;
+}
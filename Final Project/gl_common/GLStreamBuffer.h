@@ -0,0 +1,147 @@
+//
+//  GLStreamBuffer.h
+//  HCI557_Simple_Texture
+//
+//  A ring buffer for data that changes every frame, e.g. dynamic vertices or
+//  instance matrices. The buffer is mapped once and written directly, so the
+//  driver neither reallocates the storage nor waits for the GPU.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+
+// GLEW include
+#include <GL/glew.h>
+
+// locals
+#include "GLResource.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The buffer is divided into NUM_FRAMES equal ranges, one per frame. map() hands out
+ sub-ranges of the range of the current frame. endFrame() places a fence behind
+ the draws of the frame and moves to the next range; it only waits if the GPU still
+ reads that range, which means it is NUM_FRAMES - 1 frames behind.
+
+ With OpenGL 4.4 or ARB_buffer_storage the buffer is created with glBufferStorage and
+ mapped persistent and coherent. Otherwise every map() call maps its sub-range
+ unsynchronized with glMapBufferRange, the fences protect the data the same way.
+
+ The data of a map() call is valid until NUM_FRAMES - 1 more frames have ended.
+ Objects that do not write their data every frame must copy it into their own buffer.
+ */
+class GLStreamBuffer
+{
+public:
+
+    /*!
+     Returns the stream buffer of this application
+     */
+    static GLStreamBuffer& Get(void);
+
+
+    /*!
+     @param frame_size - the number of bytes that can be mapped per frame
+     */
+    GLStreamBuffer(GLsizeiptr frame_size = 4 * 1024 * 1024);
+    ~GLStreamBuffer();
+
+
+    /*!
+     Returns a pointer to size bytes of the range of the current frame.
+     Creates the buffer with the first call.
+     @param size - the number of bytes
+     @param alignment - the alignment of the offset, e.g. the size of a vertex
+     @param offset - returns the offset of the sub-range in the buffer, e.g. for glVertexAttribPointer
+     @return the pointer or NULL if the range of the frame is full
+     */
+    void* map(GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset);
+
+
+    /*!
+     Ends the writes of the last map() call. Call it before the data is used.
+     */
+    void unmap(void);
+
+
+    /*!
+     Ends the frame. Call this once per frame after all draws that read the buffer.
+     */
+    void endFrame(void);
+
+
+    /*!
+     Deletes the buffer and the fences. Call this before the context is destroyed.
+     */
+    void release(void);
+
+
+    /*!
+     Returns the buffer id, 0 before the first map() call
+     */
+    inline GLuint getID(void){return _buffer.id();}
+
+
+    /*!
+     Returns the number of endFrame() calls
+     */
+    inline unsigned int getFrame(void){return _frame;}
+
+
+    /*!
+     Returns true if the buffer is mapped persistent
+     */
+    inline bool isPersistent(void){return _persistent;}
+
+
+    /*!
+     Returns the first offset at or after the head of a range that is a multiple of the
+     alignment. The offset is aligned in the whole buffer, the ranges of a frame size which
+     is not a multiple of the alignment start at unaligned offsets.
+     @param range - the range of the frame
+     @param frame_size - the size of a range
+     @param head - the next free byte in the range
+     @param alignment - the alignment, e.g. the size of a vertex
+     */
+    static GLintptr alignOffset(int range, GLsizeiptr frame_size, GLsizeiptr head, GLsizeiptr alignment);
+
+
+    // the number of frames the ring can hold
+    static const int NUM_FRAMES = 3;
+
+
+private:
+
+    /*!
+     Creates and maps the buffer
+     */
+    bool create(void);
+
+
+    // all ranges, the content changes every frame and the buffer is never evicted
+    GLResource      _buffer;
+    GLsizeiptr      _frame_size;
+
+    // the persistent pointer to the whole buffer, NULL without buffer storage
+    char*           _data;
+    bool            _persistent;
+
+    // the sub-range mapped with glMapBufferRange
+    bool            _mapped;
+
+    // the range of the current frame and the next free byte in it
+    int             _range;
+    GLsizeiptr      _head;
+
+    // one fence per range, NULL if the GPU is done with the range
+    GLsync          _fences[NUM_FRAMES];
+
+    unsigned int    _frame;
+    bool            _warned;
+};
@@ -72,16 +72,18 @@ void GLSurface::initVBO(void)
     
     
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
+    _vao.create(GLResource::VERTEX_ARRAY, "GLSurface"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
     
-    glGenBuffers(2, _vboID); // Generate our Vertex Buffer Object
+    _vbo[0].create(GLResource::BUFFER, "GLSurface"); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, "GLSurface");
     
     // vertices
     int locPos = glGetAttribLocation(_program, "in_Position");
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 * sizeof(GLfloat), vertices, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[0].setSize(_num_vertices * 3 * sizeof(GLfloat));
     
     glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(locPos); //
@@ -89,8 +91,9 @@ void GLSurface::initVBO(void)
     
      // normals
     int locNorm = glGetAttribLocation(_program, "in_Normal");
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _normals.size() * 3 * sizeof(GLfloat), &normals[0], GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[1].setSize(_normals.size() * 3 * sizeof(GLfloat));
     
     glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
     glEnableVertexAttribArray(locNorm); //
@@ -98,6 +101,10 @@ void GLSurface::initVBO(void)
 
     
     glBindVertexArray(0); // Disable our Vertex Buffer Object
+    
+    // delete the memory
+    delete[] vertices;
+    delete[] normals;
 
 }
 
@@ -141,32 +148,23 @@ void GLSurface::initShader(void)
 /*!
  Draw the objects
  */
-void GLSurface::draw(void)
+bool GLSurface::drawGeometry(void)
 {
     
-    glUseProgram(_program);
-
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
-    
+    glBindVertexArray(_vao.id());
     
-    // this changes the camera location
-    glm::mat4 rotated_view =  rotatedViewMatrix();
-    glUniformMatrix4fv(_viewMatrixLocation, 1, GL_FALSE, &rotated_view[0][0]); // send the view matrix to our shader
-    glUniformMatrix4fv(_inverseViewMatrixLocation, 1, GL_FALSE, &invRotatedViewMatrix()[0][0]);
     glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
 
-    
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
     
     // Draw the triangles
     glDrawArrays(GL_TRIANGLES, 0, _num_vertices);
     
-    
-    
     // Unbind our Vertex Array Object
     glBindVertexArray(0);
     
+    return true;
 }
 
 
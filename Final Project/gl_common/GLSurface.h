@@ -41,9 +41,16 @@ public:
     
     
     /*!
-     Draw the objects
+     Draw the objects with the bound program and textures
+     See GLObject::drawGeometry()
      */
-    void draw(void);
+    virtual bool drawGeometry(void);
+
+    
+    /*!
+     Returns the vertex array object of this object
+     */
+    virtual GLuint getVertexArray(void){return _vao.id();}
     
     
     /*!
@@ -89,8 +96,8 @@ private:
     
     int                     _num_vertices;
     
-    unsigned int            _vaoID[1]; // Our Vertex Array Object
+    GLResource              _vao; // Our Vertex Array Object
     
-    unsigned int            _vboID[2]; // Our Vertex Buffer Object
+    GLResource              _vbo[2]; // Our Vertex Buffer Object
 
 };
\ No newline at end of file
@@ -0,0 +1,687 @@
+//
+//  GLTerrain.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLTerrain.h"
+#include "GLProfiler.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <memory>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// the floats of one vertex: position, normal, texture coordinate
+static const int VERTEX_SIZE = 8;
+
+
+
+GLTerrain::GLTerrain(HeightFunction height, float root_size, int levels)
+{
+    _height = height;
+    _root_size = root_size;
+    _levels = std::max(1, std::min(levels, 16));
+    _view_distance = 1024.0f;
+    _lod_factor = 2.0f;
+    _texture_scale = 16.0f;
+    _uploads_per_frame = 4;
+
+    _limited = false;
+    _limit_min = glm::vec2(0.0f);
+    _limit_max = glm::vec2(0.0f);
+
+    _program = 0;
+    _num_indices = 0;
+
+    _eye = glm::vec3(0.0f);
+    _frame = 0;
+    _num_resident = 0;
+    _num_pending = 0;
+    _quit = false;
+}
+
+
+GLTerrain::~GLTerrain()
+{
+    if(_loader.joinable())
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _wake.notify_all();
+        _loader.join();
+    }
+
+    // the queues only hold chunks of the map
+    map<uint64_t, Chunk*>::iterator itr = _chunks.begin();
+    while(itr != _chunks.end())
+    {
+        delete itr->second;
+        itr++;
+    }
+    _chunks.clear();
+}
+
+
+/*!
+ Init the shader program and the shared index buffer, starts the loader thread
+ */
+void GLTerrain::init(void)
+{
+    initShader();
+    initVBO();
+
+    if(!_loader.joinable())
+    {
+        _loader = std::thread(&GLTerrain::loaderLoop, this);
+    }
+}
+
+
+/*!
+ Limits the terrain to a rectangle
+ */
+void GLTerrain::setLimits(float min_x, float min_z, float max_x, float max_z)
+{
+    _limited = true;
+    _limit_min = glm::vec2(min_x, min_z);
+    _limit_max = glm::vec2(max_x, max_z);
+}
+
+
+/*!
+ Returns the number of triangles of the chunks drawn in the last frame
+ */
+int GLTerrain::numTriangles(void)
+{
+    return (int)_visible.size() * _num_indices / 3;
+}
+
+
+/*
+ Inits the shader program for this object
+ */
+void GLTerrain::initShader(void)
+{
+    if(!_apperance.exists())return;
+
+    // This loads the shader program from a file
+    _program = _apperance.getProgram();
+
+    glUseProgram(_program);
+    addModelViewMatrixToProgram(_program);
+    glUseProgram(0);
+}
+
+
+/*!
+ Creates the index buffer all chunks share. The grid vertices come first,
+ row by row, followed by the skirt vertices of the four sides.
+ */
+void GLTerrain::initVBO(void)
+{
+    GL_PROFILE_ZONE("GLTerrain::initVBO");
+
+    const int row = GRID + 1;
+    const int skirt = row * row;
+
+    vector<GLushort> indices;
+    indices.reserve(GRID * GRID * 6 + 4 * GRID * 6);
+
+    for(int z=0; z<GRID; z++)
+    {
+        for(int x=0; x<GRID; x++)
+        {
+            GLushort a = z * row + x;
+            GLushort b = a + 1;
+            GLushort c = a + row;
+            GLushort d = c + 1;
+
+            indices.push_back(a); indices.push_back(c); indices.push_back(b);
+            indices.push_back(b); indices.push_back(c); indices.push_back(d);
+        }
+    }
+
+    // the border vertex k of a side: 0 is z = 0, 1 is x = GRID, 2 is z = GRID, 3 is x = 0
+    for(int side=0; side<4; side++)
+    {
+        for(int k=0; k<GRID; k++)
+        {
+            GLushort b0, b1;
+            switch(side)
+            {
+                case 0: b0 = k; b1 = k + 1; break;
+                case 1: b0 = k * row + GRID; b1 = (k + 1) * row + GRID; break;
+                case 2: b0 = GRID * row + k; b1 = GRID * row + k + 1; break;
+                default: b0 = k * row; b1 = (k + 1) * row; break;
+            }
+            GLushort s0 = skirt + side * row + k;
+            GLushort s1 = s0 + 1;
+
+            indices.push_back(b0); indices.push_back(s0); indices.push_back(b1);
+            indices.push_back(b1); indices.push_back(s0); indices.push_back(s1);
+        }
+    }
+
+    _num_indices = (int)indices.size();
+
+    // bound as element buffer by the vertex array of every chunk
+    _ibo.create(GLResource::BUFFER, "GLTerrain");
+    glBindBuffer(GL_ARRAY_BUFFER, _ibo.id());
+    glBufferData(GL_ARRAY_BUFFER, _num_indices * sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+    _ibo.setSize(_num_indices * sizeof(GLushort));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+/*!
+ Returns the key of a node in the chunk map
+ */
+uint64_t GLTerrain::Key(int level, int x, int z)
+{
+    const uint64_t mask = (1 << 28) - 1;
+    return ((uint64_t)level << 56) | ((uint64_t)((x + (1 << 27)) & mask) << 28) | (uint64_t)((z + (1 << 27)) & mask);
+}
+
+
+/*!
+ Returns the chunk of a node, creates it if needed and requests missing chunks
+ */
+GLTerrain::Chunk* GLTerrain::request(int level, int x, int z)
+{
+    uint64_t key = Key(level, x, z);
+
+    Chunk* chunk = NULL;
+    map<uint64_t, Chunk*>::iterator itr = _chunks.find(key);
+    if(itr == _chunks.end())
+    {
+        chunk = new Chunk();
+        chunk->level = level;
+        chunk->x = x;
+        chunk->z = z;
+        chunk->state = IDLE;
+        _chunks[key] = chunk;
+    }
+    else
+    {
+        chunk = itr->second;
+    }
+
+    chunk->last_used = _frame;
+    if(chunk->state == IDLE)
+    {
+        chunk->state = PENDING;
+        _requested.push_back(chunk);
+    }
+
+    return chunk;
+}
+
+
+/*!
+ Selects the chunks of this frame
+ */
+void GLTerrain::update(const glm::mat4& view_projection)
+{
+    GL_PROFILE_ZONE("GLTerrain::update");
+
+    _frame++;
+
+    // the camera in model coordinates
+    _eye = glm::vec3(glm::inverse(_modelMatrix) * invRotatedViewMatrix()[3]);
+
+    // the frustum planes in model coordinates, a * x + b * y + c * z + d >= 0 inside
+    glm::mat4 m = view_projection * _modelMatrix;
+    for(int i=0; i<3; i++)
+    {
+        glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+        _planes[i * 2] = w + row;
+        _planes[i * 2 + 1] = w - row;
+    }
+
+    // take the finished chunks, the queue is rebuilt in the order of this frame
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for(int i=0; i<_queue.size(); i++) _queue[i]->state = IDLE;
+        _queue.clear();
+
+        for(int i=0; i<_loaded.size(); i++) _uploads.push_back(_loaded[i]);
+        _loaded.clear();
+    }
+
+    for(int i=0; i<_uploads_per_frame && !_uploads.empty(); i++)
+    {
+        upload(_uploads.front());
+        _uploads.pop_front();
+    }
+
+    // the root tiles around the camera
+    _visible.clear();
+    _requested.clear();
+
+    int min_x = (int)floor((_eye.x - _view_distance) / _root_size);
+    int max_x = (int)floor((_eye.x + _view_distance) / _root_size);
+    int min_z = (int)floor((_eye.z - _view_distance) / _root_size);
+    int max_z = (int)floor((_eye.z + _view_distance) / _root_size);
+
+    for(int z=min_z; z<=max_z; z++)
+    {
+        for(int x=min_x; x<=max_x; x++)
+        {
+            glm::vec2 tmin(x * _root_size, z * _root_size);
+            glm::vec2 tmax = tmin + glm::vec2(_root_size);
+
+            if(_limited && (tmax.x <= _limit_min.x || tmin.x >= _limit_max.x ||
+                            tmax.y <= _limit_min.y || tmin.y >= _limit_max.y)) continue;
+
+            float dx = std::max(std::max(tmin.x - _eye.x, 0.0f), _eye.x - tmax.x);
+            float dz = std::max(std::max(tmin.y - _eye.z, 0.0f), _eye.z - tmax.y);
+            if(dx * dx + dz * dz > _view_distance * _view_distance) continue;
+
+            select(0, x, z);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for(int i=0; i<_requested.size(); i++) _queue.push_back(_requested[i]);
+        _num_pending = (int)(_queue.size() + _uploads.size());
+    }
+    if(!_requested.empty()) _wake.notify_one();
+
+    collect();
+}
+
+
+/*!
+ Selects the chunks to draw below a node
+ */
+void GLTerrain::select(int level, int x, int z)
+{
+    float size = _root_size / (float)(1 << level);
+    Chunk* chunk = request(level, x, z);
+
+    // the height is unknown until the chunk is built
+    glm::vec3 bmin(x * size, -1.0e6f, z * size);
+    glm::vec3 bmax(bmin.x + size, 1.0e6f, bmin.z + size);
+    if(chunk->state == RESIDENT)
+    {
+        bmin = chunk->bmin;
+        bmax = chunk->bmax;
+    }
+
+    if(!isInFrustum(bmin, bmax)) return;
+
+    // the children are loaded after their parent, so the detail grows from coarse to fine
+    glm::vec3 d = glm::max(glm::max(bmin - _eye, _eye - bmax), glm::vec3(0.0f));
+    if(chunk->state == RESIDENT && level + 1 < _levels && glm::length(d) < _lod_factor * size)
+    {
+        bool loaded = true;
+        for(int i=0; i<4; i++)
+        {
+            Chunk* child = request(level + 1, x * 2 + (i & 1), z * 2 + (i >> 1));
+            if(child->state != RESIDENT) loaded = false;
+        }
+
+        if(loaded)
+        {
+            for(int i=0; i<4; i++) select(level + 1, x * 2 + (i & 1), z * 2 + (i >> 1));
+            return;
+        }
+    }
+
+    if(chunk->state == RESIDENT) _visible.push_back(chunk);
+}
+
+
+/*!
+ Returns true if the box intersects the view frustum
+ */
+bool GLTerrain::isInFrustum(const glm::vec3& bmin, const glm::vec3& bmax)
+{
+    for(int i=0; i<6; i++)
+    {
+        // the corner furthest along the plane normal
+        const glm::vec4& p = _planes[i];
+        glm::vec3 v(p.x >= 0.0f ? bmax.x : bmin.x,
+                    p.y >= 0.0f ? bmax.y : bmin.y,
+                    p.z >= 0.0f ? bmax.z : bmin.z);
+        if(p.x * v.x + p.y * v.y + p.z * v.z + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
+
+/*!
+ Builds the vertices and bounds of a chunk, called on the loader thread
+ */
+void GLTerrain::build(Chunk* chunk)
+{
+    const int row = GRID + 1;
+    float size = _root_size / (float)(1 << chunk->level);
+    float cell = size / GRID;
+    float x0 = chunk->x * size;
+    float z0 = chunk->z * size;
+
+    // the heights with one extra ring for the normal vectors
+    const int ring = GRID + 3;
+    vector<float> h(ring * ring);
+    for(int z=0; z<ring; z++)
+    {
+        for(int x=0; x<ring; x++)
+        {
+            h[z * ring + x] = _height(x0 + (x - 1) * cell, z0 + (z - 1) * cell);
+        }
+    }
+
+    #define HEIGHT(x, z) h[((z) + 1) * ring + (x) + 1]
+
+    // the largest error of the border against the next coarser and the next finer level
+    float error = 0.0f;
+    for(int k=0; k<GRID; k++)
+    {
+        float border[4][3] = {
+            { HEIGHT(k, 0),    HEIGHT(k + 1, 0),    _height(x0 + (k + 0.5f) * cell, z0) },
+            { HEIGHT(GRID, k), HEIGHT(GRID, k + 1), _height(x0 + size, z0 + (k + 0.5f) * cell) },
+            { HEIGHT(k, GRID), HEIGHT(k + 1, GRID), _height(x0 + (k + 0.5f) * cell, z0 + size) },
+            { HEIGHT(0, k),    HEIGHT(0, k + 1),    _height(x0, z0 + (k + 0.5f) * cell) } };
+
+        for(int side=0; side<4; side++)
+        {
+            error = std::max(error, fabs(border[side][2] - (border[side][0] + border[side][1]) * 0.5f));
+        }
+
+        if(k % 2 == 1)
+        {
+            error = std::max(error, fabs(HEIGHT(k, 0) - (HEIGHT(k - 1, 0) + HEIGHT(k + 1, 0)) * 0.5f));
+            error = std::max(error, fabs(HEIGHT(GRID, k) - (HEIGHT(GRID, k - 1) + HEIGHT(GRID, k + 1)) * 0.5f));
+            error = std::max(error, fabs(HEIGHT(k, GRID) - (HEIGHT(k - 1, GRID) + HEIGHT(k + 1, GRID)) * 0.5f));
+            error = std::max(error, fabs(HEIGHT(0, k) - (HEIGHT(0, k - 1) + HEIGHT(0, k + 1)) * 0.5f));
+        }
+    }
+    float skirt_depth = error * 2.0f + cell * 0.05f;
+
+    vector<float>& v = chunk->vertices;
+    v.resize((row * row + 4 * row) * VERTEX_SIZE);
+
+    float min_h = HEIGHT(0, 0);
+    float max_h = min_h;
+
+    for(int z=0; z<row; z++)
+    {
+        for(int x=0; x<row; x++)
+        {
+            float* p = &v[(z * row + x) * VERTEX_SIZE];
+            float y = HEIGHT(x, z);
+
+            glm::vec3 n = glm::normalize(glm::vec3(HEIGHT(x - 1, z) - HEIGHT(x + 1, z), 2.0f * cell,
+                                                   HEIGHT(x, z - 1) - HEIGHT(x, z + 1)));
+
+            p[0] = x0 + x * cell; p[1] = y; p[2] = z0 + z * cell;
+            p[3] = n.x; p[4] = n.y; p[5] = n.z;
+            p[6] = p[0] / _texture_scale; p[7] = p[2] / _texture_scale;
+
+            min_h = std::min(min_h, y);
+            max_h = std::max(max_h, y);
+        }
+    }
+
+    #undef HEIGHT
+
+    // the skirt copies the border and moves it down
+    for(int side=0; side<4; side++)
+    {
+        for(int k=0; k<row; k++)
+        {
+            int b;
+            switch(side)
+            {
+                case 0: b = k; break;
+                case 1: b = k * row + GRID; break;
+                case 2: b = GRID * row + k; break;
+                default: b = k * row; break;
+            }
+
+            float* p = &v[(row * row + side * row + k) * VERTEX_SIZE];
+            memcpy(p, &v[b * VERTEX_SIZE], VERTEX_SIZE * sizeof(float));
+            p[1] -= skirt_depth;
+        }
+    }
+
+    chunk->bmin = glm::vec3(x0, min_h - skirt_depth, z0);
+    chunk->bmax = glm::vec3(x0 + size, max_h, z0 + size);
+}
+
+
+/*!
+ Creates the vertex array of a loaded chunk
+ */
+void GLTerrain::upload(Chunk* chunk)
+{
+    GLsizeiptr bytes = chunk->vertices.size() * sizeof(float);
+
+    chunk->vao.create(GLResource::VERTEX_ARRAY, "GLTerrain");
+    glBindVertexArray(chunk->vao.id());
+
+    chunk->vbo.create(GLResource::BUFFER, "GLTerrain");
+    glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo.id());
+    glBufferData(GL_ARRAY_BUFFER, bytes, &chunk->vertices[0], GL_STATIC_DRAW);
+    chunk->vbo.setSize(bytes);
+
+    int locPos = glGetAttribLocation(_program, "in_Position");
+    int locNorm = glGetAttribLocation(_program, "in_Normal");
+    int tex_idx = glGetAttribLocation(_program, "in_TexCoord");
+
+    if(locPos >= 0)
+    {
+        glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE * sizeof(GLfloat), 0);
+        glEnableVertexAttribArray(locPos);
+    }
+    if(locNorm >= 0)
+    {
+        glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE * sizeof(GLfloat),
+                              (const GLvoid*)(3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(locNorm);
+    }
+    if(tex_idx >= 0)
+    {
+        glVertexAttribPointer((GLuint)tex_idx, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE * sizeof(GLfloat),
+                              (const GLvoid*)(6 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(tex_idx);
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo.id());
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // the gpu has the copy
+    vector<float>().swap(chunk->vertices);
+
+    chunk->state = RESIDENT;
+    _num_resident++;
+}
+
+
+/*!
+ Deletes chunks that were not used for KEEP_FRAMES frames
+ */
+void GLTerrain::collect(void)
+{
+    map<uint64_t, Chunk*>::iterator itr = _chunks.begin();
+    while(itr != _chunks.end())
+    {
+        Chunk* chunk = itr->second;
+
+        // a pending chunk is still referenced by the loader or the upload queue
+        if(chunk->state != PENDING && _frame - chunk->last_used > KEEP_FRAMES)
+        {
+            if(chunk->state == RESIDENT) _num_resident--;
+            delete chunk;
+            itr = _chunks.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+}
+
+
+/*!
+ The loop of the loader thread
+ */
+void GLTerrain::loaderLoop(void)
+{
+    for(;;)
+    {
+        Chunk* chunk = NULL;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this]{return _quit || !_queue.empty();});
+            if(_quit) return;
+            chunk = _queue.front();
+            _queue.pop_front();
+        }
+
+        build(chunk);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _loaded.push_back(chunk);
+        }
+    }
+}
+
+
+/*!
+ Draw the chunks of the last update() call
+ */
+bool GLTerrain::drawGeometry(void)
+{
+    GL_PROFILE_ZONE("GLTerrain::drawGeometry");
+
+    if(_visible.empty()) return true;
+
+    glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
+
+    for(int i=0; i<_visible.size(); i++)
+    {
+        glBindVertexArray(_visible[i]->vao.id());
+        glDrawElements(GL_TRIANGLES, _num_indices, GL_UNSIGNED_SHORT, 0);
+        GLProfiler::Get().countDraw(_num_indices / 3);
+    }
+
+    // Unbind our Vertex Array Object
+    glBindVertexArray(0);
+
+    return true;
+}
+
+
+
+
+/*!
+ Returns the value noise of the lattice point x, z in [0, 1]
+ */
+static float LatticeValue(int x, int z, unsigned int seed)
+{
+    unsigned int h = (unsigned int)x * 374761393u + (unsigned int)z * 668265263u + seed * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+    return (h & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+
+/*!
+ Returns the smooth interpolated value noise at x, z in [0, 1]
+ */
+static float ValueNoise(float x, float z, unsigned int seed)
+{
+    float fx = floor(x);
+    float fz = floor(z);
+    int ix = (int)fx;
+    int iz = (int)fz;
+
+    // smoothstep, the slope is continuous at the lattice points
+    float tx = x - fx;
+    float tz = z - fz;
+    tx = tx * tx * (3.0f - 2.0f * tx);
+    tz = tz * tz * (3.0f - 2.0f * tz);
+
+    float a = LatticeValue(ix, iz, seed);
+    float b = LatticeValue(ix + 1, iz, seed);
+    float c = LatticeValue(ix, iz + 1, seed);
+    float d = LatticeValue(ix + 1, iz + 1, seed);
+
+    return (a + (b - a) * tx) + ((c + (d - c) * tx) - (a + (b - a) * tx)) * tz;
+}
+
+
+/*!
+ Returns a height function of value noise with several octaves
+ */
+GLTerrain::HeightFunction GLTerrain::NoiseHeight(float amplitude, float wavelength, int octaves, unsigned int seed)
+{
+    octaves = std::max(octaves, 1);
+
+    return [=](float x, float z) -> float
+    {
+        float sum = 0.0f;
+        float weight = 0.0f;
+        float a = 1.0f;
+        float f = 1.0f / wavelength;
+        for(int i=0; i<octaves; i++)
+        {
+            sum += a * ValueNoise(x * f, z * f, seed + i);
+            weight += a;
+            a *= 0.5f;
+            f *= 2.0f;
+        }
+        return amplitude * sum / weight;
+    };
+}
+
+
+/*!
+ Returns a height function of a bmp file
+ */
+GLTerrain::HeightFunction GLTerrain::BitmapHeight(string path_and_file, float size, float height)
+{
+    unsigned int channels = 0, width = 0, rows = 0;
+    unsigned char* data = loadBitmapFile(path_and_file, channels, width, rows);
+    if(data == NULL || width < 2 || rows < 2)
+    {
+        cerr << "[GLTerrain] - Cannot read the height map " << path_and_file << "." << endl;
+        if(data != NULL) free(data);
+        return [](float, float) -> float {return 0.0f;};
+    }
+
+    // the first channel of every pixel, shared by all copies of the function
+    std::shared_ptr< vector<float> > heights(new vector<float>(width * rows));
+    for(unsigned int i=0; i<width * rows; i++) (*heights)[i] = data[i * channels] / 255.0f * height;
+    free(data);
+
+    return [=](float x, float z) -> float
+    {
+        float u = std::max(0.0f, std::min((x / size + 0.5f) * (width - 1), (float)(width - 2) + 0.9999f));
+        float v = std::max(0.0f, std::min((z / size + 0.5f) * (rows - 1), (float)(rows - 2) + 0.9999f));
+        int iu = (int)u;
+        int iv = (int)v;
+        u -= iu;
+        v -= iv;
+
+        const vector<float>& m = *heights;
+        float a = m[iv * width + iu];
+        float b = m[iv * width + iu + 1];
+        float c = m[(iv + 1) * width + iu];
+        float d = m[(iv + 1) * width + iu + 1];
+
+        return (a + (b - a) * u) + ((c + (d - c) * u) - (a + (b - a) * u)) * v;
+    };
+}
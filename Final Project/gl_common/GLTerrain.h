@@ -0,0 +1,307 @@
+//
+//  GLTerrain.h
+//  HCI557_Simple_Texture
+//
+//  A heightfield terrain of square chunks in a quadtree of detail levels.
+//  The chunks around the camera are built on a background thread and
+//  uploaded a few per frame, chunks out of view distance are deleted, so
+//  memory and triangles follow the view distance instead of the map size.
+//
+#pragma once
+
+// stl include
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// locals
+#include "GLObject.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The terrain lies in the x-z plane of the model matrix, y is the height.
+ It is divided into root tiles of getRootSize() units. Every tile is a quadtree,
+ a node of level l covers root_size / 2^l units and every node is one chunk with
+ GRID x GRID quads, so each level doubles the detail.
+
+ update() selects the chunks of a frame: a node is split if the camera is closer
+ than lod_factor * node size and all four children are loaded. Otherwise the
+ node itself is drawn. Missing chunks are requested from the loader thread,
+ which calls the height function and builds the vertices; update() uploads up
+ to getUploadsPerFrame() finished chunks. Chunks that were not needed for
+ a few frames are deleted.
+
+ Neighbours of different levels do not share their border vertices. Every chunk
+ has a skirt, a strip along its border that hangs down below the surface and
+ hides the cracks. The skirt depth is the largest error of the border against
+ the next coarser level.
+
+ The height function is called on the loader thread and must be thread-safe.
+ */
+class GLTerrain : public GLObject
+{
+public:
+
+    /*!
+     Returns the height at the position x, z in model coordinates
+     */
+    typedef std::function<float(float x, float z)> HeightFunction;
+
+
+    /*!
+     @param height - the height function, called from the loader thread
+     @param root_size - the edge length of a root tile
+     @param levels - the number of levels, the finest chunks are root_size / 2^(levels-1) units
+     */
+    GLTerrain(HeightFunction height, float root_size = 512.0f, int levels = 5);
+    ~GLTerrain();
+
+
+    /*!
+     Init the shader program and the shared index buffer, starts the loader thread
+     */
+    void init(void);
+
+
+    /*!
+     Draw the chunks of the last update() call
+     See GLObject::drawGeometry()
+     */
+    virtual bool drawGeometry(void);
+
+
+    /*!
+     Selects the chunks of this frame, requests the missing ones, uploads
+     finished chunks and deletes the unused ones. Call this once per frame.
+     @param view_projection - the projection matrix * view matrix, see GetViewProjectionMatrix()
+     */
+    void update(const glm::mat4& view_projection);
+
+
+    /*!
+     Set the distance around the camera in which root tiles are loaded, default 1024
+     */
+    inline void setViewDistance(float distance){_view_distance = distance;}
+    inline float getViewDistance(void){return _view_distance;}
+
+
+    /*!
+     A node is split if the camera is closer than factor * node size, default 2
+     */
+    inline void setLODFactor(float factor){_lod_factor = factor;}
+
+
+    /*!
+     Limits the terrain to the rectangle [min_x, max_x] x [min_z, max_z], e.g. the size of a height map.
+     Without limits the terrain continues in all directions.
+     */
+    void setLimits(float min_x, float min_z, float max_x, float max_z);
+
+
+    /*!
+     Set the number of chunks uploaded per frame, default 4
+     */
+    inline void setUploadsPerFrame(int count){_uploads_per_frame = count < 1 ? 1 : count;}
+    inline int getUploadsPerFrame(void){return _uploads_per_frame;}
+
+
+    /*!
+     Set the size of one texture repeat in units, default 16
+     */
+    inline void setTextureScale(float units){_texture_scale = units;}
+
+
+    /*!
+     Returns the edge length of a root tile
+     */
+    inline float getRootSize(void){return _root_size;}
+
+
+    /*!
+     Returns the number of chunks on the GPU, drawn in the last frame, and waiting for the loader
+     */
+    inline int numResident(void){return _num_resident;}
+    inline int numVisible(void){return (int)_visible.size();}
+    inline int numPending(void){return _num_pending;}
+
+
+    /*!
+     Returns the number of triangles of the chunks drawn in the last frame
+     */
+    int numTriangles(void);
+
+
+    /*!
+     Returns a height function of value noise with several octaves
+     @param amplitude - the largest height
+     @param wavelength - the wavelength of the first octave in units
+     @param octaves - the number of octaves, each one with half the wavelength and amplitude
+     @param seed - the seed of the noise
+     */
+    static HeightFunction NoiseHeight(float amplitude, float wavelength, int octaves, unsigned int seed);
+
+
+    /*!
+     Returns a height function of a bmp file, the map is bilinear filtered and
+     covers [-size/2, size/2] in x and z. Outside, the border heights continue.
+     @param height - the height of a white pixel
+     */
+    static HeightFunction BitmapHeight(string path_and_file, float size, float height);
+
+
+    // the number of quads along the edge of a chunk
+    static const int GRID = 32;
+
+    // the number of frames an unused chunk is kept
+    static const int KEEP_FRAMES = 30;
+
+
+private:
+
+    typedef enum _ChunkState
+    {
+        IDLE = 0,   // known, but not requested
+        PENDING,    // in the queue of the loader, in the loader, or waiting for the upload
+        RESIDENT    // on the GPU
+    }ChunkState;
+
+
+    typedef struct _Chunk
+    {
+        int             level;
+        int             x;
+        int             z;
+        ChunkState      state;
+        unsigned int    last_used;
+
+        // the local bounds, y is known when the chunk is built
+        glm::vec3       bmin;
+        glm::vec3       bmax;
+
+        // built by the loader, released after the upload
+        vector<float>   vertices;
+
+        GLResource      vao;
+        GLResource      vbo;
+    }Chunk;
+
+
+    /*!
+     Create the vertex buffer object for this element
+     */
+    virtual void initVBO(void);
+
+    /*
+     Inits the shader program for this object
+     */
+    virtual void initShader(void);
+
+
+    /*!
+     Returns the chunk of a node, creates it if needed and requests missing chunks.
+     Marks the chunk as used in this frame.
+     */
+    Chunk* request(int level, int x, int z);
+
+
+    /*!
+     Selects the chunks to draw below a node
+     */
+    void select(int level, int x, int z);
+
+
+    /*!
+     Returns true if the box intersects the view frustum
+     */
+    bool isInFrustum(const glm::vec3& bmin, const glm::vec3& bmax);
+
+
+    /*!
+     Builds the vertices and bounds of a chunk, called on the loader thread
+     */
+    void build(Chunk* chunk);
+
+
+    /*!
+     Creates the vertex array of a loaded chunk
+     */
+    void upload(Chunk* chunk);
+
+
+    /*!
+     Deletes chunks that were not used for KEEP_FRAMES frames
+     */
+    void collect(void);
+
+
+    /*!
+     The loop of the loader thread
+     */
+    void loaderLoop(void);
+
+
+    /*!
+     Returns the key of a node in the chunk map
+     */
+    static uint64_t Key(int level, int x, int z);
+
+
+    HeightFunction          _height;
+    float                   _root_size;
+    int                     _levels;
+    float                   _view_distance;
+    float                   _lod_factor;
+    float                   _texture_scale;
+    int                     _uploads_per_frame;
+
+    bool                    _limited;
+    glm::vec2               _limit_min;
+    glm::vec2               _limit_max;
+
+    // the program
+    GLuint                  _program;
+
+    // one index buffer for all chunks, the grid followed by the skirt
+    GLResource              _ibo;
+    int                     _num_indices;
+
+    // all known chunks, owned by this object
+    map<uint64_t, Chunk*>   _chunks;
+
+    // the chunks of the current frame
+    vector<Chunk*>          _visible;
+    vector<Chunk*>          _requested;
+    deque<Chunk*>           _uploads;
+    glm::vec3               _eye;
+    glm::vec4               _planes[6];
+    unsigned int            _frame;
+    int                     _num_resident;
+    int                     _num_pending;
+
+    // shared with the loader thread
+    std::thread             _loader;
+    std::mutex              _mutex;
+    std::condition_variable _wake;
+    deque<Chunk*>           _queue;
+    vector<Chunk*>          _loaded;
+    bool                    _quit;
+};
@@ -0,0 +1,183 @@
+//
+//  GLThreadPool.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLThreadPool.h"
+
+#include <algorithm>
+
+
+int GLThreadPool::_default_threads = 0;
+
+
+// the pool and the thread index of the job that runs on this thread, NULL outside of jobs
+static thread_local const GLThreadPool* t_pool = NULL;
+static thread_local int t_thread_index = 0;
+
+
+/*!
+ Returns the pool of this application
+ */
+GLThreadPool& GLThreadPool::Get(void)
+{
+    static GLThreadPool pool(_default_threads);
+    return pool;
+}
+
+
+/*!
+ Set the number of threads of the pool returned by Get()
+ */
+void GLThreadPool::SetDefaultThreads(int num_threads)
+{
+    _default_threads = num_threads;
+}
+
+
+GLThreadPool::GLThreadPool(int num_threads)
+{
+    _job = NULL;
+    _count = 0;
+    _chunk_size = 1;
+    _next = 0;
+    _active = 0;
+    _generation = 0;
+    _busy = false;
+    _quit = false;
+
+    if(num_threads <= 0)
+    {
+        num_threads = std::min(std::max((int)std::thread::hardware_concurrency(), 1), 8);
+    }
+
+    for(int i=1; i<num_threads; i++)
+    {
+        _workers.push_back(std::thread(&GLThreadPool::workerLoop, this, i));
+    }
+}
+
+
+GLThreadPool::~GLThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+
+    for(int i=0; i<_workers.size(); i++) _workers[i].join();
+}
+
+
+/*!
+ Runs the job for all items [0, count) and waits until all chunks are done.
+ */
+void GLThreadPool::parallelFor(int count, int chunk_size, const RangeJob& job)
+{
+    if(count <= 0) return;
+    if(chunk_size < 1) chunk_size = 1;
+
+    // a nested call stays on this thread and keeps its index, the outer job owns the other threads
+    if(t_pool == this)
+    {
+        job(0, count, t_thread_index);
+        return;
+    }
+
+    const GLThreadPool* outer_pool = t_pool;
+    int outer_thread_index = t_thread_index;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        // another thread runs a job, index 0 belongs to it until it is done
+        _idle.wait(lock, [this]{return !_busy;});
+        _busy = true;
+
+        // small ranges stay on this thread
+        if(_workers.size() == 0 || count <= chunk_size)
+        {
+            lock.unlock();
+
+            t_pool = this;
+            t_thread_index = 0;
+            job(0, count, 0);
+            t_pool = outer_pool;
+            t_thread_index = outer_thread_index;
+
+            lock.lock();
+            _busy = false;
+            lock.unlock();
+            _idle.notify_one();
+            return;
+        }
+
+        _job = &job;
+        _count = count;
+        _chunk_size = chunk_size;
+        _next = 0;
+        _active = (int)_workers.size();
+        _generation++;
+    }
+    _wake.notify_all();
+
+    t_pool = this;
+    t_thread_index = 0;
+    runChunks(0);
+    t_pool = outer_pool;
+    t_thread_index = outer_thread_index;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this]{return _active == 0;});
+    _job = NULL;
+    _busy = false;
+    lock.unlock();
+    _idle.notify_one();
+}
+
+
+/*!
+ Takes chunks of the current job until the range is done
+ */
+void GLThreadPool::runChunks(int thread_index)
+{
+    for(;;)
+    {
+        int start = _next.fetch_add(_chunk_size);
+        if(start >= _count) break;
+
+        (*_job)(start, std::min(start + _chunk_size, _count), thread_index);
+    }
+}
+
+
+/*!
+ The loop of one worker thread
+ */
+void GLThreadPool::workerLoop(int thread_index)
+{
+    unsigned int generation = 0;
+
+    // this thread runs only jobs of this pool
+    t_pool = this;
+    t_thread_index = thread_index;
+
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&]{return _quit || _generation != generation;});
+            if(_quit) return;
+            generation = _generation;
+        }
+
+        runChunks(thread_index);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _active--;
+            if(_active == 0) _done.notify_one();
+        }
+    }
+}
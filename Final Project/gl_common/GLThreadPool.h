@@ -0,0 +1,120 @@
+//
+//  GLThreadPool.h
+//  HCI557_Simple_Texture
+//
+//  A pool of worker threads for the per-frame prepare work: culling, sort key
+//  generation and occlusion rasterization. The workers are started once and
+//  wait between the jobs, so a frame pays no thread start-up cost.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+
+
+/*!
+ parallelFor() splits a range into chunks. The workers and the calling thread take
+ chunks until the range is done, then parallelFor() returns. The workers never make
+ GL calls, only the calling thread owns the GL context.
+
+ Every chunk gets the index of the thread that runs it, 0 for the calling thread,
+ so a job can write into per-thread buffers without locks.
+ */
+class GLThreadPool
+{
+public:
+
+    /*!
+     A job for the items [start, end) on the thread with the index thread_index
+     */
+    typedef std::function<void(int start, int end, int thread_index)> RangeJob;
+
+
+    /*!
+     Returns the pool of this application
+     */
+    static GLThreadPool& Get(void);
+
+
+    /*!
+     Set the number of threads of the pool returned by Get().
+     Call this before the first Get() call, e.g. from a command line option.
+     @param num_threads - the number of threads including the calling thread, 0 for the default
+     */
+    static void SetDefaultThreads(int num_threads);
+
+
+    /*!
+     @param num_threads - the number of threads including the calling thread,
+                          0 picks the number of cores, up to eight
+     */
+    GLThreadPool(int num_threads = 0);
+    ~GLThreadPool();
+
+
+    /*!
+     Runs the job for all items [0, count) and waits until all chunks are done.
+     A call from inside a job runs on the calling thread with the thread index of that
+     thread, so it shares the per-thread buffers only with itself. A call from another
+     thread waits until the pool is free. A range with fewer than two chunks runs on
+     the calling thread with the index 0.
+     @param count - the number of items
+     @param chunk_size - the number of items per chunk
+     @param job - the job
+     */
+    void parallelFor(int count, int chunk_size, const RangeJob& job);
+
+
+    /*!
+     Returns the number of threads including the calling thread.
+     Per-thread buffers need this size.
+     */
+    inline int numThreads(void){return (int)_workers.size() + 1;}
+
+
+private:
+
+    /*!
+     The loop of one worker thread
+     */
+    void workerLoop(int thread_index);
+
+
+    /*!
+     Takes chunks of the current job until the range is done
+     */
+    void runChunks(int thread_index);
+
+
+    // the number of threads of the pool returned by Get()
+    static int                  _default_threads;
+
+    vector<std::thread>         _workers;
+
+    std::mutex                  _mutex;
+    std::condition_variable     _wake;
+    std::condition_variable     _done;
+    std::condition_variable     _idle;
+
+    // the current job
+    const RangeJob*             _job;
+    int                         _count;
+    int                         _chunk_size;
+    std::atomic<int>            _next;
+
+    // the number of workers that have not finished the current job
+    int                         _active;
+    unsigned int                _generation;
+    bool                        _busy;
+    bool                        _quit;
+};
@@ -0,0 +1,271 @@
+//
+//  GLTransformSystem.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLTransformSystem.h"
+#include "GLProfiler.h"
+#include "GLThreadPool.h"
+
+#ifdef GL_SIMD_AVX
+    #include <immintrin.h>
+#endif
+
+
+// the number of objects per job of GLThreadPool
+static const int TRANSFORM_CHUNK_SIZE = 4096;
+
+
+
+GLTransformSystem::GLTransformSystem()
+{
+}
+
+
+GLTransformSystem::~GLTransformSystem()
+{
+}
+
+
+/*!
+ Reserve memory for n objects
+ */
+void GLTransformSystem::reserve(int n)
+{
+    _px.reserve(n); _py.reserve(n); _pz.reserve(n);
+    _qx.reserve(n); _qy.reserve(n); _qz.reserve(n); _qw.reserve(n);
+    _sx.reserve(n); _sy.reserve(n); _sz.reserve(n);
+}
+
+
+/*!
+ Add an object
+ */
+int GLTransformSystem::add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    _px.push_back(position.x); _py.push_back(position.y); _pz.push_back(position.z);
+    _qx.push_back(rotation.x); _qy.push_back(rotation.y); _qz.push_back(rotation.z); _qw.push_back(rotation.w);
+    _sx.push_back(scale.x); _sy.push_back(scale.y); _sz.push_back(scale.z);
+
+    return (int)_px.size() - 1;
+}
+
+
+void GLTransformSystem::setPosition(int index, const glm::vec3& position)
+{
+    _px[index] = position.x;
+    _py[index] = position.y;
+    _pz[index] = position.z;
+}
+
+
+void GLTransformSystem::setRotation(int index, const glm::quat& rotation)
+{
+    _qx[index] = rotation.x;
+    _qy[index] = rotation.y;
+    _qz[index] = rotation.z;
+    _qw[index] = rotation.w;
+}
+
+
+void GLTransformSystem::setScale(int index, const glm::vec3& scale)
+{
+    _sx[index] = scale.x;
+    _sy[index] = scale.y;
+    _sz[index] = scale.z;
+}
+
+
+/*!
+ Writes the world matrices of the objects [start, end) with the widest instructions
+ */
+void GLTransformSystem::compute(int start, int end, float* out, int stride) const
+{
+    int first = start;
+
+#ifdef GL_SIMD_AVX
+    if(GLSimdHasAVX()) start = computeAVX(start, end, out, stride);
+#endif
+    computeScalar(start, end, out + (start - first) * stride, stride);
+}
+
+
+/*!
+ Writes the world matrices of the objects [start, end) with plain C++.
+ The rotation is the one of glm::mat3_cast, the columns are scaled.
+ */
+void GLTransformSystem::computeScalar(int start, int end, float* out, int stride) const
+{
+    for(int i=start; i<end; i++, out += stride)
+    {
+        float x2 = _qx[i] + _qx[i];
+        float y2 = _qy[i] + _qy[i];
+        float z2 = _qz[i] + _qz[i];
+
+        float xx = _qx[i] * x2, yy = _qy[i] * y2, zz = _qz[i] * z2;
+        float xy = _qx[i] * y2, xz = _qx[i] * z2, yz = _qy[i] * z2;
+        float wx = _qw[i] * x2, wy = _qw[i] * y2, wz = _qw[i] * z2;
+
+        out[0] = (1.0f - (yy + zz)) * _sx[i];
+        out[1] = (xy + wz) * _sx[i];
+        out[2] = (xz - wy) * _sx[i];
+        out[3] = 0.0f;
+
+        out[4] = (xy - wz) * _sy[i];
+        out[5] = (1.0f - (xx + zz)) * _sy[i];
+        out[6] = (yz + wx) * _sy[i];
+        out[7] = 0.0f;
+
+        out[8] = (xz + wy) * _sz[i];
+        out[9] = (yz - wx) * _sz[i];
+        out[10] = (1.0f - (xx + yy)) * _sz[i];
+        out[11] = 0.0f;
+
+        out[12] = _px[i];
+        out[13] = _py[i];
+        out[14] = _pz[i];
+        out[15] = 1.0f;
+    }
+}
+
+
+#ifdef GL_SIMD_AVX
+
+#define TRANSFORM_MADD(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define TRANSFORM_MSUB(a, b, c) _mm256_fmsub_ps(a, b, c)
+
+
+/*!
+ Transposes eight registers, r[k] holds element k of eight matrices before the call
+ and the elements 0 - 7 of matrix k after the call.
+ */
+GL_SIMD_AVX_TARGET static inline void transpose8(__m256* r)
+{
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+
+/*!
+ Writes the matrices of the objects [start, end) with AVX, eight at a time.
+ */
+GL_SIMD_AVX_TARGET int GLTransformSystem::computeAVX(int start, int end, float* out, int stride) const
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    int i = start;
+    for(; i+8<=end; i+=8, out += 8 * stride)
+    {
+        __m256 qx = _mm256_loadu_ps(&_qx[i]);
+        __m256 qy = _mm256_loadu_ps(&_qy[i]);
+        __m256 qz = _mm256_loadu_ps(&_qz[i]);
+        __m256 qw = _mm256_loadu_ps(&_qw[i]);
+        __m256 sx = _mm256_loadu_ps(&_sx[i]);
+        __m256 sy = _mm256_loadu_ps(&_sy[i]);
+        __m256 sz = _mm256_loadu_ps(&_sz[i]);
+
+        __m256 x2 = _mm256_add_ps(qx, qx);
+        __m256 y2 = _mm256_add_ps(qy, qy);
+        __m256 z2 = _mm256_add_ps(qz, qz);
+
+        __m256 wx = _mm256_mul_ps(qw, x2);
+        __m256 wy = _mm256_mul_ps(qw, y2);
+        __m256 wz = _mm256_mul_ps(qw, z2);
+        __m256 xx = _mm256_mul_ps(qx, x2);
+        __m256 yy = _mm256_mul_ps(qy, y2);
+        __m256 zz = _mm256_mul_ps(qz, z2);
+
+        // the elements of the matrices, column by column; the first and the second half
+        __m256 a[8];
+        __m256 b[8];
+
+        a[0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+        a[1] = _mm256_mul_ps(TRANSFORM_MADD(qx, y2, wz), sx);
+        a[2] = _mm256_mul_ps(TRANSFORM_MSUB(qx, z2, wy), sx);
+        a[3] = zero;
+
+        a[4] = _mm256_mul_ps(TRANSFORM_MSUB(qx, y2, wz), sy);
+        a[5] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+        a[6] = _mm256_mul_ps(TRANSFORM_MADD(qy, z2, wx), sy);
+        a[7] = zero;
+
+        b[0] = _mm256_mul_ps(TRANSFORM_MADD(qx, z2, wy), sz);
+        b[1] = _mm256_mul_ps(TRANSFORM_MSUB(qy, z2, wx), sz);
+        b[2] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+        b[3] = zero;
+
+        b[4] = _mm256_loadu_ps(&_px[i]);
+        b[5] = _mm256_loadu_ps(&_py[i]);
+        b[6] = _mm256_loadu_ps(&_pz[i]);
+        b[7] = one;
+
+        // one matrix per register pair
+        transpose8(a);
+        transpose8(b);
+
+        for(int k=0; k<8; k++)
+        {
+            _mm256_storeu_ps(out + k * stride, a[k]);
+            _mm256_storeu_ps(out + k * stride + 8, b[k]);
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+
+/*!
+ Writes the world matrices of all objects, on the threads of GLThreadPool
+ */
+void GLTransformSystem::update(float* out, int stride) const
+{
+    GL_PROFILE_ZONE("GLTransformSystem::update");
+
+    GLThreadPool::Get().parallelFor(size(), TRANSFORM_CHUNK_SIZE,
+        [this, out, stride](int start, int end, int){ compute(start, end, out + start * stride, stride); });
+}
+
+
+/*!
+ Writes the world matrices of all objects into the range of the current frame of a stream buffer
+ */
+GLintptr GLTransformSystem::write(GLStreamBuffer& stream) const
+{
+    if(size() == 0) return -1;
+
+    GLintptr offset = 0;
+    float* data = (float*)stream.map(size() * sizeof(glm::mat4), sizeof(glm::mat4), offset);
+    if(data == NULL) return -1;
+
+    update(data, 16);
+    stream.unmap();
+
+    return offset;
+}
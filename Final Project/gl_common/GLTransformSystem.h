@@ -0,0 +1,138 @@
+//
+//  GLTransformSystem.h
+//  HCI557_Simple_Texture
+//
+//  Positions, rotations, and scales of many objects in separate arrays. The
+//  world matrices of all objects are computed in one call, eight (AVX) objects
+//  at a time, and written directly into a buffer, e.g. a mapped GL buffer.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GLEW include
+#include <GL/glew.h>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// locals
+#include "GLStreamBuffer.h"
+#include "GLSimd.h"
+
+
+using namespace std;
+
+
+/*!
+ Every component is a SoA array of floats: px, py, pz for the position, qx, qy, qz, qw for
+ the unit quaternion, sx, sy, sz for the scale. The world matrix of object i is
+
+    translate(p) * mat4_cast(q) * scale(s)
+
+ the same as the glm functions. compute() builds the matrices of eight objects in the lanes
+ of AVX registers, transposes them and stores 16 floats per object, column by column, like
+ glm::mat4. Objects that do not fill a register and builds without AVX use plain C++.
+ The kernel uses AVX2 and fused multiply-adds, it runs if the CPU supports both, see GLSimd.h.
+
+ The output has a stride, so the matrices can go into an interleaved buffer, e.g. the
+ matrix and color of GLInstancedMesh.
+ */
+class GLTransformSystem
+{
+public:
+
+    GLTransformSystem();
+    ~GLTransformSystem();
+
+
+    /*!
+     Reserve memory for n objects
+     */
+    void reserve(int n);
+
+
+    /*!
+     Add an object
+     @param position - the translation
+     @param rotation - a unit quaternion
+     @param scale - the scale along the local axes
+     @return the index of the object
+     */
+    int add(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+            const glm::vec3& scale = glm::vec3(1.0f, 1.0f, 1.0f));
+
+
+    /*!
+     Set the components of one object
+     */
+    void setPosition(int index, const glm::vec3& position);
+    void setRotation(int index, const glm::quat& rotation);
+    void setScale(int index, const glm::vec3& scale);
+
+
+    /*!
+     Returns the components of one object
+     */
+    inline glm::vec3 getPosition(int index) const {return glm::vec3(_px[index], _py[index], _pz[index]);}
+    inline glm::quat getRotation(int index) const {return glm::quat(_qw[index], _qx[index], _qy[index], _qz[index]);}
+    inline glm::vec3 getScale(int index) const {return glm::vec3(_sx[index], _sy[index], _sz[index]);}
+
+
+    /*!
+     Returns the number of objects
+     */
+    inline int size(void) const {return (int)_px.size();}
+
+
+    /*!
+     Writes the world matrices of the objects [start, end) with the widest instructions
+     @param out - the matrix of object start, 16 floats column by column
+     @param stride - the number of floats from one matrix to the next, 16 or more
+     */
+    void compute(int start, int end, float* out, int stride = 16) const;
+
+
+    /*!
+     Writes the world matrices of the objects [start, end) with plain C++
+     */
+    void computeScalar(int start, int end, float* out, int stride = 16) const;
+
+
+    /*!
+     Writes the world matrices of all objects, large counts are split into chunks
+     which run on the threads of GLThreadPool
+     */
+    void update(float* out, int stride = 16) const;
+
+
+    /*!
+     Writes the world matrices of all objects into the range of the current frame of a
+     stream buffer, e.g. for an instanced mat4 attribute
+     @param stream - the buffer, the data is valid until the frame ends
+     @return the offset of the first matrix in the buffer, -1 if the buffer is full
+     */
+    GLintptr write(GLStreamBuffer& stream) const;
+
+
+private:
+
+#ifdef GL_SIMD_AVX
+    /*!
+     Writes the matrices of the objects [start, end) with AVX, eight at a time.
+     @return the index of the first object that was not written
+     */
+    GL_SIMD_AVX_TARGET int computeAVX(int start, int end, float* out, int stride) const;
+#endif
+
+
+    vector<float>           _px, _py, _pz;
+    vector<float>           _qx, _qy, _qz, _qw;
+    vector<float>           _sx, _sy, _sz;
+};
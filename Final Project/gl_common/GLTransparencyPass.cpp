@@ -0,0 +1,275 @@
+//
+//  GLTransparencyPass.cpp
+//  HCI557_Simple_Texture
+//
+
+#include "GLTransparencyPass.h"
+#include "Shaders.h"
+#include "GLProfiler.h"
+
+#include <algorithm>
+
+
+// A full-screen triangle, the positions come from gl_VertexID
+static const string composite_vs =
+"#version 330 core                                                  \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2)); \n"
+"    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);                   \n"
+"}                                                                  \n";
+
+// The weighted average of the transparent colors, blended with the revealage
+static const string composite_fs =
+"#version 330 core                                                  \n"
+"uniform sampler2D accum_texture;                                   \n"
+"uniform sampler2D weight_texture;                                  \n"
+"out vec4 color;                                                    \n"
+"void main(void)                                                    \n"
+"{                                                                  \n"
+"    ivec2 p = ivec2(gl_FragCoord.xy);                              \n"
+"    vec4 accum = texelFetch(accum_texture, p, 0);                  \n"
+"    float revealage = accum.a;                                     \n"
+"    if(revealage >= 0.9999) discard;                               \n"
+"    float weight = texelFetch(weight_texture, p, 0).r;             \n"
+"    // more than 21 opaque layers of the weight 3e3 overflow the 16 bit floats \n"
+"    if(isinf(weight) || isinf(max(accum.r, max(accum.g, accum.b)))) \n"
+"    {                                                              \n"
+"        accum.rgb = vec3(1.0);                                     \n"
+"        weight = 1.0;                                              \n"
+"    }                                                              \n"
+"    color = vec4(accum.rgb / max(weight, 0.00001), 1.0 - revealage); \n"
+"}                                                                  \n";
+
+
+
+GLTransparencyPass::GLTransparencyPass()
+{
+    _width = 0;
+    _height = 0;
+
+    _accumLocation = -1;
+    _weightLocation = -1;
+
+    _target_fbo = 0;
+    _checked_fbo = 0;
+    _depth_checked = false;
+    _depth_matches = false;
+}
+
+
+GLTransparencyPass::~GLTransparencyPass()
+{
+    release();
+}
+
+
+/*!
+ Deletes the targets
+ */
+void GLTransparencyPass::release(void)
+{
+    _fbo.release();
+    _accum_texture.release();
+    _weight_texture.release();
+    _depth.release();
+}
+
+
+/*!
+ Returns true if the depth and stencil format of the framebuffer is GL_DEPTH24_STENCIL8.
+ The window has the attachments GL_DEPTH and GL_STENCIL, framebuffer objects
+ GL_DEPTH_ATTACHMENT and GL_STENCIL_ATTACHMENT.
+ */
+bool GLTransparencyPass::checkDepthFormat(GLuint fbo)
+{
+    GLenum depth_attachment = fbo == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+    GLenum stencil_attachment = fbo == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+
+    GLint type = GL_NONE;
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, depth_attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+    if(type == GL_NONE) return false;
+
+    GLint depth_bits = 0, stencil_bits = 0, component = GL_NONE;
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, depth_attachment, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depth_bits);
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, depth_attachment, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &component);
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, stencil_attachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencil_bits);
+
+    return depth_bits == 24 && stencil_bits == 8 && component == GL_UNSIGNED_NORMALIZED;
+}
+
+
+/*!
+ Create the targets and the composite program
+ */
+bool GLTransparencyPass::init(int width, int height)
+{
+    GLuint program = CreateShaderProgram(composite_vs, composite_fs);
+    if(program == 0)
+    {
+        cerr << "[GLTransparencyPass] - Cannot create the composite program." << endl;
+        return false;
+    }
+    _program.adopt(GLResource::PROGRAM, program, "GLTransparencyPass");
+
+    glUseProgram(program);
+    _accumLocation = glGetUniformLocation(program, "accum_texture");
+    _weightLocation = glGetUniformLocation(program, "weight_texture");
+    glUniform1i(_accumLocation, 0);
+    glUniform1i(_weightLocation, 1);
+    glUseProgram(0);
+
+    // core profiles need a bound vertex array for every draw
+    _vao.create(GLResource::VERTEX_ARRAY, "GLTransparencyPass");
+
+    return createTargets(width, height);
+}
+
+
+/*!
+ Create or resize the targets
+ */
+bool GLTransparencyPass::createTargets(int width, int height)
+{
+    release();
+
+    _width = width;
+    _height = height;
+
+    _accum_texture.create(GLResource::TEXTURE, "GLTransparencyPass");
+    glBindTexture(GL_TEXTURE_2D, _accum_texture.id());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, _width, _height, 0, GL_RGBA, GL_FLOAT, NULL);
+    _accum_texture.setSize((size_t)_width * _height * 8);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    _weight_texture.create(GLResource::TEXTURE, "GLTransparencyPass");
+    glBindTexture(GL_TEXTURE_2D, _weight_texture.id());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, _width, _height, 0, GL_RED, GL_FLOAT, NULL);
+    _weight_texture.setSize((size_t)_width * _height * 2);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // the same format as the window and GLFramebuffer, the depth is copied with a blit
+    _depth.create(GLResource::RENDERBUFFER, "GLTransparencyPass");
+    glBindRenderbuffer(GL_RENDERBUFFER, _depth.id());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, _width, _height);
+    _depth.setSize((size_t)_width * _height * 4);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    _fbo.create(GLResource::FRAMEBUFFER, "GLTransparencyPass");
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo.id());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _accum_texture.id(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _weight_texture.id(), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depth.id());
+
+    GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        cerr << "[GLTransparencyPass] - The framebuffer is not complete, status " << status << "." << endl;
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+ Start the transparent draws.
+ */
+void GLTransparencyPass::begin(GLuint target_fbo)
+{
+    GL_PROFILE_ZONE("GLTransparencyPass::begin");
+
+    _target_fbo = target_fbo;
+
+    // the targets only grow, a smaller viewport, e.g. of GLDynamicResolution, uses the lower left part
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if(viewport[2] > _width || viewport[3] > _height || !_fbo.isValid())
+    {
+        if(!createTargets(std::max((int)viewport[2], _width), std::max((int)viewport[3], _height))) return;
+    }
+
+    // the blit needs the same depth format on both sides, checked once per target
+    if(!_depth_checked || _target_fbo != _checked_fbo)
+    {
+        _depth_matches = checkDepthFormat(_target_fbo);
+        if(!_depth_matches)
+        {
+            cerr << "[GLTransparencyPass] - The depth buffer of framebuffer " << _target_fbo
+                 << " is not GL_DEPTH24_STENCIL8 and cannot be copied. Opaque objects do not hide transparent objects." << endl;
+        }
+        _checked_fbo = _target_fbo;
+        _depth_checked = true;
+    }
+
+    // opaque objects hide transparent objects
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo.id());
+    if(_depth_matches)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _target_fbo);
+        glBlitFramebuffer(0, 0, viewport[2], viewport[3], 0, 0, viewport[2], viewport[3], GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+    else
+    {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo.id());
+
+    static const GLfloat clear_accum[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    static const GLfloat clear_weight[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clear_accum);
+    glClearBufferfv(GL_COLOR, 1, clear_weight);
+
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+
+/*!
+ Ends the transparent draws and blends the result over the target framebuffer.
+ */
+void GLTransparencyPass::end(void)
+{
+    GL_PROFILE_ZONE("GLTransparencyPass::end");
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _target_fbo);
+
+    if(_fbo.isValid())
+    {
+        glDisable(GL_DEPTH_TEST);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glUseProgram(_program.id());
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _accum_texture.id());
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, _weight_texture.id());
+
+        glBindVertexArray(_vao.id());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glUseProgram(0);
+
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    // the state of main()
+    glDepthMask(GL_TRUE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
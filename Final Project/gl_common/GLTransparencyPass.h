@@ -0,0 +1,125 @@
+//
+//  GLTransparencyPass.h
+//  HCI557_Simple_Texture
+//
+//  Weighted blended order-independent transparency (McGuire and Bavoil 2013).
+//  Transparent objects are drawn in any order into an accumulation target,
+//  and a composite pass blends the result over the opaque image.
+//
+#pragma once
+
+// stl include
+#include <iostream>
+#include <string>
+
+// GLEW include
+#include <GL/glew.h>
+
+// locals
+#include "GLResource.h"
+
+
+using namespace std;
+
+
+
+/*!
+ The pass renders into two targets:
+    0: RGBA16F, rgb = sum(color * alpha * weight), a = product(1 - alpha), the revealage
+    1: R16F,    r = sum(alpha * weight)
+
+ Both targets are written with one blend function,
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA),
+ so OpenGL 3.3 without per-buffer blending is sufficient.
+
+ Transparent objects need a fragment shader with the outputs
+    layout(location = 0) out vec4 accum;    // vec4(color.rgb * alpha * w, alpha)
+    layout(location = 1) out float weight;  // alpha * w
+ see ../data/shaders/multi_vertex_lights_oit.fs.
+
+ The depth buffer of the target framebuffer is copied into the pass, so opaque
+ objects hide transparent ones. Transparent objects do not write depth.
+ The copy is a glBlitFramebuffer(), which needs equal depth and stencil formats.
+ The pass uses GL_DEPTH24_STENCIL8 like GLFramebuffer and the default window of GLFW.
+ begin() checks the format of every new target and reports a mismatch; the transparent
+ objects are then not hidden by opaque ones.
+ */
+class GLTransparencyPass
+{
+public:
+
+    GLTransparencyPass();
+    ~GLTransparencyPass();
+
+
+    /*!
+     Create the targets and the composite program
+     @param width, height - the initial size, the pass grows with the viewport size
+     @return true if the pass can be used
+     */
+    bool init(int width, int height);
+
+
+    /*!
+     Start the transparent draws. Copies the depth buffer of the target,
+     binds the accumulation targets and sets the blend state.
+     @param target_fbo - the framebuffer with the opaque image, 0 for the window
+     */
+    void begin(GLuint target_fbo);
+
+
+    /*!
+     Ends the transparent draws and blends the result over the target framebuffer.
+     Restores the blend and depth state of main().
+     */
+    void end(void);
+
+
+    /*!
+     Returns true if init() succeeded
+     */
+    inline bool isValid(void){return _fbo.isValid() && _program.isValid();}
+
+
+private:
+
+    /*!
+     Create or resize the targets
+     */
+    bool createTargets(int width, int height);
+
+    /*!
+     Deletes the targets
+     */
+    void release(void);
+
+    /*!
+     Returns true if the depth and stencil format of the framebuffer is
+     GL_DEPTH24_STENCIL8, the format of the pass
+     */
+    bool checkDepthFormat(GLuint fbo);
+
+
+    // the targets are rendered every frame and are never evicted
+    GLResource  _fbo;
+    GLResource  _accum_texture;
+    GLResource  _weight_texture;
+    GLResource  _depth;
+
+    int         _width;
+    int         _height;
+
+    // the composite program and the empty vertex array for the full-screen triangle
+    GLResource  _program;
+    GLResource  _vao;
+    int         _accumLocation;
+    int         _weightLocation;
+
+    // the framebuffer of the current begin() call
+    GLuint      _target_fbo;
+
+    // the last checked framebuffer and the result of checkDepthFormat()
+    GLuint      _checked_fbo;
+    bool        _depth_checked;
+    bool        _depth_matches;
+};
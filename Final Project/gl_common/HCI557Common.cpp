@@ -1,4 +1,7 @@
 #include "HCI557Common.h"
+#include "GLHeadless.h"
+#include "GLDebugOverlay.h"
+#include "GLHud.h"
 
 
 
@@ -23,6 +26,9 @@ int statevarright;
 // this is a helper variable to allow us to change the texture blend model
 int g_change_texture_blend;
 
+// toggles the bounding boxes of the debug draw
+int g_draw_bounds = 0;
+
 
 // the current mouse position;
 int g_current_mouse_x = 0;
@@ -176,6 +182,19 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	{
 		statevarright = 1;
 	}
+	else if (key == GLFW_KEY_N && action == GLFW_PRESS)
+	{
+		// normals, tangents, wireframe, all, off
+		GLDebugOverlay::Get().nextModes();
+	}
+	else if (key == GLFW_KEY_B && action == GLFW_PRESS)
+	{
+		g_draw_bounds = !g_draw_bounds;
+	}
+	else if (key == GLFW_KEY_H && action == GLFW_PRESS)
+	{
+		GLHud::Get().toggle();
+	}
 	
 }
 
@@ -248,10 +267,17 @@ bool initGlew(void)
     glewExperimental = GL_TRUE;
     
     // Initialize GLEW
-    if (glewInit() != GLEW_OK) {
+    GLenum err = glewInit();
+    
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // A GLEW built for GLX reports this without an X display. The GL functions are loaded anyway.
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY && isHeadless()) err = GLEW_OK;
+#endif
+    
+    if (err != GLEW_OK) {
         cout <<  "Failed to initialize GLEW\n" << endl;
-        system("pause");
-        return -1;
+        if (!isHeadless()) system("pause");
+        return false;
     }
     
     cout <<  "OpenGL version supported by this platform " << glGetString(GL_VERSION) <<  endl;
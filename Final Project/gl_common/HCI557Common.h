@@ -19,7 +19,6 @@
 // Locals
 #include "controls.h"
 #include "camera.h"
-#include "GLObjectObj.h"
 
 using namespace std;
 
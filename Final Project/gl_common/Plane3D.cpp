@@ -7,6 +7,7 @@
 //
 
 #include "Plane3D.h"
+#include "GLProfiler.h"
 
 
 
@@ -22,10 +23,7 @@ GLPlane3D::GLPlane3D(float center_x, float center_y, float center_z, float width
 
 GLPlane3D::~GLPlane3D()
 {
-    // Program clean up when the window gets closed.
-    glDeleteVertexArrays(1, _vaoID);
-    glDeleteProgram(_program);
-
+    // the program belongs to the appearance, the handles delete the buffers
 }
 
 
@@ -55,39 +53,69 @@ void GLPlane3D::init(void)
 /*!
  Draw the objects
  */
-void GLPlane3D::draw(void)
+bool GLPlane3D::drawGeometry(void)
 {
+    GL_PROFILE_ZONE("GLPlane3D::drawGeometry");
     
     //////////////////////////////////////////////////
     // Renders the sphere
     
-    // Enable the shader program
-    glUseProgram(_program);
-    
-    // this changes the camera location
-    glm::mat4 rotated_view =  rotatedViewMatrix();
-
-    glUniformMatrix4fv(_viewMatrixLocation, 1, GL_FALSE, &rotated_view[0][0]); // send the view matrix to our shader
-    glUniformMatrix4fv(_inverseViewMatrixLocation, 1, GL_FALSE, &invRotatedViewMatrix()[0][0]);
 	//new_line
 	//_modelMatrix = glm::rotate(glm::mat4(0.0), 90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
 
     glUniformMatrix4fv(_modelMatrixLocation, 1, GL_FALSE, &_modelMatrix[0][0]); //
     
     // Bind the buffer and switch it to an active buffer
-    glBindVertexArray(_vaoID[0]);
+    glBindVertexArray(_vao.id());
     
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE ); // allows to see the primitives
     // Draw the triangles
     glDrawArrays(GL_TRIANGLE_STRIP, 0, _num_vertices);
+    GLProfiler::Get().countDraw(_num_vertices - 2);
     
     // Unbind our Vertex Array Object
     glBindVertexArray(0);
     
-    // Unbind the shader program
-    glUseProgram(0);
+    return true;
+}
+
+
+
+/*!
+ Returns the geometry of this object as indexed triangles in model coordinates.
+ The plane is a triangle strip, every second triangle flips its first two
+ indices to keep the winding.
+ */
+bool GLPlane3D::getTriangles(vector<Vertex>& points, vector<Vertex>& normals, vector<GLuint>& indices)
+{
+    make_box(_center_x, _center_y, _center_z, _width, _height, _rows, _cols, points, normals);
     
+    indices.clear();
+    for(GLuint i=0; i+2<points.size(); i++)
+    {
+        if(i%2 == 0)
+        {
+            indices.push_back(i); indices.push_back(i+1); indices.push_back(i+2);
+        }
+        else
+        {
+            indices.push_back(i+1); indices.push_back(i); indices.push_back(i+2);
+        }
+    }
     
+    return true;
+}
+
+
+/*!
+ Draws the triangles of the vertex array with the bound program
+ */
+bool GLPlane3D::drawVertexArray(void)
+{
+    glBindVertexArray(_vao.id());
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, _num_vertices);
+    glBindVertexArray(0);
+    return true;
 }
 
 
@@ -133,6 +161,7 @@ void GLPlane3D::initShader(void)
  */
 void GLPlane3D::initVBO(void)
 {
+    GL_PROFILE_ZONE("GLPlane3D::initVBO");
     
     
     _vertex_points.clear();
@@ -164,19 +193,24 @@ void GLPlane3D::initVBO(void)
 
     }
     
+    // the local bounds for view-frustum culling
+    computeBounds(vertices, _num_vertices, 5);
+    
     glUseProgram(_program);
     
     
-    glGenVertexArrays(1, _vaoID); // Create our Vertex Array Object
-    glBindVertexArray(_vaoID[0]); // Bind our Vertex Array Object so we can use it
+    _vao.create(GLResource::VERTEX_ARRAY, "GLPlane3D"); // Create our Vertex Array Object
+    glBindVertexArray(_vao.id()); // Bind our Vertex Array Object so we can use it
     
     
-    glGenBuffers(3, _vboID); // Generate our Vertex Buffer Object
+    _vbo[0].create(GLResource::BUFFER, "GLPlane3D"); // Generate our Vertex Buffer Object
+    _vbo[1].create(GLResource::BUFFER, "GLPlane3D");
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // vertices
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[0]); // Bind our Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[0].id()); // Bind our Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 5 * sizeof(GLfloat), vertices, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[0].setSize(_num_vertices * 5 * sizeof(GLfloat));
     
     int locPos = glGetAttribLocation(_program, "in_Position");
     glVertexAttribPointer((GLuint)locPos, 3, GL_FLOAT, GL_FALSE, 5*sizeof(GLfloat), 0); // Set up our vertex attributes pointer
@@ -190,8 +224,9 @@ void GLPlane3D::initVBO(void)
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //Normals
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID[1]); // Bind our second Vertex Buffer Object
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo[1].id()); // Bind our second Vertex Buffer Object
     glBufferData(GL_ARRAY_BUFFER, _num_vertices * 3 *  sizeof(GLfloat), normals, GL_STATIC_DRAW); // Set the size and data of our VBO and set it to STATIC_DRAW
+    _vbo[1].setSize(_num_vertices * 3 *  sizeof(GLfloat));
     
     int locNorm = glGetAttribLocation(_program, "in_Normal");
     glVertexAttribPointer((GLuint)locNorm, 3, GL_FLOAT, GL_FALSE, 0, 0); // Set up our vertex attributes pointer
@@ -203,8 +238,8 @@ void GLPlane3D::initVBO(void)
     glBindVertexArray(0); // Disable our Vertex Buffer Object
     
     // delete the memory
-    delete vertices;
-    delete normals;
+    delete[] vertices;
+    delete[] normals;
 }
 
 
@@ -86,6 +86,47 @@ GLuint CreateShaderProgram(string vertex_source, string fragment_source)
 }
 
 
+/*
+ Creates a shader program with a geometry shader
+ */
+GLuint CreateShaderProgram(string vertex_source, string geometry_source, string fragment_source)
+{
+    const char * vs_source = vertex_source.c_str();
+    const char * gs_source = geometry_source.c_str();
+    const char * fs_source = fragment_source.c_str();
+    
+    GLuint program = glCreateProgram();
+    
+    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fs, 1, &fs_source, NULL);
+    glCompileShader(fs);
+    bool ret = CheckShader(fs, GL_FRAGMENT_SHADER);
+    if(!ret){cout << "Problems compiling GL_FRAGMENT_SHADER" << endl;}
+    
+    GLuint gs = glCreateShader(GL_GEOMETRY_SHADER);
+    glShaderSource(gs, 1, &gs_source, NULL);
+    glCompileShader(gs);
+    ret = CheckShader(gs, GL_GEOMETRY_SHADER);
+    if(!ret){cout << "Problems compiling GL_GEOMETRY_SHADER" << endl;}
+    
+    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vs, 1, &vs_source, NULL);
+    glCompileShader(vs);
+    ret = CheckShader(vs, GL_VERTEX_SHADER);
+    if(!ret){cout << "Problems compiling GL_VERTEX_SHADER" << endl;}
+    
+    glAttachShader(program, vs);
+    glAttachShader(program, gs);
+    glAttachShader(program, fs);
+    
+    glLinkProgram(program);
+    
+    glUseProgram(program);
+    
+    return program;
+}
+
+
 
 /*!
  Loads a shader program from a file and creates the related program
@@ -48,6 +48,16 @@ bool CheckShader(GLuint shader, GLenum shader_type);
 GLuint CreateShaderProgram(string vertex_source, string fragment_source);
 
 
+/*
+ Creates a shader program with a geometry shader
+ @param vertex source - the vertex shader source code
+ @param geometry_source - the geometry shader source code
+ @param fragment_source - the fragment shader source code
+ @return - Gluint of the shader program
+ */
+GLuint CreateShaderProgram(string vertex_source, string geometry_source, string fragment_source);
+
+
 /*!
  Loads a shader program from a file and creates the related program
  @param vertex_file -  the file which stores the vertex shader code
@@ -23,7 +23,6 @@ GLSphere3D::GLSphere3D(float center_x, float center_y, float center_z, float rad
     _rows = rows;
     _segments = segments;
     
-    _program_normals = 0;
     _program = 0;
 
     
@@ -35,11 +34,8 @@ GLSphere3D::GLSphere3D(float center_x, float center_y, float center_z, float rad
 GLSphere3D::~GLSphere3D()
 {
     
-    // Program clean up when the window gets closed.
-    glDeleteVertexArrays(1, _vaoID);
-    glDeleteVertexArrays(1, _vaoIDNormals);
-    glDeleteProgram(_program);
-    glDeleteProgram(_program_normals);
+    // the program belongs to the appearance
+    _program = 0;
 }
 
 
@@ -53,9 +49,6 @@ void GLSphere3D::init(void)
     
     initShader();
     initVBO();
-    
-    initShaderNormal();
-    initVBONormals();
 
 }
 
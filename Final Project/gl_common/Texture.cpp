@@ -7,6 +7,7 @@
 //
 
 #include "Texture.h"
+#include "GLProfiler.h"
 
 #ifdef WIN32
 string  GLTexture::_glsl_names[2] = { "tex", "texture_blend"};
@@ -23,8 +24,7 @@ GLTexture::GLTexture()
 
 GLTexture::~GLTexture()
 {
-
-
+    // the handle deletes the texture
 }
 
 /*!
@@ -76,6 +76,7 @@ int GLTexture::loadAndCreateTexture(string path_and_file)
         // If not 54 bytes read, this is not a bmp.
         // Only a bmp has a header of length 54
         printf("Not a correct BMP file\n");
+        fclose( file );
         return false;
     }
     
@@ -101,10 +102,11 @@ int GLTexture::loadAndCreateTexture(string path_and_file)
     
     // Generate a texture, this function allocates the memory and
     // associates the texture with a variable.
-    glGenTextures(1, &_texture );
+    _file = path_and_file;
+    _texture.create(GLResource::TEXTURE, path_and_file);
     
     // Set a texture as active texture.
-    glBindTexture( GL_TEXTURE_2D, _texture );
+    glBindTexture( GL_TEXTURE_2D, _texture.id() );
     
     // Change the parameters of your texture units.
     //glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE,GL_BLEND );
@@ -121,6 +123,8 @@ int GLTexture::loadAndCreateTexture(string path_and_file)
     else if(channels == 4)
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, data);
     
+    _texture.setSize(width * height * channels);
+    
     //**********************************************************************************************
     // Create a midmap texture pyramid and load it to the graphics hardware.
     // Note, the MIN and MAG filter must be set to one of the available midmap filters.
@@ -130,7 +134,7 @@ int GLTexture::loadAndCreateTexture(string path_and_file)
     free( data );
     
     // Return the texture.
-    return _texture;
+    return _texture.id();
 
 }
 
@@ -183,7 +187,7 @@ bool GLTexture::addVariablesToProgram(GLuint program, int variable_index )
     
     
     //We use glBindTexture bind our texture into the active texture unit.
-    glBindTexture(GL_TEXTURE_2D, _texture);
+    glBindTexture(GL_TEXTURE_2D, _texture.id());
     
     /*
      Then we set the tex uniform of the shaders to the index of the texture unit. We used texture unit zero, so we set the tex uniform to the integer value 0.
@@ -237,6 +241,43 @@ bool GLTexture::setTextureBlendMode(int mode)
     return true;
 }
 
+
+/*!
+ Binds the texture to texture unit 0, reloads it if it was evicted
+ */
+void GLTexture::bind(void)
+{
+    if(!_texture.isValid() && !_file.empty())
+    {
+        loadAndCreateTexture(_file);
+    }
+    
+    touch();
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _texture.id());
+}
+
+
+/*!
+ Returns the bytes of the texture, 0 if it is evicted
+ */
+//virtual
+size_t GLTexture::residentBytes(void)
+{
+    return _texture.size();
+}
+
+
+/*!
+ Deletes the texture, bind() loads the file again
+ */
+//virtual
+void GLTexture::evict(void)
+{
+    _texture.release();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -246,9 +287,6 @@ bool GLTexture::setTextureBlendMode(int mode)
 GLMultiTexture::GLMultiTexture()
 {
     
-    _texture_1 = 0;
-    _texture_2 = 0;
-	_texture_3 = 0;
     
     _texture_blend_mode = 0;
     _textureIdx1 = -1;
@@ -263,7 +301,7 @@ GLMultiTexture::GLMultiTexture()
 
 GLMultiTexture::~GLMultiTexture()
 {
-
+    // the handles delete the textures
 }
 
 /*!
@@ -289,9 +327,20 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
     
     unsigned char* data1 = loadBitmapFile(path_and_file_texture_1, channels1, width1,  height1 );
     unsigned char* data2 = loadBitmapFile(path_and_file_texture_2, channels2, width2,  height2 );
-	unsigned char* data3 = loadBitmapFile(path_and_file_texture_3, channels3, width3, height3);
+	unsigned char* data3 = NULL;
+	if(!path_and_file_texture_3.empty()) data3 = loadBitmapFile(path_and_file_texture_3, channels3, width3, height3);
     
-    if(data1 == NULL || data2 == NULL ||data3==NULL )return -1;
+    if(data1 == NULL || data2 == NULL || (data3 == NULL && !path_and_file_texture_3.empty()))
+    {
+        if(data1 != NULL) free(data1);
+        if(data2 != NULL) free(data2);
+        if(data3 != NULL) free(data3);
+        return -1;
+    }
+    
+    _file_1 = path_and_file_texture_1;
+    _file_2 = path_and_file_texture_2;
+    _file_3 = path_and_file_texture_3;
     
     
     
@@ -305,10 +354,10 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
     
     // Generate a texture, this function allocates the memory and
     // associates the texture with a variable.
-    glGenTextures(1, &_texture_1 );
+    _texture_1.create(GLResource::TEXTURE, path_and_file_texture_1);
     
     // Set a texture as active texture.
-    glBindTexture( GL_TEXTURE_2D, _texture_1 );
+    glBindTexture( GL_TEXTURE_2D, _texture_1.id() );
     
     // Change the parameters of your texture units.
     glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_NEAREST );
@@ -324,6 +373,8 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
     else if(channels1 == 4)
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width1, height1, 0, GL_BGRA, GL_UNSIGNED_BYTE, data1);
     
+    _texture_1.setSize(width1 * height1 * channels1);
+    
     //**********************************************************************************************
     // Create a midmap texture pyramid and load it to the graphics hardware.
     // Note, the MIN and MAG filter must be set to one of the available midmap filters.
@@ -343,10 +394,10 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
     
     // Generate a texture, this function allocates the memory and
     // associates the texture with a variable.
-    glGenTextures(1, &_texture_2 );
+    _texture_2.create(GLResource::TEXTURE, path_and_file_texture_2);
     
     // Set a texture as active texture.
-    glBindTexture( GL_TEXTURE_2D, _texture_2 );
+    glBindTexture( GL_TEXTURE_2D, _texture_2.id() );
     
     // Change the parameters of your texture units.
     glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_NEAREST );
@@ -362,6 +413,8 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
     else if(channels2 == 4)
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width2, height2, 0, GL_BGRA, GL_UNSIGNED_BYTE, data2);
     
+    _texture_2.setSize(width2 * height2 * channels2);
+    
     //**********************************************************************************************
     // Create a midmap texture pyramid and load it to the graphics hardware.
     // Note, the MIN and MAG filter must be set to one of the available midmap filters.
@@ -371,12 +424,15 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
     free( data2 );
 
 
+	// the third texture is optional
+	if(data3 == NULL) return _texture_1.id();
+
 	glActiveTexture(GL_TEXTURE2);
 
-	glGenTextures(1, &_texture_3);
+	_texture_3.create(GLResource::TEXTURE, path_and_file_texture_3);
 
 	// Set a texture as active texture.
-	glBindTexture(GL_TEXTURE_2D, _texture_3);
+	glBindTexture(GL_TEXTURE_2D, _texture_3.id());
 
 	// Change the parameters of your texture units.
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -392,6 +448,8 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
 	else if (channels3 == 4)
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width3, height3, 0, GL_BGRA, GL_UNSIGNED_BYTE, data3);
 
+	_texture_3.setSize(width3 * height3 * channels3);
+
 	//**********************************************************************************************
 	// Create a midmap texture pyramid and load it to the graphics hardware.
 	// Note, the MIN and MAG filter must be set to one of the available midmap filters.
@@ -401,7 +459,7 @@ int GLMultiTexture::loadAndCreateTextures(string path_and_file_texture_1, string
 	free(data3);
 
     // Return the texture.
-    return _texture_1;
+    return _texture_1.id();
 
     
     
@@ -427,6 +485,53 @@ bool GLMultiTexture::setTextureBlendMode(int mode)
 }
 
 
+/*!
+ Binds the textures to the texture units 0, 1, and 2, reloads them if they were evicted
+ */
+void GLMultiTexture::bind(void)
+{
+    if(!_texture_1.isValid() && !_file_1.empty())
+    {
+        loadAndCreateTextures(_file_1, _file_2, _file_3);
+    }
+    
+    touch();
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _texture_1.id());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _texture_2.id());
+    if(!_file_3.empty())
+    {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, _texture_3.id());
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+
+/*!
+ Returns the bytes of the three textures, 0 if they are evicted
+ */
+//virtual
+size_t GLMultiTexture::residentBytes(void)
+{
+    return _texture_1.size() + _texture_2.size() + _texture_3.size();
+}
+
+
+/*!
+ Deletes the textures, bind() loads the files again
+ */
+//virtual
+void GLMultiTexture::evict(void)
+{
+    _texture_1.release();
+    _texture_2.release();
+    _texture_3.release();
+}
+
+
 
 
 /*!
@@ -459,8 +564,11 @@ bool GLMultiTexture::addVariablesToProgram(GLuint program, int variable_index)
     _textureIdx2 = glGetUniformLocation(program, _glsl_names[1].c_str() );
     checkUniform(_textureIdx2, _glsl_names[1]);
 
-	_textureIdx3 = glGetUniformLocation(program, _glsl_names[2].c_str());
-	checkUniform(_textureIdx3, _glsl_names[2]);
+	if(!_file_3.empty())
+	{
+		_textureIdx3 = glGetUniformLocation(program, _glsl_names[2].c_str());
+		checkUniform(_textureIdx3, _glsl_names[2]);
+	}
     
     
     _textureBlendModelIdx = glGetUniformLocation(program, _glsl_names[3].c_str() );
@@ -476,7 +584,7 @@ bool GLMultiTexture::addVariablesToProgram(GLuint program, int variable_index)
     
     
     //We use glBindTexture bind our texture into the active texture unit.
-    glBindTexture(GL_TEXTURE_2D, _texture_1);
+    glBindTexture(GL_TEXTURE_2D, _texture_1.id());
     
     /*
      Then we set the tex uniform of the shaders to the index of the texture unit. We used texture unit zero, so we set the tex uniform to the integer value 0.
@@ -493,7 +601,7 @@ bool GLMultiTexture::addVariablesToProgram(GLuint program, int variable_index)
     
     
     //We use glBindTexture bind our texture into the active texture unit.
-    glBindTexture(GL_TEXTURE_2D, _texture_2);
+    glBindTexture(GL_TEXTURE_2D, _texture_2.id());
     
     /*
      Then we set the tex uniform of the shaders to the index of the texture unit. We used texture unit zero, so we set the tex uniform to the integer value 0.
@@ -501,16 +609,20 @@ bool GLMultiTexture::addVariablesToProgram(GLuint program, int variable_index)
     glUniform1i(_textureIdx2, 1);
     
     
-	glActiveTexture(GL_TEXTURE2);
+	if(!_file_3.empty())
+	{
+		glActiveTexture(GL_TEXTURE2);
 
 
-	//We use glBindTexture bind our texture into the active texture unit.
-	glBindTexture(GL_TEXTURE_2D, _texture_3);
+		//We use glBindTexture bind our texture into the active texture unit.
+		glBindTexture(GL_TEXTURE_2D, _texture_3.id());
 
-	/*
-	Then we set the tex uniform of the shaders to the index of the texture unit. We used texture unit zero, so we set the tex uniform to the integer value 0.
-	*/
-	glUniform1i(_textureIdx3, 2);
+		/*
+		Then we set the tex uniform of the shaders to the index of the texture unit. We used texture unit zero, so we set the tex uniform to the integer value 0.
+		*/
+		glUniform1i(_textureIdx3, 2);
+	}
+    glActiveTexture(GL_TEXTURE0);
 
 
 
@@ -588,10 +700,11 @@ int GLMipMapTexture::loadAndCreateTexture(string path_and_file)
     
     // Generate a texture, this function allocates the memory and
     // associates the texture with a variable.
-    glGenTextures(1, &_texture );
+    _file = path_and_file;
+    _texture.create(GLResource::TEXTURE, path_and_file);
     
     // Set a texture as active texture.
-    glBindTexture( GL_TEXTURE_2D, _texture );
+    glBindTexture( GL_TEXTURE_2D, _texture.id() );
 
     //------------------------------------------------------------------------------------------------
     // Change the parameters of your texture units.
@@ -618,12 +731,14 @@ int GLMipMapTexture::loadAndCreateTexture(string path_and_file)
 	// This generates the midmaps
 	glGenerateMipmap(GL_TEXTURE_2D);
 
+    // the mipmap pyramid adds a third of the base level
+    _texture.setSize(width * height * channels * 4 / 3);
     
     // Delete your loaded data
     free( data );
     
     // Return the texture.
-    return _texture;
+    return _texture.id();
 }
 
 
@@ -640,6 +755,7 @@ int GLMipMapTexture::loadAndCreateTexture(string path_and_file)
 */
 unsigned char* loadBitmapFile(string path_and_file, unsigned int& channels, unsigned int& width, unsigned int& height )
 {
+    GL_PROFILE_ZONE("loadBitmapFile");
 
     // Check whether we load a bitmap file
     
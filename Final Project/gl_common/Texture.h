@@ -25,6 +25,7 @@
 
 // locals
 #include "GLAppearanceBase.h"
+#include "GLResource.h"
 
 
 
@@ -41,8 +42,9 @@ typedef GLVariable GLTextureBase;
 /*!
  This texture class adds a texture to a primitive. 
  It is part of the appearance object and need to be used with a shader program that supports textures.
+ The texture can be evicted by the GLMemoryTracker, bind() loads the file again.
  */
-class GLTexture : public GLTextureBase
+class GLTexture : public GLTextureBase, public GLEvictable
 {
 private:
     
@@ -67,7 +69,7 @@ public:
      @param path_and_file to the texture object
      @return int - the texture id when the texture was sucessfully loaded.
      */
-    int loadAndCreateTexture(string path_and_file);
+    virtual int loadAndCreateTexture(string path_and_file);
     
     /*!
      This sets the texture blend model
@@ -76,6 +78,21 @@ public:
      */
     bool setTextureBlendMode(int mode);
     
+    /*!
+     Binds the texture to texture unit 0, reloads it if it was evicted
+     */
+    void bind(void);
+    
+    /*!
+     Returns the bytes of the texture, 0 if it is evicted
+     */
+    virtual size_t residentBytes(void);
+    
+    /*!
+     Deletes the texture, bind() loads the file again
+     */
+    virtual void evict(void);
+    
     
 protected:
     
@@ -93,7 +110,10 @@ protected:
     
     
     // The texture for this program.
-    GLuint      _texture;
+    GLResource  _texture;
+    
+    // the file of the texture, to load it again after an eviction
+    string      _file;
     
     // The blending mode for this texture
     int         _texture_blend_mode;
@@ -112,10 +132,11 @@ protected:
 
 
 /*!
- This texture class adds two textures to a glsl shader program.
+ This texture class adds two or three textures to a glsl shader program.
  It is part of the appearance object and need to be used with a shader program that supports textures.
+ The textures are evicted together, bind() loads the files again.
  */
-class GLMultiTexture : public GLTextureBase
+class GLMultiTexture : public GLTextureBase, public GLEvictable
 {
 private:
     // Allow the class GLApperance access to protected variables.
@@ -127,7 +148,7 @@ private:
 #ifdef WIN32
     static string      _glsl_names[];
 #else
-    const string      _glsl_names[3] = { "texture_background", "texture_foreground", "texture_blend"};
+    const string      _glsl_names[4] = { "texture_background", "texture_foreground", "texture_between", "texture_blend"};
 #endif
     
     
@@ -137,9 +158,10 @@ public:
     ~GLMultiTexture();
     
     /*!
-     Load two bitmap images as textures from files.
+     Load two or three bitmap images as textures from files.
      @param path_and_file_texture_1 - path and file of the first image.
      @param path_and_file_texture_1 - path and file of the second image.
+     @param path_and_file_texture_3 - path and file of the third image, an empty string for two textures.
      @return int - the texture id when the texture was sucessfully loaded.
      */
     int loadAndCreateTextures(string path_and_file_texture_1, string path_and_file_texture_2, string path_and_file_texture_3);
@@ -151,6 +173,21 @@ public:
      */
     bool setTextureBlendMode(int mode);
     
+    /*!
+     Binds the textures to the texture units 0, 1, and 2 if used, reloads them if they were evicted
+     */
+    void bind(void);
+    
+    /*!
+     Returns the bytes of the three textures, 0 if they are evicted
+     */
+    virtual size_t residentBytes(void);
+    
+    /*!
+     Deletes the textures, bind() loads the files again
+     */
+    virtual void evict(void);
+    
     
     
 protected:
@@ -171,9 +208,14 @@ protected:
 private:
     
     // The texture for this program.
-    GLuint      _texture_1;
-    GLuint      _texture_2;
-	GLuint      _texture_3;
+    GLResource  _texture_1;
+    GLResource  _texture_2;
+	GLResource  _texture_3;
+    
+    // the files of the textures, to load them again after an eviction
+    string      _file_1;
+    string      _file_2;
+    string      _file_3;
     
     // The blending mode for this texture
     int         _texture_blend_mode;
@@ -211,7 +253,7 @@ public:
      @param path_and_file to the texture object
      @return int - the texture id when the texture was sucessfully loaded.
      */
-    int loadAndCreateTexture(string path_and_file);
+    virtual int loadAndCreateTexture(string path_and_file);
 
 
 };